@@ -1,31 +1,165 @@
 #include "AnalyticalSolver.h"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
 #include <iostream>
-#include <numeric>
+#include <mutex>
 
-#include <utils/CLArguments.h>
+#include "TAOPrivate.h"
 
 namespace DungeonGeneration {
 namespace AnalyticalSolver {
 
+namespace {
+
+// PETSc can be initialized only once per process, so it's shared between all alive solvers
+// (e.g. the local repair solver is created while the main one is still alive).
+size_t gPETScUsersCount = 0;
+std::mutex gPETScUsersMutex;
+
+// PETSc without thread safety can't be called from several threads at once, so solvers take turns. Recursive: the
+// local repair solver is created on the thread of the main one while the latter is still alive.
+std::recursive_mutex gPETScSolversMutex;
+
+std::unique_lock<std::recursive_mutex> lockSolverIfNeeded()
+{
+    if (isPETScThreadSafe()) {
+        return {};
+    }
+    return std::unique_lock(gPETScSolversMutex);
+}
+
+// Checkpoint format: header followed by x and ALMM multipliers as raw doubles
+constexpr uint32_t kCheckpointMagic = 0x4B434744;  // "DGCK"
+constexpr uint32_t kCheckpointVersion = 2;
+
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t problemHash;
+    uint64_t solveResult;  // SolveResult of the last solve before saving
+    uint64_t varCnt;
+    uint64_t multipliersCnt;
+    uint64_t runId;
+    double mu;
+    double muFactor;
+};
+
+/// Command line arguments are optional
+PetscErrorCode acquirePETSc(int* argc = nullptr, char*** argv = nullptr)
+{
+    PetscFunctionBegin;
+
+    std::lock_guard lock(gPETScUsersMutex);
+    if (gPETScUsersCount++ > 0) {
+        PetscFunctionReturn(PETSC_SUCCESS);
+    }
+    if (argc != nullptr && argv != nullptr) {
+        PetscCall(PetscInitialize(argc, argv, nullptr, nullptr));
+    } else {
+        PetscCall(PetscInitializeNoArguments());
+    }
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
+void releasePETSc()
+{
+    std::lock_guard lock(gPETScUsersMutex);
+    assert(gPETScUsersCount > 0 && "PETSc finalization without initialization");
+    if (--gPETScUsersCount == 0) {
+        static_cast<void>(PetscFinalize());
+    }
+}
+
+size_t countConstraints(
+    const std::vector<Callbacks::CEqFGEval>& equalityConstraints, const std::vector<FusedTerms>& fusedTerms)
+{
+    size_t cEqCnt = equalityConstraints.size();
+    for (const FusedTerms& terms : fusedTerms) {
+        cEqCnt += terms.constraintCount;
+    }
+    return cEqCnt;
+}
+
+}  // namespace
+
+bool isPETScThreadSafe()
+{
+#if defined(PETSC_HAVE_THREADSAFETY)
+    return true;
+#else
+    return false;
+#endif
+}
+
+PETScScope::PETScScope()
+{
+    if (acquirePETSc() != PETSC_SUCCESS) {
+        throw std::runtime_error("PETScScope: failed to initialize PETSc");
+    }
+}
+
+PETScScope::PETScScope(int& argc, char**& argv)
+{
+    if (acquirePETSc(&argc, &argv) != PETSC_SUCCESS) {
+        throw std::runtime_error("PETScScope: failed to initialize PETSc");
+    }
+}
+
+PETScScope::~PETScScope()
+{
+    releasePETSc();
+}
+
 AnalyticalSolver::AnalyticalSolver(
     size_t objectCnt, size_t varCnt, Model::VariablesBounds&& variablesBounds,
     std::vector<Callbacks::FGEval>&& costFunctions, std::vector<Callbacks::CEqFGEval>&& equalityConstraints,
-    std::vector<Callbacks::ModifierCallback>&& modifierCallbacks,
-    std::vector<Callbacks::ReaderCallback>&& readerCallbacks)
-      : objectCnt_(objectCnt),
+    std::vector<FusedTerms>&& fusedTerms, std::vector<Callbacks::ModifierCallback>&& modifierCallbacks,
+    std::vector<Callbacks::ReaderCallback>&& readerCallbacks, const SolverOptions& options)
+      : petscLock_(lockSolverIfNeeded()),
+        objectCnt_(objectCnt),
         varCnt_(varCnt),
-        cEqCnt_(equalityConstraints.size()),
+        cEqCnt_(countConstraints(equalityConstraints, fusedTerms)),
         variablesBounds_(std::move(variablesBounds)),
         costFunctions_(std::move(costFunctions)),
         equalityConstraints_(std::move(equalityConstraints)),
+        fusedTerms_(std::move(fusedTerms)),
         modifierCallbacks_(std::move(modifierCallbacks)),
         readerCallbacks_(std::move(readerCallbacks)),
-        JEqRowIndexes_(cEqCnt_),
-        JEqColIndexes_(varCnt)
+        options_(options),
+        workspace_(options.workspace != nullptr ? *options.workspace : ownWorkspace_.emplace())
 {
+    const auto setupBeginTimestamp = Clock::now();
+    const Scaling& scaling = options_.scaling;
+    if (!scaling.variables.empty() && scaling.variables.size() != varCnt_) {
+        throw std::runtime_error("AnalyticalSolver: scaling doesn't match the problem dimensions");
+    }
+    assert(std::all_of(scaling.variables.begin(), scaling.variables.end(), [](double scale) { return scale > 0; }) &&
+           "Variables scales must be positive");
+
+    // Reused workspace may contain anything: the initial solution and the best iterate must start from zero
+    workspace_.reserve(varCnt_, cEqCnt_);
+    xBuffer_ = workspace_.x_.data();
+    bestXBuffer_ = workspace_.bestX_.data();
+    xLowerBoundBuffer_ = workspace_.xLowerBound_.data();
+    xUpperBoundBuffer_ = workspace_.xUpperBound_.data();
+    costGradientBuffer_ = workspace_.costGradient_.data();
+    cEqBuffer_ = workspace_.cEq_.data();
+    evaluatedGradient_ = workspace_.evaluatedGradient_.data();
+    evaluatedCEq_ = workspace_.evaluatedCEq_.data();
+    modelXBuffer_ = workspace_.modelX_.data();
+    solutionBuffer_ = workspace_.solution_.data();
+    JEqRowIndexes_ = workspace_.JEqRowIndexes_.data();
+    JEqColIndexes_ = workspace_.JEqColIndexes_.data();
+    std::fill_n(xBuffer_, varCnt_, 0.0);
+    std::fill_n(bestXBuffer_, varCnt_, 0.0);
+
     if (initializePETSc() != PETSC_SUCCESS) {
         throw std::runtime_error("AnalyticalSolver:: failed to initialize PETSc");
     }
@@ -42,26 +176,25 @@ AnalyticalSolver::AnalyticalSolver(
         throw std::runtime_error("AnalyticalSolver: failed to set scary options for TAO solvers");
     }
 
-    // Setup containers used for updating JEq
-    std::iota(JEqRowIndexes_.begin(), JEqRowIndexes_.end(), 0);
-    std::iota(JEqColIndexes_.begin(), JEqColIndexes_.end(), 0);
-    assert(JEqRowIndexes_.size() == cEqCnt_ && "Incorrect row indexes count");
-    assert(JEqColIndexes_.size() == varCnt_ && "Incorrect col indexes count");
+    statistics_.setupSeconds = std::chrono::duration<double>(Clock::now() - setupBeginTimestamp).count();
 }
 
 AnalyticalSolver::~AnalyticalSolver()
 {
     destroyTAOObjects();
-    static_cast<void>(PetscFinalize());
+    finalizePETSc();
 }
 
-void AnalyticalSolver::solve()
+SolveResult AnalyticalSolver::solve()
 {
     // TODO: do I really want to throw exceptions? Maybe just return bool or some kind of error code?
 
     std::cerr << "AnalyticalSolver: start solving...\n";
     const auto beginTimestamp = std::chrono::steady_clock::now();
 
+    hasBestIterate_ = false;
+    evaluationKey_.reset();
+    statistics_ = SolveStatistics{.setupSeconds = statistics_.setupSeconds};
     if (TaoSolve(almmSolver_) != PETSC_SUCCESS) {
         throw std::runtime_error("AnalyticalSolver: error in TaoSolve for ALMM solver");
     }
@@ -71,10 +204,25 @@ void AnalyticalSolver::solve()
         throw std::runtime_error("AnalyticalSolver: failed to retrieve converged reason");
     }
 
+    SolveResult result = (convergedReason > 0 ? SolveResult::Converged : SolveResult::NotConverged);
+    if (convergedReason == TAO_CONVERGED_USER) {
+        // Solver was interrupted: the last iterate may be worse than the one seen before
+        result = SolveResult::Interrupted;
+        if (hasBestIterate_ && VecCopy(bestX_, x_) != PETSC_SUCCESS) {
+            throw std::runtime_error("AnalyticalSolver: failed to restore the best iterate");
+        }
+    }
+
+    resumedMu_.reset();  // Checkpoint penalty is only relevant for the first solve after loading
+    lastSolveResult_ = result;
+    updateSolutionData();
+
     const auto endTimestamp = std::chrono::steady_clock::now();
     const double solvingDuration = std::chrono::duration<double>(endTimestamp - beginTimestamp).count();
     std::cerr << "AnalyticalSolver: finished solving in " << solvingDuration << " seconds!\n"
-              << "Converged reason: " << TaoConvergedReasons[convergedReason] << "\n";
+              << "Converged reason: " << TaoConvergedReasons[convergedReason]
+              << (result == SolveResult::Interrupted ? " (interrupted)" : "") << "\n";
+    return result;
 }
 
 bool AnalyticalSolver::rerunSolver()
@@ -99,37 +247,86 @@ bool AnalyticalSolver::rerunSolver()
     }
 }
 
-Model::Positions AnalyticalSolver::retrieveSolution() const
+void AnalyticalSolver::setDeadline(std::optional<Clock::time_point> deadline)
 {
-    const double* xArr = nullptr;
-    if (VecGetArrayRead(x_, &xArr) != PETSC_SUCCESS) {
-        return {};
+    options_.deadline = deadline;
+}
+
+bool AnalyticalSolver::saveCheckpoint(const std::filesystem::path& path, uint64_t problemHash) const
+{
+    std::ofstream ofstream(path, std::ios::binary);
+    if (!ofstream || writeCheckpoint(ofstream, problemHash) != PETSC_SUCCESS || !ofstream) {
+        std::cerr << "(!) AnalyticalSolver::saveCheckpoint: failed to write checkpoint to " << path << "\n";
+        return false;
     }
-    Model::Positions solution(objectCnt_);
+    return true;
+}
+
+std::optional<SolveResult> AnalyticalSolver::loadCheckpoint(const std::filesystem::path& path, uint64_t problemHash)
+{
+    std::ifstream ifstream(path, std::ios::binary);
+    SolveResult solveResult;
+    if (!ifstream || readCheckpoint(ifstream, problemHash, solveResult) != PETSC_SUCCESS) {
+        std::cerr << "(!) AnalyticalSolver::loadCheckpoint: failed to read checkpoint from " << path << "\n";
+        return std::nullopt;
+    }
+    return solveResult;
+}
+
+bool AnalyticalSolver::setInitialSolution(const Model::Positions& positions)
+{
+    assert(positions.size() == objectCnt_ && "AnalyticalSolver::setInitialSolution: invalid positions count");
     for (size_t objId = 0; objId < objectCnt_; ++objId) {
         const auto [xId, yId] = Model::VarUtils::getVariablesIds(objId);
-        solution[objId].x = xArr[xId];
-        solution[objId].y = xArr[yId];
+        xBuffer_[xId] = positions[objId].x;
+        xBuffer_[yId] = positions[objId].y;
+    }
+    if (isScaled()) {
+        toSolverSpace(xBuffer_, xBuffer_);
+    }
+    updateSolutionData();
+    // x_ was modified behind PETSc's back
+    return PetscObjectStateIncrease(reinterpret_cast<PetscObject>(x_)) == PETSC_SUCCESS;
+}
+
+Model::Positions AnalyticalSolver::retrieveSolution() const
+{
+    Model::Positions solution(objectCnt_);
+    for (size_t objId = 0; objId < objectCnt_; ++objId) {
+        const auto [varX, varY] = Model::VarUtils::getVariablesVal(getSolutionData(), objId);
+        solution[objId].x = varX;
+        solution[objId].y = varY;
     }
-    static_cast<void>(VecRestoreArrayRead(x_, &xArr));
     return solution;
 }
 
-PetscErrorCode AnalyticalSolver::initializePETSc()
+const double* AnalyticalSolver::getSolutionData() const
 {
-    PetscFunctionBegin;
+    return (isScaled() ? solutionBuffer_ : xBuffer_);
+}
 
-    std::optional<CLUtils::CLArguments> clArgs = CLUtils::provideCLArgumentsHandler().provideArguments();
-    if (clArgs.has_value()) {
-        auto [argc, argv] = clArgs.value();
-        PetscCall(PetscInitialize(&argc, &argv, nullptr, nullptr));
-    } else {
-        PetscCall(PetscInitializeNoArguments());
-    }
+const SolveStatistics& AnalyticalSolver::getStatistics() const
+{
+    return statistics_;
+}
+
+SolveResult AnalyticalSolver::getLastSolveResult() const
+{
+    return lastSolveResult_;
+}
 
+PetscErrorCode AnalyticalSolver::initializePETSc()
+{
+    PetscFunctionBegin;
+    PetscCall(acquirePETSc());
     PetscFunctionReturn(PETSC_SUCCESS);
 }
 
+void AnalyticalSolver::finalizePETSc()
+{
+    releasePETSc();
+}
+
 PetscErrorCode AnalyticalSolver::initializeTAOSolvers()
 {
     PetscFunctionBegin;
@@ -163,18 +360,30 @@ PetscErrorCode AnalyticalSolver::initializeTAOContainers()
 {
     PetscFunctionBegin;
 
-    PetscCall(VecCreateSeq(PETSC_COMM_SELF, varCnt_, &x_));
-    PetscCall(VecCreateSeq(PETSC_COMM_SELF, varCnt_, &xLowerBound_));
-    PetscCall(VecCreateSeq(PETSC_COMM_SELF, varCnt_, &xUpperBound_));
-    PetscCall(VecCreateSeq(PETSC_COMM_SELF, varCnt_, &costGradient_));
-    PetscCall(VecCreateSeq(PETSC_COMM_SELF, cEqCnt_, &cEq_));
-    // TODO: should this matrix be dense?
-    // PetscCall(MatCreateSeqDense(PETSC_COMM_SELF, cEqCnt_, varCnt_, nullptr, &JEq_));
-    PetscCall(MatCreateSeqAIJ(PETSC_COMM_SELF, cEqCnt_, varCnt_, varCnt_, nullptr, &JEq_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, varCnt_, xBuffer_, &x_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, varCnt_, bestXBuffer_, &bestX_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, varCnt_, xLowerBoundBuffer_, &xLowerBound_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, varCnt_, xUpperBoundBuffer_, &xUpperBound_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, varCnt_, costGradientBuffer_, &costGradient_));
+    PetscCall(VecCreateSeqWithArray(PETSC_COMM_SELF, 1, cEqCnt_, cEqBuffer_, &cEq_));
+
+    // Each constraint usually depends on two objects, i.e. 4 variables. Constraints that need more still work, but
+    // require extra allocations on the first assembly.
+    // After the first assembly the sparsity pattern is fixed (see evaluate).
+    constexpr PetscInt kJEqRowNonzerosHint = 4;
+    PetscCall(MatCreateSeqAIJ(
+        PETSC_COMM_SELF, cEqCnt_, varCnt_, std::min<PetscInt>(kJEqRowNonzerosHint, varCnt_), nullptr, &JEq_));
+    PetscCall(MatSetOption(JEq_, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE));
+
+    // Scales are only viewed: options_ outlive the solver's containers
+    if (isScaled()) {
+        PetscCall(VecCreateSeqWithArray(
+            PETSC_COMM_SELF, 1, varCnt_, options_.scaling.variables.data(), &variablesScales_));
+    }
 
-    // Set initial solution to zero. The exact value doesn't matter, because at the first iteration constraints will
-    // be disabled, and therefore solver will find the solution where most of the corridors are exactly zero.
-    PetscCall(VecSet(x_, 0));
+    // Initial solution is zero (buffers are zeroed in the constructor). The exact value doesn't matter, because at the
+    // first iteration constraints will be disabled, and therefore solver will find the solution where most of the
+    // corridors are exactly zero.
 
     // Set variables bounds
     double* xLowerBoundArr;
@@ -184,8 +393,12 @@ PetscErrorCode AnalyticalSolver::initializeTAOContainers()
 
     auto setBounds = [xLowerBoundArr, xUpperBoundArr, this](size_t varId) {
         if (variablesBounds_[varId].has_value()) {
-            xLowerBoundArr[varId] = variablesBounds_[varId]->lowerBound;
-            xUpperBoundArr[varId] = variablesBounds_[varId]->upperBound;
+            // Scales are positive, so bounds keep their order. Infinite ends are one-sided bounds.
+            const double scale = (isScaled() ? options_.scaling.variables[varId] : 1.0);
+            const double lowerBound = variablesBounds_[varId]->lowerBound;
+            const double upperBound = variablesBounds_[varId]->upperBound;
+            xLowerBoundArr[varId] = (std::isinf(lowerBound) ? PETSC_NINFINITY : lowerBound / scale);
+            xUpperBoundArr[varId] = (std::isinf(upperBound) ? PETSC_INFINITY : upperBound / scale);
         } else {
             xLowerBoundArr[varId] = PETSC_NINFINITY;
             xUpperBoundArr[varId] = PETSC_INFINITY;
@@ -215,9 +428,9 @@ PetscErrorCode AnalyticalSolver::setContainersAndRoutines()
     PetscCall(TaoSetConvergenceTest(almmSolver_, almmConvergenceTest, this));
 
     PetscCall(TaoMonitorSet(almmSolver_, monitorALMM, this, nullptr));
-    if (std::getenv("_DEV_MONITOR_SUBSOLVER") != nullptr) {
-        PetscCall(TaoMonitorSet(almmSubsolver_, monitorSubsolver, this, nullptr));
-    }
+    // Subsolver monitor is always set: it's responsible for interrupting long subsolver runs
+    verboseSubsolverMonitor_ = std::getenv("_DEV_MONITOR_SUBSOLVER") != nullptr;
+    PetscCall(TaoMonitorSet(almmSubsolver_, monitorSubsolver, this, nullptr));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
@@ -247,11 +460,13 @@ void AnalyticalSolver::destroyTAOObjects()
     // Plus it's almost impossible to begin with
     if (almmSolver_) static_cast<void>(TaoDestroy(&almmSolver_));
     if (x_) static_cast<void>(VecDestroy(&x_));
+    if (bestX_) static_cast<void>(VecDestroy(&bestX_));
     if (xLowerBound_) static_cast<void>(VecDestroy(&xLowerBound_));
     if (xUpperBound_) static_cast<void>(VecDestroy(&xUpperBound_));
     if (costGradient_) static_cast<void>(VecDestroy(&costGradient_));
     if (cEq_) static_cast<void>(VecDestroy(&cEq_));
     if (JEq_) static_cast<void>(MatDestroy(&JEq_));
+    if (variablesScales_) static_cast<void>(VecDestroy(&variablesScales_));
 }
 
 PetscErrorCode AnalyticalSolver::prepareSolverRerun()
@@ -276,19 +491,256 @@ PetscErrorCode AnalyticalSolver::prepareSolverRerun()
     PetscFunctionReturn(PETSC_SUCCESS);
 }
 
+PetscErrorCode AnalyticalSolver::evaluateAll(Vec xVec)
+{
+    PetscFunctionBegin;
+
+    EvaluationKey key;
+    PetscCall(PetscObjectGetId(reinterpret_cast<PetscObject>(xVec), &key.vecId));
+    PetscCall(PetscObjectStateGet(reinterpret_cast<PetscObject>(xVec), &key.vecState));
+    if (evaluationKey_ == key) {
+        PetscFunctionReturn(PETSC_SUCCESS);
+    }
+
+    evaluationKey_.reset();
+    const double* yArr;
+    PetscCall(VecGetArrayRead(xVec, &yArr));
+    const PetscErrorCode error = evaluate(yArr, evaluatedF_, evaluatedGradient_, evaluatedCEq_);
+    PetscCall(VecRestoreArrayRead(xVec, &yArr));
+    PetscCall(error);
+    evaluationKey_ = key;
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
+PetscErrorCode AnalyticalSolver::evaluate(const double* y, double& f, double* grad, double* cEq)
+{
+    PetscFunctionBegin;
+
+    const double* x = getModelVariables(y);
+
+    // Calculate cost, constraints values and Jacobian (latter is written directly into JEq matrix).
+    // Once the pattern is fixed, zeroing only resets values and assembly doesn't need to rebuild the structure.
+    f = 0.0;
+    std::fill_n(grad, varCnt_, 0.0);
+    std::fill_n(cEq, cEqCnt_, 0.0);
+    PetscCall(MatZeroEntries(JEq_));
+    for (const Callbacks::FGEval& costFunction : costFunctions_) {
+        costFunction(x, f, grad);
+    }
+    const size_t separateCEqCnt = equalityConstraints_.size();
+    for (size_t cEqId = 0; cEqId < separateCEqCnt; ++cEqId) {
+        equalityConstraints_[cEqId](x, cEq[cEqId], JEq_, cEqId);
+    }
+    size_t firstCEqId = separateCEqCnt;
+    for (const FusedTerms& terms : fusedTerms_) {
+        terms.evaluate(x, f, grad, cEq, JEq_, firstCEqId);
+        firstCEqId += terms.constraintCount;
+    }
+    PetscCall(MatAssemblyBegin(JEq_, MAT_FINAL_ASSEMBLY));
+    PetscCall(MatAssemblyEnd(JEq_, MAT_FINAL_ASSEMBLY));
+
+    // df/dy = cost * variables * df/dx
+    const Scaling& scaling = options_.scaling;
+    if (scaling.cost != 1.0) {
+        f *= scaling.cost;
+        std::transform(grad, grad + varCnt_, grad, [&scaling](double gradVal) { return scaling.cost * gradVal; });
+    }
+    if (isScaled()) {
+        std::transform(grad, grad + varCnt_, scaling.variables.begin(), grad, std::multiplies<double>());
+    }
+
+    // dc/dy = dc/dx * diag(variables)
+    if (variablesScales_ != nullptr) {
+        PetscCall(MatDiagonalScale(JEq_, nullptr, variablesScales_));
+    }
+
+    if (!JEqPatternFixed_) {
+        // Constraints always write the same entries (zeros included), so a new nonzero afterwards is a bug
+        PetscCall(MatSetOption(JEq_, MAT_NEW_NONZERO_LOCATION_ERR, PETSC_TRUE));
+        JEqPatternFixed_ = true;
+    }
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
 PetscErrorCode AnalyticalSolver::runCallbacks(int iterNum)
 {
     PetscFunctionBegin;
 
-    double* xArr;
-    PetscCall(VecGetArray(x_, &xArr));
+    // Callbacks work with model variables, modifications are converted back
+    double* yArr;
+    PetscCall(VecGetArray(x_, &yArr));
+    double* xArr = yArr;
+    if (isScaled()) {
+        xArr = modelXBuffer_;
+        toModelSpace(yArr, xArr);
+    }
     for (const Callbacks::ModifierCallback& callback : modifierCallbacks_) {
         callback(xArr);
     }
     for (const Callbacks::ReaderCallback& callback : readerCallbacks_) {
         callback(xArr, runId_, iterNum);
     }
+    if (!readerCallbacks_.empty()) {
+        // Readers may update the functions themselves (e.g. candidate pairs), so cached values are stale
+        evaluationKey_.reset();
+    }
+    if (isScaled() && !modifierCallbacks_.empty()) {
+        toSolverSpace(xArr, yArr);
+    }
+    PetscCall(VecRestoreArray(x_, &yArr));
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
+PetscErrorCode AnalyticalSolver::writeCheckpoint(std::ostream& ostream, uint64_t problemHash) const
+{
+    PetscFunctionBegin;
+
+    Vec multipliersVec;
+    PetscInt multipliersCnt;
+    PetscCall(TaoALMMGetMultipliers(almmSolver_, &multipliersVec));
+    PetscCall(VecGetSize(multipliersVec, &multipliersCnt));
+    const TAO_ALMM* almmData = reinterpret_cast<const TAO_ALMM*>(almmSolver_->data);
+
+    const CheckpointHeader header{
+        .magic = kCheckpointMagic,
+        .version = kCheckpointVersion,
+        .problemHash = problemHash,
+        .solveResult = static_cast<uint64_t>(lastSolveResult_),
+        .varCnt = varCnt_,
+        .multipliersCnt = static_cast<uint64_t>(multipliersCnt),
+        .runId = runId_,
+        .mu = almmData->mu,
+        .muFactor = almmData->mu_fac};
+    ostream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Solution is stored in model variables, multipliers are stored as is (i.e. for scaled constraints)
+    const double* multipliersArr;
+    ostream.write(reinterpret_cast<const char*>(getSolutionData()), varCnt_ * sizeof(double));
+    PetscCall(VecGetArrayRead(multipliersVec, &multipliersArr));
+    ostream.write(reinterpret_cast<const char*>(multipliersArr), multipliersCnt * sizeof(double));
+    PetscCall(VecRestoreArrayRead(multipliersVec, &multipliersArr));
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
+PetscErrorCode AnalyticalSolver::readCheckpoint(std::istream& istream, uint64_t problemHash, SolveResult& solveResult)
+{
+    PetscFunctionBegin;
+
+    Vec multipliersVec;
+    PetscInt multipliersCnt;
+    PetscCall(TaoALMMGetMultipliers(almmSolver_, &multipliersVec));
+    PetscCall(VecGetSize(multipliersVec, &multipliersCnt));
+
+    CheckpointHeader header;
+    istream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!istream || header.magic != kCheckpointMagic || header.version != kCheckpointVersion) {
+        std::cerr << "(!) AnalyticalSolver::readCheckpoint: not a checkpoint file or unsupported version\n";
+        PetscFunctionReturn(PETSC_ERR_FILE_UNEXPECTED);
+    }
+    if (header.problemHash != problemHash) {
+        std::cerr << "(!) AnalyticalSolver::readCheckpoint: checkpoint was made for a different problem\n";
+        PetscFunctionReturn(PETSC_ERR_ARG_WRONG);
+    }
+    if (header.solveResult > static_cast<uint64_t>(SolveResult::Interrupted)) {
+        std::cerr << "(!) AnalyticalSolver::readCheckpoint: invalid solve result\n";
+        PetscFunctionReturn(PETSC_ERR_FILE_UNEXPECTED);
+    }
+    if (header.varCnt != varCnt_ || header.multipliersCnt != static_cast<uint64_t>(multipliersCnt)) {
+        std::cerr << "(!) AnalyticalSolver::readCheckpoint: checkpoint was made for a problem of different size\n";
+        PetscFunctionReturn(PETSC_ERR_ARG_SIZ);
+    }
+
+    // Read everything before touching the solver, so that it stays intact if the file is truncated
+    std::vector<double> xVals(varCnt_);
+    std::vector<double> multipliersVals(multipliersCnt);
+    istream.read(reinterpret_cast<char*>(xVals.data()), xVals.size() * sizeof(double));
+    istream.read(reinterpret_cast<char*>(multipliersVals.data()), multipliersVals.size() * sizeof(double));
+    if (!istream) {
+        std::cerr << "(!) AnalyticalSolver::readCheckpoint: checkpoint file is truncated\n";
+        PetscFunctionReturn(PETSC_ERR_FILE_READ);
+    }
+
+    double* xArr;
+    double* multipliersArr;
+    PetscCall(VecGetArray(x_, &xArr));
+    if (isScaled()) {
+        toSolverSpace(xVals.data(), xArr);
+    } else {
+        std::copy(xVals.begin(), xVals.end(), xArr);
+    }
     PetscCall(VecRestoreArray(x_, &xArr));
+    updateSolutionData();
+    PetscCall(VecGetArray(multipliersVec, &multipliersArr));
+    std::copy(multipliersVals.begin(), multipliersVals.end(), multipliersArr);
+    PetscCall(VecRestoreArray(multipliersVec, &multipliersArr));
+    PetscCall(TaoSetRecycleHistory(almmSolver_, PETSC_TRUE));
+
+    runId_ = header.runId;
+    resumedMu_ = header.mu;
+    options_.muFactor = header.muFactor;
+    lastSolveResult_ = static_cast<SolveResult>(header.solveResult);
+    solveResult = lastSolveResult_;
+
+    PetscFunctionReturn(PETSC_SUCCESS);
+}
+
+bool AnalyticalSolver::isScaled() const
+{
+    return !options_.scaling.variables.empty();
+}
+
+void AnalyticalSolver::toModelSpace(const double* y, double* x) const
+{
+    assert(isScaled() && "AnalyticalSolver::toModelSpace: variables are not scaled");
+    std::transform(y, y + varCnt_, options_.scaling.variables.begin(), x, std::multiplies<double>());
+}
+
+void AnalyticalSolver::toSolverSpace(const double* x, double* y) const
+{
+    assert(isScaled() && "AnalyticalSolver::toSolverSpace: variables are not scaled");
+    std::transform(x, x + varCnt_, options_.scaling.variables.begin(), y, std::divides<double>());
+}
+
+const double* AnalyticalSolver::getModelVariables(const double* y)
+{
+    if (!isScaled()) {
+        return y;
+    }
+    toModelSpace(y, modelXBuffer_);
+    return modelXBuffer_;
+}
+
+void AnalyticalSolver::updateSolutionData()
+{
+    if (isScaled()) {
+        toModelSpace(xBuffer_, solutionBuffer_);
+    }
+}
+
+bool AnalyticalSolver::isInterrupted() const
+{
+    if (options_.cancellationToken != nullptr && options_.cancellationToken->isCancelled()) {
+        return true;
+    }
+    return options_.deadline.has_value() && Clock::now() >= options_.deadline.value();
+}
+
+PetscErrorCode AnalyticalSolver::updateBestIterate(double f, double cnorm, double catol)
+{
+    PetscFunctionBegin;
+
+    // Everything below the constraint tolerance is equally feasible
+    const double cViolation = std::max(cnorm, catol);
+    if (!hasBestIterate_ || cViolation < bestCViolation_ || (cViolation == bestCViolation_ && f < bestF_)) {
+        PetscCall(VecCopy(x_, bestX_));
+        bestCViolation_ = cViolation;
+        bestF_ = f;
+        hasBestIterate_ = true;
+    }
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
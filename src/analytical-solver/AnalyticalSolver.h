@@ -1,36 +1,131 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
 #include <vector>
 
 #include <callbacks/Defs.h>
 #include <model/Model.h>
 #include <model/Room.h>
 #include <petsctao.h>
+#include <utils/Memory.h>
 
+#include "CancellationToken.h"
+#include "SolverWorkspace.h"
 #include "TAOCallbacks.h"
 
 namespace DungeonGeneration {
 namespace AnalyticalSolver {
 
+using Clock = std::chrono::steady_clock;
+
+/// Diagonal scaling between model variables x and variables y seen by TAO: x = variables * y. Cost function seen by
+/// TAO is multiplied by `cost`. Callbacks always work with model variables and unscaled values. Empty vector means no
+/// scaling.
+struct Scaling {
+    std::vector<double> variables;
+    double cost = 1.0;
+};
+
+/// Cost terms and constraints evaluated together, see Callbacks::FusedEval. Constraints of fused terms follow the
+/// separate ones, in the order of the terms.
+struct FusedTerms {
+    Callbacks::FusedEval evaluate;
+    size_t constraintCount = 0;
+};
+
+/// ALMM penalty growth factor
+constexpr double kDefaultMuFactor = 25.0;
+
+struct SolverOptions {
+    double muFactor = kDefaultMuFactor;
+    /// Penalty of the first ALMM iteration of every solve. By default constraints are off on the first iteration (mu
+    /// is 0, then 1), which suits solving from scratch. Solves that start near a feasible layout should keep them on.
+    std::optional<double> initialMu;
+    /// Solver is interrupted once the token is cancelled or the deadline is passed. The best iterate found so far is
+    /// kept as a solution in that case.
+    const CancellationToken* cancellationToken = nullptr;
+    std::optional<Clock::time_point> deadline;
+    Scaling scaling;
+    /// Buffers are taken from the workspace if it's set (it must outlive the solver), otherwise solver owns them
+    SolverWorkspace* workspace = nullptr;
+};
+
+/// Iteration counts of the last solve
+struct SolveStatistics {
+    double setupSeconds = 0.0;  // Construction of the solver, kept between solves
+    size_t almmIterations = 0;
+    size_t subsolverIterations = 0;   // Summed over all ALMM iterations
+    size_t subsolverEvaluations = 0;  // Function evaluations requested by the subsolver
+};
+
+enum class SolveResult {
+    Converged,
+    NotConverged,  // e.g. iteration limit was reached
+    Interrupted,   // cancelled or deadline exceeded
+};
+
+/// Whether PETSc is built with `--with-threadsafety` (PETSC_HAVE_THREADSAFETY in petscconf.h). Otherwise solvers of
+/// different threads run one at a time: each of them holds a process-wide lock from construction to destruction.
+bool isPETScThreadSafe();
+
+/// Keeps PETSc initialized while alive. Solvers that run on different threads need an instance of this class to be
+/// created on the main thread beforehand. They run concurrently only if PETSc is thread-safe, see isPETScThreadSafe.
+class PETScScope {
+public:
+    PETScScope();
+    /// PETSc options are parsed from the command line, if this scope is the one that initializes PETSc
+    PETScScope(int& argc, char**& argv);
+    ~PETScScope();
+
+    PETScScope(const PETScScope&) = delete;
+    PETScScope& operator=(const PETScScope&) = delete;
+};
+
 class AnalyticalSolver {
 public:
     AnalyticalSolver(
         size_t objectCnt, size_t varCnt, Model::VariablesBounds&& variablesBounds,
         std::vector<Callbacks::FGEval>&& costFunctions, std::vector<Callbacks::CEqFGEval>&& equalityConstraints,
-        std::vector<Callbacks::ModifierCallback>&& modifierCallbacks,
-        std::vector<Callbacks::ReaderCallback>&& readerCallbacks);
+        std::vector<FusedTerms>&& fusedTerms, std::vector<Callbacks::ModifierCallback>&& modifierCallbacks,
+        std::vector<Callbacks::ReaderCallback>&& readerCallbacks, const SolverOptions& options = {});
 
     ~AnalyticalSolver();
 
-    void solve();
+    SolveResult solve();
 
     /// Try to improve solution by rerunning ALMM solver
     bool rerunSolver();
 
+    /// Replaces the deadline of SolverOptions for the following solves, e.g. to give each rerun its own time budget
+    void setDeadline(std::optional<Clock::time_point> deadline);
+
+    /// Save full solver state (solution, ALMM multipliers and penalty, run id, result of the last solve) to be resumed
+    /// later, e.g. after the solve was interrupted. `problemHash` identifies the problem (model, parameters, settings):
+    /// the checkpoint is only restored for the same hash and problem dimensions.
+    bool saveCheckpoint(const std::filesystem::path& path, uint64_t problemHash) const;
+    /// Restore state saved by saveCheckpoint. The next solve (or rerun) continues from it. Returns the result of the
+    /// solve the checkpoint was made after (Interrupted means it wasn't finished), or nothing if it can't be restored.
+    std::optional<SolveResult> loadCheckpoint(const std::filesystem::path& path, uint64_t problemHash);
+
+    /// Set the starting point for the next solve. By default solver starts with all variables set to zero.
+    bool setInitialSolution(const Model::Positions& positions);
+
     Model::Positions retrieveSolution() const;
+    /// Current solution in the variables layout, without copying. Pointer stays valid while solver is alive (and its
+    /// workspace isn't passed to another solver), values are updated by each solve.
+    const double* getSolutionData() const;
+
+    const SolveStatistics& getStatistics() const;
+    /// Result of the last solve or rerun, e.g. to tell whether the current solution was cut short
+    SolveResult getLastSolveResult() const;
 
 private:
     PetscErrorCode initializePETSc();
+    void finalizePETSc();
     PetscErrorCode initializeTAOSolvers();
     PetscErrorCode initializeTAOContainers();
     PetscErrorCode setContainersAndRoutines();
@@ -40,9 +135,33 @@ private:
     /// Implementation of rerunSolver routine. It's needed to properly call PETSc functions
     PetscErrorCode prepareSolverRerun();
 
+    PetscErrorCode writeCheckpoint(std::ostream& ostream, uint64_t problemHash) const;
+    PetscErrorCode readCheckpoint(std::istream& istream, uint64_t problemHash, SolveResult& solveResult);
+
+    /// Evaluate cost functions, constraints and the Jacobian (into JEq_) at `xVec` in a single pass into the evaluation
+    /// cache, unless the cache already holds them for the current state of `xVec`. TAO asks for all of them at the
+    /// same point, so whichever request comes first computes everything.
+    PetscErrorCode evaluateAll(Vec xVec);
+    /// Evaluation of user functions at TAO variables `y`. Outputs are zeroed before callbacks accumulate into them, and
+    /// are scaled afterwards.
+    PetscErrorCode evaluate(const double* y, double& f, double* grad, double* cEq);
+
     /// Run callbacks (e.g. SVG dump) after each ALMM iteration.
     PetscErrorCode runCallbacks(int iterNum);
 
+    // Conversions between model variables x and TAO variables y, see Scaling
+    bool isScaled() const;
+    void toModelSpace(const double* y, double* x) const;
+    void toSolverSpace(const double* x, double* y) const;
+    /// Model variables at `y`: either `y` itself or a copy converted into modelXBuffer_
+    const double* getModelVariables(const double* y);
+    /// Update the solution returned by getSolutionData after x_ has changed
+    void updateSolutionData();
+
+    bool isInterrupted() const;
+    /// Remember current solution if it's better than the best one so far. Called after each ALMM iteration.
+    PetscErrorCode updateBestIterate(double f, double cnorm, double catol);
+
     friend PetscErrorCode evaluateCostFunctionGradient(Tao, Vec, double*, Vec, void*);
     friend PetscErrorCode evaluateEqualityConstraintsFunction(Tao, Vec, Vec, void*);
     friend PetscErrorCode evaluateEqualityConstraintsJacobian(Tao, Vec, Mat, Mat, void*);
@@ -50,6 +169,9 @@ private:
     friend PetscErrorCode monitorSubsolver(Tao, void*);
     friend PetscErrorCode almmConvergenceTest(Tao, void*);
 
+    // Held while the solver is alive, unless PETSc is thread-safe. Released last.
+    std::unique_lock<std::recursive_mutex> petscLock_;
+
     // Task info
     size_t objectCnt_;
     size_t varCnt_;
@@ -57,16 +179,60 @@ private:
     Model::VariablesBounds variablesBounds_;
     std::vector<Callbacks::FGEval> costFunctions_;
     std::vector<Callbacks::CEqFGEval> equalityConstraints_;
+    std::vector<FusedTerms> fusedTerms_;
     std::vector<Callbacks::ModifierCallback> modifierCallbacks_;
     std::vector<Callbacks::ReaderCallback> readerCallbacks_;
 
+    SolverOptions options_;
+
     // Run info
     size_t runId_ = 0;
+    std::optional<double> resumedMu_;  // Penalty restored from a checkpoint, used instead of the initial one
+    SolveResult lastSolveResult_ = SolveResult::NotConverged;
+    bool verboseSubsolverMonitor_ = false;
+    SolveStatistics statistics_;
+
+    // Evaluation cache. Key identifies both the vector and its contents: PETSc increases object state on every
+    // modification. Reader callbacks may change the functions, so the cache is reset after them.
+    struct EvaluationKey {
+        PetscObjectId vecId;
+        PetscObjectState vecState;
+
+        bool operator==(const EvaluationKey& other) const
+        {
+            return vecId == other.vecId && vecState == other.vecState;
+        }
+    };
+    std::optional<EvaluationKey> evaluationKey_;
+    double evaluatedF_ = 0.0;
+
+    // Best iterate by (constraint violation, cost function), returned if the solve is interrupted
+    Vec bestX_ = nullptr;
+    double bestCViolation_ = 0.0;
+    double bestF_ = 0.0;
+    bool hasBestIterate_ = false;
 
     // TAO solvers
     Tao almmSolver_ = nullptr;
     Tao almmSubsolver_ = nullptr;
 
+    // Storage of TAO containers. Vectors are created on top of these buffers, so that solver can access them directly.
+    // Declared before vectors: buffers must outlive them.
+    std::optional<SolverWorkspace> ownWorkspace_;  // Used if options don't provide a workspace
+    SolverWorkspace& workspace_;
+    // Views of the workspace buffers, sized to the problem
+    double* xBuffer_ = nullptr;
+    double* bestXBuffer_ = nullptr;
+    double* xLowerBoundBuffer_ = nullptr;
+    double* xUpperBoundBuffer_ = nullptr;
+    double* costGradientBuffer_ = nullptr;
+    double* cEqBuffer_ = nullptr;
+    double* evaluatedGradient_ = nullptr;
+    double* evaluatedCEq_ = nullptr;  // Jacobian is kept in JEq_
+    // Used only with scaling: model variables passed to callbacks and the solution in model variables
+    double* modelXBuffer_ = nullptr;
+    double* solutionBuffer_ = nullptr;
+
     // TAO containers
     Vec x_ = nullptr;
     Vec xLowerBound_ = nullptr;
@@ -74,10 +240,12 @@ private:
     Vec costGradient_ = nullptr;
     Vec cEq_ = nullptr;
     Mat JEq_ = nullptr;
+    Vec variablesScales_ = nullptr;  // View of scaling options, used to scale JEq
+    bool JEqPatternFixed_ = false;  // Set after the first assembly: sparsity pattern doesn't change afterwards
 
-    // Helper containers used to update JEq
-    std::vector<PetscInt> JEqRowIndexes_;
-    std::vector<PetscInt> JEqColIndexes_;
+    // Helper containers used to update JEq: 0, 1, 2, ...
+    const PetscInt* JEqRowIndexes_ = nullptr;
+    const PetscInt* JEqColIndexes_ = nullptr;
 };
 
 }  // namespace AnalyticalSolver
@@ -0,0 +1,17 @@
+#include "CancellationToken.h"
+
+namespace DungeonGeneration {
+namespace AnalyticalSolver {
+
+void CancellationToken::cancel()
+{
+    cancelled_.store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return cancelled_.load(std::memory_order_relaxed);
+}
+
+}  // namespace AnalyticalSolver
+}  // namespace DungeonGeneration
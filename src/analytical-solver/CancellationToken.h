@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+
+namespace DungeonGeneration {
+namespace AnalyticalSolver {
+
+/// Thread-safe flag used to cooperatively interrupt running solvers. One token can be shared by several solvers.
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel();
+    bool isCancelled() const;
+
+private:
+    std::atomic<bool> cancelled_ = false;
+};
+
+}  // namespace AnalyticalSolver
+}  // namespace DungeonGeneration
@@ -0,0 +1,42 @@
+#include "SolverWorkspace.h"
+
+#include <numeric>
+
+namespace DungeonGeneration {
+namespace AnalyticalSolver {
+
+SolverWorkspace::SolverWorkspace(size_t varCapacity, size_t cEqCapacity)
+{
+    reserve(varCapacity, cEqCapacity);
+}
+
+void SolverWorkspace::reserve(size_t varCnt, size_t cEqCnt)
+{
+    if (varCnt > varCapacity()) {
+        for (Memory::AlignedVector<double>* buffer :
+             {&x_, &bestX_, &xLowerBound_, &xUpperBound_, &costGradient_, &evaluatedGradient_, &modelX_, &solution_}) {
+            buffer->resize(varCnt);
+        }
+        JEqColIndexes_.resize(varCnt);
+        std::iota(JEqColIndexes_.begin(), JEqColIndexes_.end(), 0);
+    }
+    if (cEqCnt > cEqCapacity()) {
+        cEq_.resize(cEqCnt);
+        evaluatedCEq_.resize(cEqCnt);
+        JEqRowIndexes_.resize(cEqCnt);
+        std::iota(JEqRowIndexes_.begin(), JEqRowIndexes_.end(), 0);
+    }
+}
+
+size_t SolverWorkspace::varCapacity() const
+{
+    return x_.size();
+}
+
+size_t SolverWorkspace::cEqCapacity() const
+{
+    return cEq_.size();
+}
+
+}  // namespace AnalyticalSolver
+}  // namespace DungeonGeneration
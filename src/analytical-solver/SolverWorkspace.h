@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <petsctao.h>
+#include <utils/Memory.h>
+
+namespace DungeonGeneration {
+namespace AnalyticalSolver {
+
+/// Buffers of a solver that outlive it. A worker that solves problems one after another passes the same workspace to
+/// each solver, so that problems up to the workspace capacity don't allocate buffers. Used by one solver at a time.
+class SolverWorkspace {
+public:
+    SolverWorkspace() = default;
+    SolverWorkspace(size_t varCapacity, size_t cEqCapacity);
+
+    SolverWorkspace(const SolverWorkspace&) = delete;
+    SolverWorkspace& operator=(const SolverWorkspace&) = delete;
+
+    /// Grow buffers to fit the problem, if needed. Contents aren't preserved.
+    void reserve(size_t varCnt, size_t cEqCnt);
+
+    size_t varCapacity() const;
+    size_t cEqCapacity() const;
+
+private:
+    friend class AnalyticalSolver;
+
+    // Vectors of variables
+    Memory::AlignedVector<double> x_;
+    Memory::AlignedVector<double> bestX_;
+    Memory::AlignedVector<double> xLowerBound_;
+    Memory::AlignedVector<double> xUpperBound_;
+    Memory::AlignedVector<double> costGradient_;
+    Memory::AlignedVector<double> evaluatedGradient_;
+    Memory::AlignedVector<double> modelX_;    // Used only with scaling
+    Memory::AlignedVector<double> solution_;  // Used only with scaling
+    std::vector<PetscInt> JEqColIndexes_;     // 0, 1, ..., capacity - 1
+
+    // Vectors of constraints
+    Memory::AlignedVector<double> cEq_;
+    Memory::AlignedVector<double> evaluatedCEq_;
+    std::vector<PetscInt> JEqRowIndexes_;  // 0, 1, ..., capacity - 1
+};
+
+}  // namespace AnalyticalSolver
+}  // namespace DungeonGeneration
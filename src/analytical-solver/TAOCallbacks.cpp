@@ -1,7 +1,9 @@
 #include "TAOCallbacks.h"
 
+#include <algorithm>
 #include <cassert>
 #include <numeric>
+#include <optional>
 
 #include "AnalyticalSolver.h"
 #include "PrintingUtils.h"
@@ -13,13 +15,14 @@ namespace AnalyticalSolver {
 namespace {
 
 /// Setup penalty factor mu that was overriden in the process of TAO configuration.
-void almmOverrideMu(Tao almmSolver, int iterNum)
+/// If `initialMu` is set (e.g. solver was resumed from a checkpoint), it's used instead of 0.
+void almmOverrideMu(Tao almmSolver, int iterNum, double muFactor, std::optional<double> initialMu)
 {
     if (iterNum == 0) {
         TAO_ALMM* almmData = reinterpret_cast<TAO_ALMM*>(almmSolver->data);
-        almmData->mu = 0;
-        almmData->mu_fac = 25;
-    } else if (iterNum == 1) {
+        almmData->mu = initialMu.value_or(0);
+        almmData->mu_fac = muFactor;
+    } else if (iterNum == 1 && !initialMu.has_value()) {
         // ALMM recalculates penalty as mu *= mu_fac. We set mu = 0 at the first iteration, so we need to set it to 1.
         TAO_ALMM* almmData = reinterpret_cast<TAO_ALMM*>(almmSolver->data);
         almmData->mu = 1;
@@ -33,23 +36,14 @@ PetscErrorCode evaluateCostFunctionGradient(Tao almmSolver, Vec xVec, double* f,
     PetscFunctionBegin;
 
     AnalyticalSolver* solver = reinterpret_cast<AnalyticalSolver*>(ctx);
-    const size_t varCnt = solver->varCnt_;
-
-    // Zero out result variables
-    *f = 0.0;
-    PetscCall(VecSet(gVec, 0.0));
 
-    const double* xArr;
+    // Cost, constraints and Jacobian are evaluated together, see AnalyticalSolver::evaluateAll
+    PetscCall(solver->evaluateAll(xVec));
+    *f = solver->evaluatedF_;
     double* gradArr;
-    PetscCall(VecGetArrayRead(xVec, &xArr));
-    PetscCall(VecGetArray(gVec, &gradArr));
-
-    for (const Callbacks::FGEval& costFunction : solver->costFunctions_) {
-        costFunction(xArr, *f, gradArr);
-    }
-
-    PetscCall(VecRestoreArrayRead(xVec, &xArr));
-    PetscCall(VecRestoreArray(gVec, &gradArr));
+    PetscCall(VecGetArrayWrite(gVec, &gradArr));
+    std::copy_n(solver->evaluatedGradient_, solver->varCnt_, gradArr);
+    PetscCall(VecRestoreArrayWrite(gVec, &gradArr));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
@@ -59,33 +53,12 @@ PetscErrorCode evaluateEqualityConstraintsFunction(Tao almmSolver, Vec xVec, Vec
     PetscFunctionBegin;
 
     AnalyticalSolver* solver = reinterpret_cast<AnalyticalSolver*>(ctx);
-    const size_t varCnt = solver->varCnt_;
-    const size_t cEqCnt = solver->cEqCnt_;
 
-    const double* xArr;
+    PetscCall(solver->evaluateAll(xVec));
     double* cEqArr;
-    PetscCall(VecGetArrayRead(xVec, &xArr));
-    PetscCall(VecSet(cEqVec, 0.0));
-    PetscCall(VecGetArray(cEqVec, &cEqArr));
-
-#ifndef NDEBUG
-    for (size_t i = 0; i < cEqCnt; ++i) {
-        assert(abs(cEqArr[i]) < 1e-9);
-    }
-#endif
-
-    // Calculate both constraints values and Jacobian (latter is written directly into JEq matrix)
-    Mat JEq = solver->JEq_;
-    PetscCall(MatZeroEntries(JEq));
-    for (size_t cEqId = 0; cEqId < cEqCnt; ++cEqId) {
-        solver->equalityConstraints_[cEqId](xArr, cEqArr[cEqId], JEq, cEqId);
-    }
-
-    PetscCall(MatAssemblyBegin(JEq, MAT_FINAL_ASSEMBLY));
-    PetscCall(MatAssemblyEnd(JEq, MAT_FINAL_ASSEMBLY));
-
-    PetscCall(VecRestoreArrayRead(xVec, &xArr));
-    PetscCall(VecRestoreArray(cEqVec, &cEqArr));
+    PetscCall(VecGetArrayWrite(cEqVec, &cEqArr));
+    std::copy_n(solver->evaluatedCEq_, solver->cEqCnt_, cEqArr);
+    PetscCall(VecRestoreArrayWrite(cEqVec, &cEqArr));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
@@ -94,7 +67,11 @@ PetscErrorCode evaluateEqualityConstraintsJacobian(Tao almmSolver, Vec xVec, Mat
 {
     PetscFunctionBegin;
 
-    // We just do nothing. JEq was already calculated in evaluateEqualityConstraintsFunction.
+    AnalyticalSolver* solver = reinterpret_cast<AnalyticalSolver*>(ctx);
+
+    // Rows were written into JEq by the pass that computed the constraints at xVec, this only recomputes them if TAO
+    // asks for another point
+    PetscCall(solver->evaluateAll(xVec));
 
     PetscFunctionReturn(PETSC_SUCCESS);
 }
@@ -106,19 +83,29 @@ PetscErrorCode almmConvergenceTest(Tao almmSolver, void* ctx)
     AnalyticalSolver* solver = reinterpret_cast<AnalyticalSolver*>(ctx);
 
     // Get solver info
-    double LGradNorm, cnorm, gatol, catol;
+    double f, LGradNorm, cnorm, gatol, catol;
     PetscInt iterNum, maxIterCount;
-    PetscCall(TaoGetSolutionStatus(almmSolver, &iterNum, nullptr, &LGradNorm, &cnorm, nullptr, nullptr));
+    PetscCall(TaoGetSolutionStatus(almmSolver, &iterNum, &f, &LGradNorm, &cnorm, nullptr, nullptr));
     PetscCall(TaoGetTolerances(almmSolver, &gatol, nullptr, nullptr));
     PetscCall(TaoGetConstraintTolerances(almmSolver, &catol, nullptr));
     PetscCall(TaoGetMaximumIterations(almmSolver, &maxIterCount));
 
     // Override mu factor
-    almmOverrideMu(almmSolver, iterNum);
+    // Penalty restored from a checkpoint takes precedence over the configured one
+    almmOverrideMu(
+        almmSolver, iterNum, solver->options_.muFactor,
+        solver->resumedMu_.has_value() ? solver->resumedMu_ : solver->options_.initialMu);
 
     // Do custom convergence checks
     TaoConvergedReason reason = TAO_CONTINUE_ITERATING;
-    if (iterNum >= maxIterCount) {
+    if (iterNum > 0) {
+        // Penalty is disabled on the first iteration, so its solution is usually infeasible and is not a candidate
+        PetscCall(solver->updateBestIterate(f, cnorm, catol));
+    }
+    if (solver->isInterrupted()) {
+        // Distinct reason so that solve() knows that the best iterate should be restored
+        reason = TAO_CONVERGED_USER;
+    } else if (iterNum >= maxIterCount) {
         reason = TAO_DIVERGED_MAXITS;
     } else if (LGradNorm < gatol && cnorm < catol) {
         // It seems weird to check LGradNorm here -- shouldn't BQNLS only stop when gradient norm is < gatol?
@@ -186,10 +173,15 @@ PetscErrorCode monitorALMM(Tao almmSolver, void* ctx)
     }
     std::cerr << padding << "----------\n";
 
+    // Subsolver has just finished its run for this iteration
+    PetscInt nfuncs;
+    PetscCall(TaoGetCurrentFunctionEvaluations(subsolver, &nfuncs));
+    solver->statistics_.almmIterations = iterNum;
+    solver->statistics_.subsolverIterations += subsolver->niter;
+    solver->statistics_.subsolverEvaluations += nfuncs;
+
     if (iterNum != 0) {
         // Print subsolver's info
-        PetscInt nfuncs;
-        PetscCall(TaoGetCurrentFunctionEvaluations(subsolver, &nfuncs));
         std::cerr << padding << "subsolver's iter count: " << subsolver->niter << ", nfuncs: " << nfuncs
                   << ", converged reason " << TaoConvergedReasons[subsolverReason] << "\n";
         if (subsolver->reason < 0) {
@@ -217,8 +209,8 @@ PetscErrorCode monitorALMM(Tao almmSolver, void* ctx)
         const double* cEq;
         PetscCall(VecGetArrayRead(solver->cEq_, &cEq));
 
-        const PetscInt* rowIndexes = solver->JEqRowIndexes_.data();
-        const PetscInt* colIndexes = solver->JEqColIndexes_.data();
+        const PetscInt* rowIndexes = solver->JEqRowIndexes_;
+        const PetscInt* colIndexes = solver->JEqColIndexes_;
         assert(rowIndexes && "Null row indicies");
         assert(colIndexes && "Null col indicies");
         std::vector<double> JEqVal(cEqCnt * varCnt);
@@ -242,6 +234,15 @@ PetscErrorCode monitorSubsolver(Tao subsolver, void* ctx)
     AnalyticalSolver* solver = reinterpret_cast<AnalyticalSolver*>(ctx);
     const size_t varCnt = solver->varCnt_;
 
+    // Stop the subsolver right away, ALMM convergence test will then terminate the whole solve
+    if (solver->isInterrupted()) {
+        PetscCall(TaoSetConvergedReason(subsolver, TAO_CONVERGED_USER));
+        PetscFunctionReturn(PETSC_SUCCESS);
+    }
+    if (!solver->verboseSubsolverMonitor_) {
+        PetscFunctionReturn(PETSC_SUCCESS);
+    }
+
     // Get solving status
     PetscInt iterNum;
     PetscReal f, gnorm, xdiff;
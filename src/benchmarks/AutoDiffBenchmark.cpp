@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <callbacks/AutoDiffTerms.h>
+#include <callbacks/CorridorLength.h>
+#include <callbacks/PushForce.h>
+#include <test-utils/TestUtils.h>
+#include <utils/Random.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+constexpr size_t kDefaultRoomCount = 1000;
+constexpr double kMinMeasureSeconds = 1.0;
+constexpr double kScale = 2.5;
+constexpr double kRange = 1.5;
+
+/// Returns evaluations per second
+template <typename Evaluate>
+double measure(Evaluate&& evaluate)
+{
+    size_t evaluationCount = 0;
+    const auto begin = TestUtils::Clock::now();
+    double elapsedSeconds = 0.0;
+    while (elapsedSeconds < kMinMeasureSeconds) {
+        evaluate();
+        evaluationCount++;
+        elapsedSeconds = TestUtils::secondsSince(begin);
+    }
+    return evaluationCount / elapsedSeconds;
+}
+
+void compare(
+    const std::string& name, size_t termCount, const Callbacks::FGEval& handWritten, const Callbacks::FGEval& autoDiff,
+    const std::vector<double>& x)
+{
+    double f = 0.0;
+    std::vector<double> grad(x.size());
+    const double handWrittenRate = measure([&]() {
+        handWritten(x.data(), f, grad.data());
+    });
+    const double autoDiffRate = measure([&]() {
+        autoDiff(x.data(), f, grad.data());
+    });
+    std::cout << name << ", value and gradient: hand-written " << handWrittenRate * termCount / 1e6
+              << "M terms/s, AD " << autoDiffRate * termCount / 1e6 << "M terms/s (" << autoDiffRate / handWrittenRate
+              << "x)\n";
+    // Keep the results alive
+    std::cout << "checksum: " << f + grad[0] << "\n";
+}
+
+}  // namespace
+
+/// Compares throughput of the hand-written cost kernels with the same terms differentiated by AutoDiff:
+/// `autodiff_benchmark [room count]`
+int main(int argc, char* argv[])
+{
+    const size_t roomCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultRoomCount);
+
+    // Rooms connected into a chain by movable doors
+    Random::RNG rng(Random::kGlobalSeed);
+    const Model::Model model = TestUtils::createRandomModel(
+        roomCount, TestUtils::Connectivity::Chain, TestUtils::DoorKinds::Movable, rng);
+    const std::vector<double> x = TestUtils::createRandomVariables(model, 500.0, 500.0, rng);
+
+    // PushForce skips rooms connected by a corridor, i.e. neighbours in the chain
+    std::vector<Callbacks::AutoDiffTerms::PushForceTerm> pushTerms;
+    for (size_t i = 0; i < roomCount; ++i) {
+        for (size_t j = i + 2; j < roomCount; ++j) {
+            pushTerms.push_back(
+                Callbacks::AutoDiffTerms::PushForceTerm::create(model.rooms()[i], model.rooms()[j], kScale, kRange));
+        }
+    }
+    const size_t pairCount = pushTerms.size();
+    const Callbacks::PushForce pushForce(model, kScale, kRange);
+    const Callbacks::AutoDiffCost<Callbacks::AutoDiffTerms::PushForceTerm> pushForceAD(std::move(pushTerms));
+
+    std::vector<Callbacks::AutoDiffTerms::CorridorLengthTerm> corridorTerms;
+    for (const Model::Corridor& corridor : model.corridors()) {
+        corridorTerms.push_back(Callbacks::AutoDiffTerms::CorridorLengthTerm::create(
+            model.doors()[corridor.door1Id], model.doors()[corridor.door2Id]));
+    }
+    const Callbacks::CorridorLength corridorLength(model);
+    const Callbacks::AutoDiffCost<Callbacks::AutoDiffTerms::CorridorLengthTerm> corridorLengthAD(
+        std::move(corridorTerms));
+
+#if defined(__AVX2__)
+    std::cout << "AutoDiff benchmark (hand-written kernels with AVX2), " << roomCount << " rooms\n";
+#else
+    std::cout << "AutoDiff benchmark (scalar), " << roomCount << " rooms\n";
+#endif
+    compare("PushForce", pairCount, pushForce, pushForceAD, x);
+    compare("CorridorLength", model.corridors().size(), corridorLength, corridorLengthAD, x);
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+#include <model/CorridorRouter.h>
+#include <test-utils/TestUtils.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+using TestUtils::Clock;
+using TestUtils::secondsSince;
+
+constexpr size_t kDefaultRoomCount = 10000;
+
+}  // namespace
+
+/// Measures how long it takes to route all corridors of a layout: `corridor_routing_benchmark [room count]
+/// [clearance]`. All routes are checked against the rooms; clearances above 2 make gaps between some rooms narrower
+/// than two clearances.
+int main(int argc, char* argv[])
+{
+    const size_t roomCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultRoomCount);
+    Model::RoutingOptions options;
+    options.clearance = (argc > 2 ? std::stod(argv[2]) : options.clearance);
+    const Model::Model model = TestUtils::createGridLayout(roomCount, true);
+
+    const auto graphBegin = Clock::now();
+    const Model::CorridorRouter router(model, options);
+    std::cout << "Graph: " << secondsSince(graphBegin) * 1e3 << " ms, " << router.getVertexCount() << " vertices\n";
+
+    const auto routeBegin = Clock::now();
+    const Model::CorridorRoutes routes = router.routeAll();
+    const double routeSeconds = secondsSince(routeBegin);
+
+    size_t failedCount = 0;
+    size_t bendCount = 0;
+    for (const Model::CorridorRoute& route : routes) {
+        failedCount += route.empty();
+        bendCount += route.size() > 2 ? route.size() - 2 : 0;
+    }
+    const size_t invalidCount = TestUtils::countInvalidRoutes(model, routes);
+    std::cout << "Routes: " << routes.size() << " corridors in " << routeSeconds * 1e3 << " ms, " << failedCount
+              << " failed, " << static_cast<double>(bendCount) / std::max<size_t>(routes.size(), 1)
+              << " bends per route, " << invalidCount << " invalid\n";
+    return invalidCount == 0 ? 0 : 1;
+}
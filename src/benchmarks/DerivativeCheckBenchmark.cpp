@@ -0,0 +1,80 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <callbacks/CorridorLength.h>
+#include <callbacks/DerivativeCheck.h>
+#include <callbacks/PushForce.h>
+#include <test-utils/TestUtils.h>
+#include <utils/Random.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+using TestUtils::Clock;
+using TestUtils::secondsSince;
+
+constexpr size_t kDefaultRoomCount = 5000;
+constexpr size_t kFuzzRoundCount = 4;  // Each round checks the callbacks at a new random point
+
+void fuzz(
+    const std::string& name, const Callbacks::FGEval& function, size_t variablesCount,
+    Callbacks::DerivativeCheck::Options options, Random::RNG& rng)
+{
+    const double halfSide = std::sqrt(static_cast<double>(variablesCount)) * 10.0;
+    std::vector<double> x(variablesCount);
+
+    // What a check with a forward difference per variable would take
+    for (double& var : x) {
+        var = Random::uniformRangeContinuous(-halfSide, halfSide, rng);
+    }
+    const auto evaluationBegin = Clock::now();
+    double f = 0.0;
+    function(x.data(), f, nullptr);
+    const double perVariableSeconds = secondsSince(evaluationBegin) * (variablesCount + 1);
+
+    Callbacks::DerivativeCheck::Result total;
+    const auto checkBegin = Clock::now();
+    for (size_t roundId = 0; roundId < kFuzzRoundCount; ++roundId) {
+        for (double& var : x) {
+            var = Random::uniformRangeContinuous(-halfSide, halfSide, rng);
+        }
+        options.seed = roundId;
+        const Callbacks::DerivativeCheck::Result result =
+            Callbacks::DerivativeCheck::checkGradient(function, x, options);
+        total.checkedCount += result.checkedCount;
+        total.failedCount += result.failedCount;
+        total.maxError = std::max(total.maxError, result.maxError);
+    }
+    const double checkSeconds = secondsSince(checkBegin) / kFuzzRoundCount;
+    std::cout << name << ": " << total.failedCount << "/" << total.checkedCount << " directions failed, max error "
+              << total.maxError << "; " << checkSeconds << " s per point (per-variable differences: ~"
+              << perVariableSeconds << " s)\n";
+}
+
+}  // namespace
+
+/// Checks gradients of the cost functions at random points of a big model and compares the time with the per-variable
+/// check: `derivative_check_benchmark [room count]`. Build with AVX2 to validate the vectorized kernels.
+int main(int argc, char* argv[])
+{
+    const size_t roomCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultRoomCount);
+    Random::RNG rng(Random::kGlobalSeed);
+    // Rooms with movable doors, connected in a random tree
+    const Model::Model model = TestUtils::createRandomModel(
+        roomCount, TestUtils::Connectivity::RandomTree, TestUtils::DoorKinds::Movable, rng);
+    std::cout << "Derivative check, " << roomCount << " rooms, " << model.getVariablesCount() << " variables\n";
+
+    const Callbacks::CorridorLength corridorLength(model);
+    const Callbacks::PushForce pushForce(model, 2.5, 1.5);
+    const Callbacks::PushForce pushForceMixed(model, 2.5, 1.5, {}, Callbacks::Precision::Mixed);
+    fuzz("CorridorLength", corridorLength, model.getVariablesCount(), {}, rng);
+    fuzz("PushForce", pushForce, model.getVariablesCount(), {}, rng);
+    // Float terms need a bigger step and tolerance
+    fuzz(
+        "PushForce (mixed precision)", pushForceMixed, model.getVariablesCount(),
+        {.step = 1e-2, .absTolerance = 1e-2, .relTolerance = 1e-2}, rng);
+    return 0;
+}
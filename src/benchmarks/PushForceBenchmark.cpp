@@ -0,0 +1,75 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <callbacks/PushForce.h>
+#include <utils/Random.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+constexpr size_t kDefaultRoomCount = 500;
+constexpr double kMinMeasureSeconds = 1.0;
+
+template <typename Evaluate>
+void measure(const std::string& name, size_t pairCount, Evaluate&& evaluate)
+{
+    using Clock = std::chrono::steady_clock;
+
+    size_t evaluationCount = 0;
+    const auto begin = Clock::now();
+    double elapsedSeconds = 0.0;
+    while (elapsedSeconds < kMinMeasureSeconds) {
+        evaluate();
+        evaluationCount++;
+        elapsedSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    }
+    const double pairsPerSecond = static_cast<double>(pairCount) * evaluationCount / elapsedSeconds;
+    std::cout << name << ": " << evaluationCount << " evaluations, " << pairsPerSecond / 1e6 << "M pairs/s\n";
+}
+
+}  // namespace
+
+/// Measures PushForce throughput on a model with random rooms: `push_force_benchmark [room count]`
+int main(int argc, char* argv[])
+{
+    const size_t roomCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultRoomCount);
+    const size_t pairCount = roomCount * (roomCount - 1) / 2;
+
+    Random::RNG rng(Random::kGlobalSeed);
+    Model::Rooms rooms;
+    rooms.reserve(roomCount);
+    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
+        rooms.emplace_back(
+            roomId, Random::uniformRangeContinuous(5.0, 30.0, rng), Random::uniformRangeContinuous(5.0, 30.0, rng));
+    }
+    std::vector<double> x(2 * roomCount);
+    for (double& var : x) {
+        var = Random::uniformRangeContinuous(-500.0, 500.0, rng);
+    }
+    const Model::Model model(std::move(rooms), {}, {});
+    const Callbacks::PushForce pushForce(model);
+    const Callbacks::PushForce pushForceMixed(model, 1.0, 1.0, {}, Callbacks::Precision::Mixed);
+
+    std::cout << "PushForce benchmark (" << (Callbacks::PushForce::isVectorized() ? "AVX2" : "scalar") << "), "
+              << roomCount << " rooms, " << pairCount << " pairs\n";
+    double f = 0.0;
+    std::vector<double> grad(x.size());
+    measure("value", pairCount, [&]() {
+        pushForce(x.data(), f, nullptr);
+    });
+    measure("value and gradient", pairCount, [&]() {
+        pushForce(x.data(), f, grad.data());
+    });
+    measure("value (mixed precision)", pairCount, [&]() {
+        pushForceMixed(x.data(), f, nullptr);
+    });
+    measure("value and gradient (mixed precision)", pairCount, [&]() {
+        pushForceMixed(x.data(), f, grad.data());
+    });
+    // Keep the results alive
+    std::cout << "checksum: " << f + grad[0] << "\n";
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include <array>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <DungeonGenerator.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+constexpr std::array<std::pair<DungeonType, const char*>, 4> kDungeonTypes{{
+    {DungeonType::Grid, "Grid"},
+    {DungeonType::CenterDoors, "CenterDoors"},
+    {DungeonType::TreeFixedDoors, "TreeFixedDoors"},
+    {DungeonType::MovableDoors, "MovableDoors"},
+}};
+
+}  // namespace
+
+/// Compares solver iteration counts with and without preconditioning (see Normalization.h) on every dungeon type
+int main()
+{
+    const DungeonGenerator dungeonGenerator;
+    std::cout << "type, normalized, ALMM iterations, subsolver iterations, subsolver evaluations\n";
+    for (const auto& [dungeonType, typeName] : kDungeonTypes) {
+        for (const bool normalizeCoordinates : {false, true}) {
+            GenerationConfig config = DungeonGenerator::getDefaultConfig();
+            config.dungeonType = dungeonType;
+            config.usePortfolio = false;
+            config.solverParameters.normalizeCoordinates = normalizeCoordinates;
+            AnalyticalSolver::SolveStatistics statistics;
+            dungeonGenerator.generateDungeon(config, &statistics);
+            std::cout << typeName << ", " << normalizeCoordinates << ", " << statistics.almmIterations << ", "
+                      << statistics.subsolverIterations << ", " << statistics.subsolverEvaluations << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <DungeonGenerator.h>
+#include <WorkerPool.h>
+#include <test-utils/TestUtils.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+using TestUtils::Clock;
+using TestUtils::secondsSince;
+
+constexpr size_t kDefaultDungeonCount = 8;
+constexpr size_t kWorkerCount = 2;
+
+}  // namespace
+
+/// Measures the startup cost (PETSc initialization) and per-dungeon solver setup time with fresh and reused solver
+/// buffers: `solver_setup_benchmark [dungeon count]`
+int main(int argc, char* argv[])
+{
+    const size_t dungeonCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultDungeonCount);
+
+    const auto startupBegin = Clock::now();
+    const DungeonGenerator dungeonGenerator;
+    std::cout << "Startup: " << secondsSince(startupBegin) << " s\n";
+
+    GenerationConfig config = DungeonGenerator::getDefaultConfig();
+    config.usePortfolio = false;
+
+    // Each solver allocates its own buffers
+    double freshSetupSeconds = 0.0;
+    for (size_t dungeonId = 0; dungeonId < dungeonCount; ++dungeonId) {
+        config.seed = dungeonId;
+        AnalyticalSolver::SolveStatistics statistics;
+        dungeonGenerator.generateDungeon(config, &statistics);
+        freshSetupSeconds += statistics.setupSeconds;
+    }
+    std::cout << "Setup per dungeon, fresh buffers: " << freshSetupSeconds / dungeonCount << " s\n";
+
+    // Workers reuse their buffers
+    WorkerPool workerPool(dungeonGenerator, kWorkerCount, config.roomCount);
+    std::vector<std::future<GenerationResult>> results;
+    const auto poolBegin = Clock::now();
+    for (size_t dungeonId = 0; dungeonId < dungeonCount; ++dungeonId) {
+        config.seed = dungeonId;
+        results.push_back(workerPool.submit(config));
+    }
+    double reusedSetupSeconds = 0.0;
+    for (std::future<GenerationResult>& result : results) {
+        reusedSetupSeconds += result.get().statistics.setupSeconds;
+    }
+    const double poolSeconds = secondsSince(poolBegin);
+    std::cout << "Setup per dungeon, reused buffers: " << reusedSetupSeconds / dungeonCount << " s\n";
+    std::cout << "Worker pool (" << kWorkerCount << " workers): " << dungeonCount / poolSeconds << " dungeons/s\n";
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <model/TiledRenderer.h>
+#include <test-utils/TestUtils.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+using TestUtils::Clock;
+using TestUtils::secondsSince;
+
+constexpr size_t kDefaultRoomCount = 100000;
+
+}  // namespace
+
+/// Measures how long it takes to render a huge layout into tiles and to render a single tile on demand:
+/// `tiled_render_benchmark [room count] [output directory]`
+int main(int argc, char* argv[])
+{
+    const size_t roomCount = (argc > 1 ? std::stoul(argv[1]) : kDefaultRoomCount);
+    const std::filesystem::path outputDirectory =
+        (argc > 2 ? std::filesystem::path(argv[2])
+                  : std::filesystem::temp_directory_path() / "dungeon_generation_tiles");
+
+    const Model::Model model = TestUtils::createGridLayout(roomCount, false);
+
+    const auto indexBegin = Clock::now();
+    const Model::TiledRenderer renderer(model);
+    std::cout << "Index: " << secondsSince(indexBegin) << " s, max zoom " << renderer.getMaxZoom() << "\n";
+
+    // Tiles that a viewer requests first: the whole layout and the deepest tile in the middle of it
+    for (const size_t zoom : {size_t(0), renderer.getMaxZoom()}) {
+        const size_t tile = (size_t(1) << zoom) / 2;
+        std::stringstream sstream;
+        const auto tileBegin = Clock::now();
+        renderer.renderTile(zoom, tile, tile, sstream);
+        std::cout << "Tile " << zoom << "/" << tile << "/" << tile << ": " << secondsSince(tileBegin) * 1e3 << " ms, "
+                  << sstream.str().size() / 1024 << " KiB\n";
+    }
+
+    const auto renderBegin = Clock::now();
+    const size_t tileCount = renderer.render(outputDirectory);
+    std::cout << "All tiles: " << tileCount << " tiles in " << secondsSince(renderBegin) << " s, written to "
+              << outputDirectory << "\n";
+    return 0;
+}
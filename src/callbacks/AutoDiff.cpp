@@ -0,0 +1,34 @@
+#include "AutoDiff.h"
+
+#include <cassert>
+
+#include <petsc.h>
+
+namespace DungeonGeneration {
+namespace Callbacks {
+namespace AutoDiff {
+
+namespace {
+
+constexpr size_t kMaxRowSize = 32;
+
+}  // namespace
+
+void addJacobianRow(void* JEqPtr, int cEqId, const size_t* variableIds, const double* derivatives, size_t count)
+{
+    assert(count <= kMaxRowSize && "AutoDiff::addJacobianRow: too many variables in a term");
+    // Fixed-size buffer: this is called for every penalty term on each evaluation
+    std::array<PetscInt, kMaxRowSize> colIndexes;
+    for (size_t i = 0; i < count; ++i) {
+        colIndexes[i] = static_cast<PetscInt>(variableIds[i]);
+    }
+    const PetscInt rowIndex = cEqId;
+    const bool JEqUpdated = MatSetValues(
+                                reinterpret_cast<Mat>(JEqPtr), 1, &rowIndex, static_cast<PetscInt>(count),
+                                colIndexes.data(), derivatives, ADD_VALUES) == PETSC_SUCCESS;
+    assert(JEqUpdated && "AutoDiff::addJacobianRow: failed to update JEq values");
+}
+
+}  // namespace AutoDiff
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
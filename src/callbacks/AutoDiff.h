@@ -0,0 +1,434 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Forward-mode automatic differentiation for cost and penalty terms. A term is written once as a template over the
+/// number type and evaluated on doubles for values, or on Dual numbers for values with gradients. A term depends on a
+/// few variables, so duals carry a fixed-size gradient on the stack: with all loops of compile-time length, the
+/// compiler fuses value and gradient into one kernel, with no tape or allocations.
+///
+/// A term is a struct with
+///     static constexpr size_t kVariableCount;
+///     std::array<size_t, kVariableCount> variableIds;  // Ids of the variables it reads, in the x array
+///     template <typename Real> Real evaluate(const std::array<Real, kVariableCount>& vars) const;
+/// Use the math functions from this namespace in `evaluate`, they are overloaded for both number types.
+namespace AutoDiff {
+
+template <size_t N>
+struct Dual {
+    double value = 0.0;
+    std::array<double, N> derivatives{};
+
+    Dual() = default;
+    /// Constants convert implicitly, so that they can be mixed with duals
+    Dual(double constant)
+          : value(constant)
+    {}
+
+    /// Seed for the variable with local id `varId`
+    static Dual variable(double value, size_t varId)
+    {
+        Dual result(value);
+        result.derivatives[varId] = 1.0;
+        return result;
+    }
+};
+
+/// Result of f(a) with f'(a) = `derivative`
+template <size_t N>
+Dual<N> chain(const Dual<N>& a, double value, double derivative)
+{
+    Dual<N> result(value);
+    for (size_t i = 0; i < N; ++i) {
+        result.derivatives[i] = derivative * a.derivatives[i];
+    }
+    return result;
+}
+
+template <size_t N>
+Dual<N> operator-(const Dual<N>& a)
+{
+    return chain(a, -a.value, -1.0);
+}
+
+template <size_t N>
+Dual<N> operator+(const Dual<N>& a, const Dual<N>& b)
+{
+    Dual<N> result(a.value + b.value);
+    for (size_t i = 0; i < N; ++i) {
+        result.derivatives[i] = a.derivatives[i] + b.derivatives[i];
+    }
+    return result;
+}
+
+template <size_t N>
+Dual<N> operator-(const Dual<N>& a, const Dual<N>& b)
+{
+    Dual<N> result(a.value - b.value);
+    for (size_t i = 0; i < N; ++i) {
+        result.derivatives[i] = a.derivatives[i] - b.derivatives[i];
+    }
+    return result;
+}
+
+template <size_t N>
+Dual<N> operator*(const Dual<N>& a, const Dual<N>& b)
+{
+    Dual<N> result(a.value * b.value);
+    for (size_t i = 0; i < N; ++i) {
+        result.derivatives[i] = a.derivatives[i] * b.value + a.value * b.derivatives[i];
+    }
+    return result;
+}
+
+template <size_t N>
+Dual<N> operator/(const Dual<N>& a, const Dual<N>& b)
+{
+    const double invB = 1.0 / b.value;
+    Dual<N> result(a.value * invB);
+    for (size_t i = 0; i < N; ++i) {
+        result.derivatives[i] = (a.derivatives[i] - result.value * b.derivatives[i]) * invB;
+    }
+    return result;
+}
+
+// Operations with constants don't touch the constant's (zero) derivatives
+
+template <size_t N>
+Dual<N> operator+(const Dual<N>& a, double b)
+{
+    Dual<N> result = a;
+    result.value += b;
+    return result;
+}
+
+template <size_t N>
+Dual<N> operator+(double a, const Dual<N>& b)
+{
+    return b + a;
+}
+
+template <size_t N>
+Dual<N> operator-(const Dual<N>& a, double b)
+{
+    return a + (-b);
+}
+
+template <size_t N>
+Dual<N> operator-(double a, const Dual<N>& b)
+{
+    return -b + a;
+}
+
+template <size_t N>
+Dual<N> operator*(const Dual<N>& a, double b)
+{
+    return chain(a, a.value * b, b);
+}
+
+template <size_t N>
+Dual<N> operator*(double a, const Dual<N>& b)
+{
+    return b * a;
+}
+
+template <size_t N>
+Dual<N> operator/(const Dual<N>& a, double b)
+{
+    return a * (1.0 / b);
+}
+
+template <size_t N>
+Dual<N> operator/(double a, const Dual<N>& b)
+{
+    const double invB = 1.0 / b.value;
+    const double value = a * invB;
+    return chain(b, value, -value * invB);
+}
+
+template <size_t N>
+Dual<N>& operator+=(Dual<N>& a, const Dual<N>& b)
+{
+    return a = a + b;
+}
+
+template <size_t N>
+Dual<N>& operator-=(Dual<N>& a, const Dual<N>& b)
+{
+    return a = a - b;
+}
+
+template <size_t N>
+Dual<N>& operator*=(Dual<N>& a, const Dual<N>& b)
+{
+    return a = a * b;
+}
+
+// Comparisons use values only, for branches in terms
+
+template <size_t N>
+bool operator<(const Dual<N>& a, const Dual<N>& b)
+{
+    return a.value < b.value;
+}
+
+template <size_t N>
+bool operator>(const Dual<N>& a, const Dual<N>& b)
+{
+    return a.value > b.value;
+}
+
+template <size_t N>
+bool operator<=(const Dual<N>& a, const Dual<N>& b)
+{
+    return a.value <= b.value;
+}
+
+template <size_t N>
+bool operator>=(const Dual<N>& a, const Dual<N>& b)
+{
+    return a.value >= b.value;
+}
+
+template <size_t N>
+bool operator<(const Dual<N>& a, double b)
+{
+    return a.value < b;
+}
+
+template <size_t N>
+bool operator<(double a, const Dual<N>& b)
+{
+    return a < b.value;
+}
+
+template <size_t N>
+bool operator>(const Dual<N>& a, double b)
+{
+    return a.value > b;
+}
+
+template <size_t N>
+bool operator>(double a, const Dual<N>& b)
+{
+    return a > b.value;
+}
+
+template <size_t N>
+bool operator<=(const Dual<N>& a, double b)
+{
+    return a.value <= b;
+}
+
+template <size_t N>
+bool operator<=(double a, const Dual<N>& b)
+{
+    return a <= b.value;
+}
+
+template <size_t N>
+bool operator>=(const Dual<N>& a, double b)
+{
+    return a.value >= b;
+}
+
+template <size_t N>
+bool operator>=(double a, const Dual<N>& b)
+{
+    return a >= b.value;
+}
+
+// Math functions for both number types
+
+inline double value(double a)
+{
+    return a;
+}
+
+template <size_t N>
+double value(const Dual<N>& a)
+{
+    return a.value;
+}
+
+inline double square(double a)
+{
+    return a * a;
+}
+
+template <size_t N>
+Dual<N> square(const Dual<N>& a)
+{
+    return chain(a, a.value * a.value, 2.0 * a.value);
+}
+
+inline double sqrt(double a)
+{
+    return std::sqrt(a);
+}
+
+template <size_t N>
+Dual<N> sqrt(const Dual<N>& a)
+{
+    const double value = std::sqrt(a.value);
+    return chain(a, value, 0.5 / value);
+}
+
+inline double exp(double a)
+{
+    return std::exp(a);
+}
+
+template <size_t N>
+Dual<N> exp(const Dual<N>& a)
+{
+    const double value = std::exp(a.value);
+    return chain(a, value, value);
+}
+
+inline double log(double a)
+{
+    return std::log(a);
+}
+
+template <size_t N>
+Dual<N> log(const Dual<N>& a)
+{
+    return chain(a, std::log(a.value), 1.0 / a.value);
+}
+
+/// Derivative at 0 is taken as 0
+inline double abs(double a)
+{
+    return std::abs(a);
+}
+
+template <size_t N>
+Dual<N> abs(const Dual<N>& a)
+{
+    return chain(a, std::abs(a.value), a.value > 0 ? 1.0 : (a.value < 0 ? -1.0 : 0.0));
+}
+
+template <typename Real>
+Real min(const Real& a, const Real& b)
+{
+    return (b < a ? b : a);
+}
+
+template <typename Real>
+Real max(const Real& a, const Real& b)
+{
+    return (a < b ? b : a);
+}
+
+/// Duals of the term's variables. Fields are written one by one: seeding through temporaries makes the compiler spill
+/// them to the stack and reload in wider chunks, which stalls on store forwarding.
+template <typename Term>
+void seedVariables(
+    const Term& term, const double* x, std::array<Dual<Term::kVariableCount>, Term::kVariableCount>& vars)
+{
+    for (size_t i = 0; i < Term::kVariableCount; ++i) {
+        vars[i].value = x[term.variableIds[i]];
+        vars[i].derivatives[i] = 1.0;
+    }
+}
+
+/// Value of `term` at `x`; the gradient is added to `grad` if it's not null
+template <typename Term>
+double evaluateTerm(const Term& term, const double* x, double* grad)
+{
+    constexpr size_t N = Term::kVariableCount;
+    if (grad == nullptr) {
+        std::array<double, N> vars;
+        for (size_t i = 0; i < N; ++i) {
+            vars[i] = x[term.variableIds[i]];
+        }
+        return term.template evaluate<double>(vars);
+    }
+
+    std::array<Dual<N>, N> vars;
+    seedVariables(term, x, vars);
+    const Dual<N> result = term.template evaluate<Dual<N>>(vars);
+    // Variable ids may repeat, so the derivatives are accumulated
+    for (size_t i = 0; i < N; ++i) {
+        grad[term.variableIds[i]] += result.derivatives[i];
+    }
+    return result.value;
+}
+
+/// Adds a row of partial derivatives to the penalty Jacobian, `JEqPtr` is a PETSc Mat
+void addJacobianRow(void* JEqPtr, int cEqId, const size_t* variableIds, const double* derivatives, size_t count);
+
+}  // namespace AutoDiff
+
+/// Cost function (FGEval) that is a sum of terms
+template <typename Term>
+class AutoDiffCost {
+public:
+    explicit AutoDiffCost(std::vector<Term>&& terms)
+          : terms_(std::move(terms))
+    {}
+
+    void operator()(const double* x, double& f, double* grad) const
+    {
+        // Separate loops, so that the gradient check isn't done per term
+        double fSum = 0.0;
+        if (grad != nullptr) {
+            for (const Term& term : terms_) {
+                fSum += AutoDiff::evaluateTerm(term, x, grad);
+            }
+        } else {
+            for (const Term& term : terms_) {
+                fSum += AutoDiff::evaluateTerm(term, x, nullptr);
+            }
+        }
+        f += fSum;
+    }
+
+    size_t getTermCount() const
+    {
+        return terms_.size();
+    }
+
+private:
+    std::vector<Term> terms_;
+};
+
+/// Penalty function (CEqFGEval) of a single term. The Jacobian row is always written, even if it's zero: solver
+/// expects the Jacobian sparsity to be fixed.
+template <typename Term>
+class AutoDiffPenalty {
+public:
+    explicit AutoDiffPenalty(const Term& term)
+          : term_(term)
+    {}
+
+    void operator()(const double* x, double& f, void* JEqPtr, int cEqId) const
+    {
+        constexpr size_t N = Term::kVariableCount;
+        if (JEqPtr == nullptr) {
+            f += AutoDiff::evaluateTerm(term_, x, nullptr);
+            return;
+        }
+        std::array<AutoDiff::Dual<N>, N> vars;
+        AutoDiff::seedVariables(term_, x, vars);
+        const AutoDiff::Dual<N> result = term_.template evaluate<AutoDiff::Dual<N>>(vars);
+        f += result.value;
+        AutoDiff::addJacobianRow(JEqPtr, cEqId, term_.variableIds.data(), result.derivatives.data(), N);
+    }
+
+private:
+    Term term_;
+};
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
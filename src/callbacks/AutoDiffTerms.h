@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include <model/Door.h>
+#include <model/Room.h>
+
+#include "AutoDiff.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Terms of the hand-written callbacks, expressed for AutoDiff. They are references for the AD kernels (tests,
+/// autodiff_benchmark) and examples for new terms: compare them with the derivations in PushForce.cpp,
+/// CorridorLength.cpp and RoomOverlap.cpp.
+namespace AutoDiffTerms {
+
+/// A pair of rooms in PushForce
+struct PushForceTerm {
+    static constexpr size_t kVariableCount = 4;
+    std::array<size_t, kVariableCount> variableIds;
+    double invScaledHW;  // 1 / (range * sumHalfWidth)
+    double invScaledHH;  // 1 / (range * sumHalfHeight)
+    double scale;
+
+    static PushForceTerm create(const Model::Room& room1, const Model::Room& room2, double scale, double range)
+    {
+        const auto [x1Id, y1Id] = room1.getVariablesIds();
+        const auto [x2Id, y2Id] = room2.getVariablesIds();
+        return PushForceTerm{
+            .variableIds = {x1Id, y1Id, x2Id, y2Id},
+            .invScaledHW = 2.0 / (range * (room1.width() + room2.width())),
+            .invScaledHH = 2.0 / (range * (room1.height() + room2.height())),
+            .scale = scale};
+    }
+
+    template <typename Real>
+    Real evaluate(const std::array<Real, kVariableCount>& vars) const
+    {
+        const Real xRatio = (vars[0] - vars[2]) * invScaledHW;
+        const Real yRatio = (vars[1] - vars[3]) * invScaledHH;
+        return scale / (AutoDiff::square(xRatio) + AutoDiff::square(yRatio) + 1.0);
+    }
+};
+
+/// A corridor between two movable doors in CorridorLength
+struct CorridorLengthTerm {
+    static constexpr size_t kVariableCount = 8;
+    std::array<size_t, kVariableCount> variableIds;  // Room 1, door 1, room 2, door 2
+
+    static CorridorLengthTerm create(const Model::Door& door1, const Model::Door& door2)
+    {
+        const auto [room1XId, room1YId] = Model::VarUtils::getVariablesIds(door1.parentRoomId());
+        const auto [room2XId, room2YId] = Model::VarUtils::getVariablesIds(door2.parentRoomId());
+        const auto [door1XId, door1YId] = door1.getVariablesIds();
+        const auto [door2XId, door2YId] = door2.getVariablesIds();
+        return CorridorLengthTerm{
+            .variableIds = {room1XId, room1YId, door1XId, door1YId, room2XId, room2YId, door2XId, door2YId}};
+    }
+
+    template <typename Real>
+    Real evaluate(const std::array<Real, kVariableCount>& vars) const
+    {
+        const Real dx = vars[0] + vars[2] - vars[4] - vars[6];
+        const Real dy = vars[1] + vars[3] - vars[5] - vars[7];
+        return AutoDiff::square(dx) + AutoDiff::square(dy);
+    }
+};
+
+/// RoomOverlap of a pair of rooms
+struct RoomOverlapTerm {
+    static constexpr size_t kVariableCount = 4;
+    std::array<size_t, kVariableCount> variableIds;
+    double sumHalfWidth;
+    double sumHalfHeight;
+
+    static RoomOverlapTerm create(const Model::Room& room1, const Model::Room& room2, double roomBloating = 1.0)
+    {
+        const auto [x1Id, y1Id] = room1.getVariablesIds();
+        const auto [x2Id, y2Id] = room2.getVariablesIds();
+        return RoomOverlapTerm{
+            .variableIds = {x1Id, y1Id, x2Id, y2Id},
+            .sumHalfWidth = roomBloating * (room1.width() + room2.width()) / 2,
+            .sumHalfHeight = roomBloating * (room1.height() + room2.height()) / 2};
+    }
+
+    template <typename Real>
+    Real evaluate(const std::array<Real, kVariableCount>& vars) const
+    {
+        const Real dx = vars[0] - vars[2];
+        const Real dy = vars[1] - vars[3];
+        if (AutoDiff::abs(dx) >= sumHalfWidth || AutoDiff::abs(dy) >= sumHalfHeight) {
+            return Real(0.0);
+        }
+        const Real fx = AutoDiff::square(dx / sumHalfWidth) - 1.0;
+        const Real fy = AutoDiff::square(dy / sumHalfHeight) - 1.0;
+        return AutoDiff::square(fx) * AutoDiff::square(fy);
+    }
+};
+
+}  // namespace AutoDiffTerms
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -0,0 +1,320 @@
+#include "CorridorCrossing.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+#include <model/Variables.h>
+#include <utils/GridIndex.h>
+
+#include "AutoDiff.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+namespace {
+
+// Shorter corridors are ignored: the penalty is normalized by their lengths
+constexpr double kMinSquaredLength = 1e-6;
+
+Spatial::Box getSegmentBox(Model::Position a, Model::Position b, double margin)
+{
+    return Spatial::Box{
+        .minX = std::min(a.x, b.x) - margin,
+        .minY = std::min(a.y, b.y) - margin,
+        .maxX = std::max(a.x, b.x) + margin,
+        .maxY = std::max(a.y, b.y) + margin};
+}
+
+/// Most candidates are apart. Both penalties have zero gradients where they are zero, so the gradient is computed only
+/// for nonzero values, which are much cheaper to find.
+template <typename Term>
+double evaluateCandidate(const Term& term, const double* x, double* grad)
+{
+    const double value = AutoDiff::evaluateTerm(term, x, nullptr);
+    if (value == 0.0 || grad == nullptr) {
+        return value;
+    }
+    return AutoDiff::evaluateTerm(term, x, grad);
+}
+
+void expandBox(Spatial::Box& box, const Spatial::Box& other)
+{
+    box.minX = std::min(box.minX, other.minX);
+    box.minY = std::min(box.minY, other.minY);
+    box.maxX = std::max(box.maxX, other.maxX);
+    box.maxY = std::max(box.maxY, other.maxY);
+}
+
+}  // namespace
+
+CorridorCrossing::CorridorCrossing(
+    const Model::Model& model, double scale, double margin, std::pmr::memory_resource* resource)
+      : scale_(scale),
+        margin_(margin),
+        corridors_(resource),
+        roomVars_(resource),
+        roomHalfSizes_(resource),
+        corridorPairs_(resource),
+        corridorRoomPairs_(resource)
+{
+    assert(margin >= 0 && "CorridorCrossing: margin must be non-negative");
+    const Model::Rooms& rooms = model.rooms();
+    roomVars_.reserve(rooms.size());
+    roomHalfSizes_.reserve(rooms.size());
+    for (const Model::Room& room : rooms) {
+        roomVars_.push_back(room.getVariablesIds());
+        roomHalfSizes_.push_back(Model::Position{.x = room.width() / 2, .y = room.height() / 2});
+        averageRoomSize_ += std::max(room.width(), room.height()) / static_cast<double>(rooms.size());
+    }
+
+    const Model::Doors& doors = model.doors();
+    corridors_.reserve(model.corridors().size());
+    for (const Model::Corridor& corridor : model.corridors()) {
+        CorridorEntry entry;
+        const std::array<size_t, 2> doorIds{corridor.door1Id, corridor.door2Id};
+        for (size_t endId = 0; endId < 2; ++endId) {
+            const Model::Door& door = doors[doorIds[endId]];
+            CorridorEnd& end = entry.ends[endId];
+            end.roomVars = Model::VarUtils::getVariablesIds(door.parentRoomId());
+            if (door.isMovable()) {
+                end.doorVars = door.getVariablesIds();
+                end.doorWeight = 1.0;
+                end.shift = {0.0, 0.0};
+            } else {
+                end.doorVars = end.roomVars;
+                end.doorWeight = 0.0;
+                end.shift = door.shift();
+            }
+            entry.roomIds[endId] = door.parentRoomId();
+        }
+        corridors_.push_back(entry);
+    }
+}
+
+void CorridorCrossing::operator()(const double* x, double& f, double* grad) const
+{
+    double fSum = 0.0;
+    for (const auto& [corridorId1, corridorId2] : corridorPairs_) {
+        fSum += evaluateCandidate(createCorridorPairTerm(corridorId1, corridorId2), x, grad);
+    }
+    for (const auto& [corridorId, roomId] : corridorRoomPairs_) {
+        fSum += evaluateCandidate(createCorridorRoomTerm(corridorId, roomId), x, grad);
+    }
+    f += fSum;
+}
+
+void CorridorCrossing::updateCandidates(const double* x)
+{
+    corridorPairs_.clear();
+    corridorRoomPairs_.clear();
+    if (corridors_.empty()) {
+        return;
+    }
+
+    // Boxes of corridors and rooms at x
+    std::vector<Spatial::Box> corridorBoxes;
+    corridorBoxes.reserve(corridors_.size());
+    constexpr double kInfinity = std::numeric_limits<double>::infinity();
+    Spatial::Box bounds{.minX = kInfinity, .minY = kInfinity, .maxX = -kInfinity, .maxY = -kInfinity};
+    for (const CorridorEntry& corridor : corridors_) {
+        corridorBoxes.push_back(
+            getSegmentBox(getEndPosition(corridor.ends[0], x), getEndPosition(corridor.ends[1], x), margin_));
+        expandBox(bounds, corridorBoxes.back());
+    }
+    std::vector<Spatial::Box> roomBoxes;
+    roomBoxes.reserve(roomVars_.size());
+    for (size_t roomId = 0; roomId < roomVars_.size(); ++roomId) {
+        const double centerX = x[roomVars_[roomId].xId];
+        const double centerY = x[roomVars_[roomId].yId];
+        const Model::Position halfSize = roomHalfSizes_[roomId];
+        roomBoxes.push_back(Spatial::Box{
+            .minX = centerX - halfSize.x - margin_,
+            .minY = centerY - halfSize.y - margin_,
+            .maxX = centerX + halfSize.x + margin_,
+            .maxY = centerY + halfSize.y + margin_});
+        expandBox(bounds, roomBoxes.back());
+    }
+
+    // A single grid over corridors and rooms, room ids go after corridor ids. Corridors are long compared to rooms,
+    // cells of a room size keep both the number of cells per corridor and the number of objects per cell small.
+    const size_t corridorCount = corridors_.size();
+    Spatial::GridIndex index(bounds, averageRoomSize_ + 2 * margin_);
+    for (size_t corridorId = 0; corridorId < corridorCount; ++corridorId) {
+        index.insert(corridorId, corridorBoxes[corridorId]);
+    }
+    for (size_t roomId = 0; roomId < roomBoxes.size(); ++roomId) {
+        index.insert(corridorCount + roomId, roomBoxes[roomId]);
+    }
+
+    // Pairs come in the grid order, so terms close in space are evaluated together
+    std::vector<std::pair<size_t, size_t>> pairs;
+    index.queryPairs(pairs);
+    for (const auto& [id1, id2] : pairs) {
+        if (id2 < corridorCount) {
+            corridorPairs_.emplace_back(id1, id2);
+        } else if (id1 < corridorCount) {
+            // A corridor always touches its own rooms
+            const size_t roomId = id2 - corridorCount;
+            const CorridorEntry& corridor = corridors_[id1];
+            if (roomId != corridor.roomIds[0] && roomId != corridor.roomIds[1]) {
+                corridorRoomPairs_.emplace_back(id1, roomId);
+            }
+        }
+    }
+}
+
+void CorridorCrossing::operator()(const double* x, int /*runNum*/, int /*iterNum*/)
+{
+    updateCandidates(x);
+}
+
+size_t CorridorCrossing::getCorridorPairCount() const
+{
+    return corridorPairs_.size();
+}
+
+size_t CorridorCrossing::getCorridorRoomPairCount() const
+{
+    return corridorRoomPairs_.size();
+}
+
+template <typename Real>
+Real CorridorCrossing::CorridorPairTerm::evaluate(const std::array<Real, kVariableCount>& vars) const
+{
+    /*
+    Corridors a = a1a2 and b = b1b2 properly cross iff ends of each one lie on different sides of the other one.
+    With cross products
+        sA1 = (a2 - a1) x (b1 - a1), sA2 = (a2 - a1) x (b2 - a1)
+        sB1 = (b2 - b1) x (a1 - b1), sB2 = (b2 - b1) x (a2 - b1)
+    it's sA1 * sA2 < 0 and sB1 * sB2 < 0. Normalized products
+        u = -sA1 * sA2 / (|a|^2 |b|^2) = d(b1, a) * d(b2, a) / |b|^2
+        v = -sB1 * sB2 / (|a|^2 |b|^2) = d(a1, b) * d(a2, b) / |a|^2
+    are scale-invariant and at most 1/4 (corridors bisecting each other), so
+        f = scale * (16 * u * v)^2, if u > 0 and v > 0
+    is in [0, scale] and has continuous derivatives at the border of crossing.
+    */
+    std::array<Real, 4> endXs;
+    std::array<Real, 4> endYs;
+    for (size_t endId = 0; endId < 4; ++endId) {
+        endXs[endId] = vars[4 * endId] + doorWeights[endId] * vars[4 * endId + 2] + shifts[endId].x;
+        endYs[endId] = vars[4 * endId + 1] + doorWeights[endId] * vars[4 * endId + 3] + shifts[endId].y;
+    }
+    const Real aX = endXs[1] - endXs[0];
+    const Real aY = endYs[1] - endYs[0];
+    const Real bX = endXs[3] - endXs[2];
+    const Real bY = endYs[3] - endYs[2];
+    const Real squaredLengthA = AutoDiff::square(aX) + AutoDiff::square(aY);
+    const Real squaredLengthB = AutoDiff::square(bX) + AutoDiff::square(bY);
+    if (squaredLengthA < kMinSquaredLength || squaredLengthB < kMinSquaredLength) {
+        return Real(0.0);
+    }
+
+    const Real sA1 = aX * (endYs[2] - endYs[0]) - aY * (endXs[2] - endXs[0]);
+    const Real sA2 = aX * (endYs[3] - endYs[0]) - aY * (endXs[3] - endXs[0]);
+    const Real sB1 = bX * (endYs[0] - endYs[2]) - bY * (endXs[0] - endXs[2]);
+    const Real sB2 = bX * (endYs[1] - endYs[2]) - bY * (endXs[1] - endXs[2]);
+    const Real invNorm = 1.0 / (squaredLengthA * squaredLengthB);
+    const Real u = -sA1 * sA2 * invNorm;
+    const Real v = -sB1 * sB2 * invNorm;
+    if (u <= 0.0 || v <= 0.0) {
+        return Real(0.0);
+    }
+    return scale * AutoDiff::square(16.0 * u * v);
+}
+
+template <typename Real>
+Real CorridorCrossing::CorridorRoomTerm::evaluate(const std::array<Real, kVariableCount>& vars) const
+{
+    /*
+    Corridor p -> q with direction d = q - p against a room with center c. In the frame of the corridor, with
+    e = c - p and L = |d|:
+        distance of the center to the corridor line: (d x e) / L, room half extent along the normal:
+        (halfWidth * |dY| + halfHeight * |dX|) / L
+        position of the center along the corridor: (d . e) / L, room half extent along the corridor:
+        (halfWidth * |dX| + halfHeight * |dY|) / L
+    The corridor passes through the room iff both normalized offsets (normal one relative to the normal extent, the
+    one from the corridor middle relative to L / 2 + tangent extent) are in (-1, 1). L cancels out in both ratios.
+        f = scale * (1 - normalRatio^2)^2 * (1 - tangentRatio^2)^2
+    is at most `scale` (corridor through the room center) and has continuous derivatives at the border, like
+    RoomOverlap.
+    */
+    const Real pX = vars[0] + doorWeights[0] * vars[2] + shifts[0].x;
+    const Real pY = vars[1] + doorWeights[0] * vars[3] + shifts[0].y;
+    const Real qX = vars[4] + doorWeights[1] * vars[6] + shifts[1].x;
+    const Real qY = vars[5] + doorWeights[1] * vars[7] + shifts[1].y;
+    const Real dX = qX - pX;
+    const Real dY = qY - pY;
+    const Real squaredLength = AutoDiff::square(dX) + AutoDiff::square(dY);
+    if (squaredLength < kMinSquaredLength) {
+        return Real(0.0);
+    }
+    const Real eX = vars[8] - pX;
+    const Real eY = vars[9] - pY;
+    const Real absDX = AutoDiff::abs(dX);
+    const Real absDY = AutoDiff::abs(dY);
+
+    const Real normalRatio = (dX * eY - dY * eX) / (halfWidth * absDY + halfHeight * absDX);
+    if (normalRatio <= -1.0 || normalRatio >= 1.0) {
+        return Real(0.0);
+    }
+    const Real halfSquaredLength = 0.5 * squaredLength;
+    const Real tangentRatio =
+        (dX * eX + dY * eY - halfSquaredLength) / (halfSquaredLength + halfWidth * absDX + halfHeight * absDY);
+    if (tangentRatio <= -1.0 || tangentRatio >= 1.0) {
+        return Real(0.0);
+    }
+    return scale * AutoDiff::square(1.0 - AutoDiff::square(normalRatio)) *
+           AutoDiff::square(1.0 - AutoDiff::square(tangentRatio));
+}
+
+Model::Position CorridorCrossing::getEndPosition(const CorridorEnd& end, const double* x)
+{
+    return Model::Position{
+        .x = x[end.roomVars.xId] + end.doorWeight * x[end.doorVars.xId] + end.shift.x,
+        .y = x[end.roomVars.yId] + end.doorWeight * x[end.doorVars.yId] + end.shift.y};
+}
+
+CorridorCrossing::CorridorPairTerm CorridorCrossing::createCorridorPairTerm(
+    size_t corridorId1, size_t corridorId2) const
+{
+    CorridorPairTerm term;
+    const std::array<const CorridorEnd*, 4> ends{
+        &corridors_[corridorId1].ends[0], &corridors_[corridorId1].ends[1], &corridors_[corridorId2].ends[0],
+        &corridors_[corridorId2].ends[1]};
+    for (size_t endId = 0; endId < 4; ++endId) {
+        const CorridorEnd& end = *ends[endId];
+        term.variableIds[4 * endId] = end.roomVars.xId;
+        term.variableIds[4 * endId + 1] = end.roomVars.yId;
+        term.variableIds[4 * endId + 2] = end.doorVars.xId;
+        term.variableIds[4 * endId + 3] = end.doorVars.yId;
+        term.doorWeights[endId] = end.doorWeight;
+        term.shifts[endId] = end.shift;
+    }
+    term.scale = scale_;
+    return term;
+}
+
+CorridorCrossing::CorridorRoomTerm CorridorCrossing::createCorridorRoomTerm(size_t corridorId, size_t roomId) const
+{
+    CorridorRoomTerm term;
+    const CorridorEntry& corridor = corridors_[corridorId];
+    for (size_t endId = 0; endId < 2; ++endId) {
+        const CorridorEnd& end = corridor.ends[endId];
+        term.variableIds[4 * endId] = end.roomVars.xId;
+        term.variableIds[4 * endId + 1] = end.roomVars.yId;
+        term.variableIds[4 * endId + 2] = end.doorVars.xId;
+        term.variableIds[4 * endId + 3] = end.doorVars.yId;
+        term.doorWeights[endId] = end.doorWeight;
+        term.shifts[endId] = end.shift;
+    }
+    term.variableIds[8] = roomVars_[roomId].xId;
+    term.variableIds[9] = roomVars_[roomId].yId;
+    term.halfWidth = roomHalfSizes_[roomId].x;
+    term.halfHeight = roomHalfSizes_[roomId].y;
+    term.scale = scale_;
+    return term;
+}
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include <model/Model.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Penalizes corridors crossing each other and corridors passing through rooms other than their own. Both penalties are
+/// smooth, zero for separated objects and at most `scale` per pair.
+///
+/// Checking all pairs is quadratic, so only candidate pairs are evaluated. Candidates are found by a uniform grid over
+/// corridor and room boxes, inflated by `margin` to cover the movement during an outer iteration. The set is refreshed
+/// by updateCandidates, which is meant to be called between outer iterations (it's a ReaderCallback): changing the
+/// function inside a subsolve would break its line searches. There are no candidates before the first refresh.
+class CorridorCrossing {
+public:
+    /// Tables are allocated in `resource`
+    CorridorCrossing(
+        const Model::Model& model, double scale = 1.0, double margin = 0.0,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    void operator()(const double* x, double& f, double* grad) const;
+    /// Rebuilds candidate pairs for positions `x`
+    void updateCandidates(const double* x);
+    /// ReaderCallback signature
+    void operator()(const double* x, int runNum, int iterNum);
+
+    size_t getCorridorPairCount() const;
+    size_t getCorridorRoomPairCount() const;
+
+private:
+    /// Corridor end is the door center: parent room center + door variables (movable doors) + shift (fixed doors).
+    /// Fixed doors reuse room variables as door variables with zero weight, so that all ends look the same.
+    struct CorridorEnd {
+        Model::VariablesIds roomVars;
+        Model::VariablesIds doorVars;
+        double doorWeight;
+        Model::Position shift;
+    };
+
+    struct CorridorEntry {
+        std::array<CorridorEnd, 2> ends;
+        std::array<size_t, 2> roomIds;
+    };
+
+    /// Two corridors that properly cross each other. Variables are (room x, room y, door x, door y) of each end:
+    /// corridor 1 ends, then corridor 2 ends.
+    struct CorridorPairTerm {
+        static constexpr size_t kVariableCount = 16;
+        std::array<size_t, kVariableCount> variableIds;
+        std::array<double, 4> doorWeights;
+        std::array<Model::Position, 4> shifts;
+        double scale;
+
+        template <typename Real>
+        Real evaluate(const std::array<Real, kVariableCount>& vars) const;
+    };
+
+    /// Corridor passing through a room. Variables are corridor ends as in CorridorPairTerm, then the room center.
+    struct CorridorRoomTerm {
+        static constexpr size_t kVariableCount = 10;
+        std::array<size_t, kVariableCount> variableIds;
+        std::array<double, 2> doorWeights;
+        std::array<Model::Position, 2> shifts;
+        double halfWidth;
+        double halfHeight;
+        double scale;
+
+        template <typename Real>
+        Real evaluate(const std::array<Real, kVariableCount>& vars) const;
+    };
+
+    static Model::Position getEndPosition(const CorridorEnd& end, const double* x);
+    CorridorPairTerm createCorridorPairTerm(size_t corridorId1, size_t corridorId2) const;
+    CorridorRoomTerm createCorridorRoomTerm(size_t corridorId, size_t roomId) const;
+
+    const double scale_ = 1.0;
+    const double margin_ = 0.0;
+
+    std::pmr::vector<CorridorEntry> corridors_;
+    std::pmr::vector<Model::VariablesIds> roomVars_;
+    std::pmr::vector<Model::Position> roomHalfSizes_;
+    double averageRoomSize_ = 0.0;  // Cell size of the broad phase grid
+
+    // Candidates of the last refresh. Only ids are stored, terms are assembled from the tables on evaluation: it's
+    // cheap compared to the terms themselves, and the candidates stay small.
+    std::pmr::vector<std::pair<size_t, size_t>> corridorPairs_;
+    std::pmr::vector<std::pair<size_t, size_t>> corridorRoomPairs_;  // Corridor id, room id
+};
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
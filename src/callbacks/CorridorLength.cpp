@@ -1,19 +1,90 @@
 #include "CorridorLength.h"
 
+#include <cassert>
+
 #include <model/Variables.h>
 
 namespace DungeonGeneration {
 namespace Callbacks {
 
+CorridorLength::CorridorLength(
+    const Model::Model& model, const std::vector<bool>& activeRooms, std::pmr::memory_resource* resource)
+      : fixedFixed_(resource),
+        fixedMovable_(resource),
+        movableMovable_(resource)
+{
+    assert((activeRooms.empty() || activeRooms.size() == model.rooms().size()) && "Invalid active rooms count");
+    const Model::Doors& doors = model.doors();
+    for (const Model::Corridor& corridor : model.corridors()) {
+        const Model::Door& door1 = doors[corridor.door1Id];
+        const Model::Door& door2 = doors[corridor.door2Id];
+        if (!activeRooms.empty() && !activeRooms[door1.parentRoomId()] && !activeRooms[door2.parentRoomId()]) {
+            continue;
+        }
+        addCorridor(door1, door2);
+    }
+}
+
 CorridorLength::CorridorLength(const Model::Door& door1, const Model::Door& door2)
-      : door1_(door1),
-        door2_(door2)
-{}
+{
+    addCorridor(door1, door2);
+}
 
 void CorridorLength::operator()(const double* x, double& f, double* grad) const
+{
+    if (grad != nullptr) {
+        evaluate<false, false, true>(fixedFixed_, x, f, grad);
+        evaluate<false, true, true>(fixedMovable_, x, f, grad);
+        evaluate<true, true, true>(movableMovable_, x, f, grad);
+    } else {
+        evaluate<false, false, false>(fixedFixed_, x, f, grad);
+        evaluate<false, true, false>(fixedMovable_, x, f, grad);
+        evaluate<true, true, false>(movableMovable_, x, f, grad);
+    }
+}
+
+void CorridorLength::addCorridor(const Model::Door& door1, const Model::Door& door2)
 {
     using namespace Model::VarUtils;
 
+    if (door1.isMovable() && !door2.isMovable()) {
+        addCorridor(door2, door1);
+        return;
+    }
+
+    CorridorEntry entry{
+        .room1Vars = getVariablesIds(door1.parentRoomId()),
+        .room2Vars = getVariablesIds(door2.parentRoomId()),
+        .door1Vars = {},
+        .door2Vars = {},
+        .offset = {0.0, 0.0}};
+    if (door1.isMovable()) {
+        entry.door1Vars = door1.getVariablesIds();
+    } else {
+        entry.offset.x += door1.shift().x;
+        entry.offset.y += door1.shift().y;
+    }
+    if (door2.isMovable()) {
+        entry.door2Vars = door2.getVariablesIds();
+    } else {
+        entry.offset.x -= door2.shift().x;
+        entry.offset.y -= door2.shift().y;
+    }
+
+    if (door1.isMovable()) {
+        movableMovable_.push_back(entry);
+    } else if (door2.isMovable()) {
+        fixedMovable_.push_back(entry);
+    } else {
+        fixedFixed_.push_back(entry);
+    }
+}
+
+template <bool kMovableDoor1, bool kMovableDoor2, bool kWithGradient>
+void CorridorLength::evaluate(const CorridorEntries& corridors, const double* x, double& f, double* grad)
+{
+    static_assert(kMovableDoor2 || !kMovableDoor1, "Movable-fixed corridors must be stored as fixed-movable");
+
     /*
     Euclidean square distance with account to possibly movable doors
     dx = x_r1 + x_d1 - x_r2 - x_d2
@@ -21,39 +92,40 @@ void CorridorLength::operator()(const double* x, double& f, double* grad) const
     f = dx^2 + dy^2
     gradX1 = 2 * dx -- for both room and door (if one is movable)
     gradY1 = 2 * dy
+    Shifts of fixed doors are constant, so they're merged into a single offset.
     */
-
-    const auto [x1, y1] = door1_.getCenterPositionFromVars(x);  // x_r1 + x_d1, y_r1 + y_d1
-    const auto [x2, y2] = door2_.getCenterPositionFromVars(x);  // x_r2 + x_d2, y_r2 + y_d2
-
-    const double dx = x1 - x2;
-    const double dy = y1 - y2;
-    f += dx * dx + dy * dy;
-
-    if (grad != nullptr) {
-        const double gradX1 = 2 * dx;
-        const double gradY1 = 2 * dy;
-
-        const auto [xRoom1Id, yRoom1Id] = getVariablesIds(door1_.parentRoomId());
-        const auto [xRoom2Id, yRoom2Id] = getVariablesIds(door2_.parentRoomId());
-        grad[xRoom1Id] += gradX1;
-        grad[yRoom1Id] += gradY1;
-
-        grad[xRoom2Id] -= gradX1;
-        grad[yRoom2Id] -= gradY1;
-
-        if (door1_.isMovable()) {
-            const auto [xDoor1Id, yDoor1Id] = door1_.getVariablesIds();
-            grad[xDoor1Id] += gradX1;
-            grad[yDoor1Id] += gradY1;
+    double fSum = 0.0;
+    for (const CorridorEntry& corridor : corridors) {
+        double dx = x[corridor.room1Vars.xId] - x[corridor.room2Vars.xId] + corridor.offset.x;
+        double dy = x[corridor.room1Vars.yId] - x[corridor.room2Vars.yId] + corridor.offset.y;
+        if constexpr (kMovableDoor1) {
+            dx += x[corridor.door1Vars.xId];
+            dy += x[corridor.door1Vars.yId];
+        }
+        if constexpr (kMovableDoor2) {
+            dx -= x[corridor.door2Vars.xId];
+            dy -= x[corridor.door2Vars.yId];
         }
+        fSum += dx * dx + dy * dy;
 
-        if (door2_.isMovable()) {
-            const auto [xDoor2Id, yDoor2Id] = door2_.getVariablesIds();
-            grad[xDoor2Id] -= gradX1;
-            grad[yDoor2Id] -= gradY1;
+        if constexpr (kWithGradient) {
+            const double gradX1 = 2 * dx;
+            const double gradY1 = 2 * dy;
+            grad[corridor.room1Vars.xId] += gradX1;
+            grad[corridor.room1Vars.yId] += gradY1;
+            grad[corridor.room2Vars.xId] -= gradX1;
+            grad[corridor.room2Vars.yId] -= gradY1;
+            if constexpr (kMovableDoor1) {
+                grad[corridor.door1Vars.xId] += gradX1;
+                grad[corridor.door1Vars.yId] += gradY1;
+            }
+            if constexpr (kMovableDoor2) {
+                grad[corridor.door2Vars.xId] -= gradX1;
+                grad[corridor.door2Vars.yId] -= gradY1;
+            }
         }
     }
+    f += fSum;
 }
 
 }  // namespace Callbacks
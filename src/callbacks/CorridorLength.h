@@ -1,18 +1,45 @@
 #pragma once
 
+#include <memory_resource>
+#include <vector>
+
 #include <model/Door.h>
+#include <model/Model.h>
 
 namespace DungeonGeneration {
 namespace Callbacks {
 
+/// Sum of squared corridor lengths. Corridors are grouped by kinds of their doors at construction, so that each group
+/// is evaluated by its own specialized kernel without checking door kinds in the loop.
 class CorridorLength {
 public:
+    /// If `activeRooms` is not empty, only corridors with at least one active room are included.
+    /// Corridor tables are allocated in `resource`.
+    explicit CorridorLength(
+        const Model::Model& model, const std::vector<bool>& activeRooms = {},
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     CorridorLength(const Model::Door& door1, const Model::Door& door2);
     void operator()(const double* x, double& f, double* grad) const;
 
 private:
-    const Model::Door& door1_;
-    const Model::Door& door2_;
+    struct CorridorEntry {
+        Model::VariablesIds room1Vars;
+        Model::VariablesIds room2Vars;
+        Model::VariablesIds door1Vars;  // Only for movable door1
+        Model::VariablesIds door2Vars;  // Only for movable door2
+        Model::Position offset;         // Sum of fixed doors' shifts: shift1 - shift2
+    };
+    using CorridorEntries = std::pmr::vector<CorridorEntry>;
+
+    void addCorridor(const Model::Door& door1, const Model::Door& door2);
+
+    template <bool kMovableDoor1, bool kMovableDoor2, bool kWithGradient>
+    static void evaluate(const CorridorEntries& corridors, const double* x, double& f, double* grad);
+
+    // Movable-fixed corridors are stored as fixed-movable ones: the function is symmetric
+    CorridorEntries fixedFixed_;
+    CorridorEntries fixedMovable_;
+    CorridorEntries movableMovable_;
 };
 
 }  // namespace Callbacks
@@ -9,6 +9,16 @@ using FGEval = std::function<void(const double*, double&, double*)>;
 using CEqFGEval = std::function<void(const double*, double&, void*, int)>;  // void* to avoid defining PETSc structures
 using ModifierCallback = std::function<void(double*)>;
 using ReaderCallback = std::function<void(const double*, int, int)>;
+/// Cost terms and constraints evaluated in one pass over x: adds to f and grad, writes values of its constraints into
+/// cEq and their Jacobian rows into JEq. Constraint ids of the term start at the last argument.
+using FusedEval = std::function<void(const double*, double&, double*, double*, void*, int)>;
+
+/// Arithmetic precision of bounded terms (push force, room overlap). In mixed mode terms are evaluated in float, while
+/// function values and gradients are still accumulated in double.
+enum class Precision {
+    Double,
+    Mixed,
+};
 
 }  // namespace Callbacks
 }  // namespace DungeonGeneration
@@ -0,0 +1,139 @@
+#include "DerivativeCheck.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+namespace DungeonGeneration {
+namespace Callbacks {
+namespace DerivativeCheck {
+
+namespace {
+
+/// Direction `directionId` depends only on the seed and its id, so results don't depend on the thread count
+std::vector<double> makeDirection(size_t directionId, size_t size, const Options& options)
+{
+    Random::RNG rng = Random::RNG(options.seed).split(directionId);
+    std::vector<double> direction(size);
+    for (double& component : direction) {
+        component = Random::uniformRangeContinuous(-1.0, 1.0, rng);
+    }
+    return direction;
+}
+
+/// Runs `checkDirection(directionId, result)` for every direction on a few threads and merges the results
+template <typename CheckDirection>
+Result runDirections(const Options& options, CheckDirection&& checkDirection)
+{
+    size_t threadCount = options.threadCount;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::clamp<size_t>(threadCount, 1, std::max<size_t>(options.directionCount, 1));
+
+    Result result;
+    std::mutex resultMutex;
+    auto runWorker = [&](size_t workerId) {
+        Result workerResult;
+        for (size_t directionId = workerId; directionId < options.directionCount; directionId += threadCount) {
+            checkDirection(directionId, workerResult);
+        }
+        std::lock_guard lock(resultMutex);
+        result.checkedCount += workerResult.checkedCount;
+        result.failedCount += workerResult.failedCount;
+        result.maxError = std::max(result.maxError, workerResult.maxError);
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (size_t workerId = 1; workerId < threadCount; ++workerId) {
+        workers.emplace_back(runWorker, workerId);
+    }
+    runWorker(0);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return result;
+}
+
+/// Compares the central difference (valuePlus - valueMinus) / (2 * step) with the analytical directional derivative
+void compare(double valuePlus, double valueMinus, double analytical, const Options& options, Result& result)
+{
+    const double numerical = (valuePlus - valueMinus) / (2 * options.step);
+    const double roundoff = options.roundoffTolerance * std::numeric_limits<double>::epsilon() *
+                            (std::abs(valuePlus) + std::abs(valueMinus)) / (2 * options.step);
+    const double error = std::abs(numerical - analytical);
+    ++result.checkedCount;
+    // NaN errors fail too
+    if (!(error <= options.absTolerance + options.relTolerance * std::abs(analytical) + roundoff)) {
+        ++result.failedCount;
+    }
+    result.maxError = std::max(result.maxError, std::isnan(error) ? std::numeric_limits<double>::infinity() : error);
+}
+
+}  // namespace
+
+Result checkGradient(const FGEval& function, const std::vector<double>& x, const Options& options)
+{
+    assert(options.step > 0 && "DerivativeCheck::checkGradient: step must be positive");
+    double f = 0.0;
+    std::vector<double> gradient(x.size(), 0.0);
+    function(x.data(), f, gradient.data());
+
+    return runDirections(options, [&](size_t directionId, Result& result) {
+        const std::vector<double> direction = makeDirection(directionId, x.size(), options);
+        double analytical = 0.0;
+        for (size_t varId = 0; varId < x.size(); ++varId) {
+            analytical += gradient[varId] * direction[varId];
+        }
+
+        std::vector<double> xPlus(x.size());
+        std::vector<double> xMinus(x.size());
+        for (size_t varId = 0; varId < x.size(); ++varId) {
+            xPlus[varId] = x[varId] + options.step * direction[varId];
+            xMinus[varId] = x[varId] - options.step * direction[varId];
+        }
+        double fPlus = 0.0;
+        double fMinus = 0.0;
+        function(xPlus.data(), fPlus, nullptr);
+        function(xMinus.data(), fMinus, nullptr);
+        compare(fPlus, fMinus, analytical, options, result);
+    });
+}
+
+Result checkJacobian(
+    const VectorEval& function, const SparseMatrix& jacobian, const std::vector<double>& x, const Options& options)
+{
+    assert(options.step > 0 && "DerivativeCheck::checkJacobian: step must be positive");
+    assert(!jacobian.rowOffsets.empty() && "DerivativeCheck::checkJacobian: rowOffsets must have an end offset");
+    const size_t outputCount = jacobian.rowOffsets.size() - 1;
+
+    return runDirections(options, [&](size_t directionId, Result& result) {
+        const std::vector<double> direction = makeDirection(directionId, x.size(), options);
+
+        std::vector<double> xPlus(x.size());
+        std::vector<double> xMinus(x.size());
+        for (size_t varId = 0; varId < x.size(); ++varId) {
+            xPlus[varId] = x[varId] + options.step * direction[varId];
+            xMinus[varId] = x[varId] - options.step * direction[varId];
+        }
+        std::vector<double> valuesPlus(outputCount);
+        std::vector<double> valuesMinus(outputCount);
+        function(xPlus.data(), valuesPlus.data());
+        function(xMinus.data(), valuesMinus.data());
+
+        for (size_t row = 0; row < outputCount; ++row) {
+            double analytical = 0.0;
+            for (size_t i = jacobian.rowOffsets[row]; i < jacobian.rowOffsets[row + 1]; ++i) {
+                analytical += jacobian.values[i] * direction[jacobian.columns[i]];
+            }
+            compare(valuesPlus[row], valuesMinus[row], analytical, options, result);
+        }
+    });
+}
+
+}  // namespace DerivativeCheck
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
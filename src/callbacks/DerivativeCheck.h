@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <utils/Random.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Derivative verification that scales to production-sized models. Instead of a finite difference per variable, the
+/// analytical derivative is computed once and compared with central differences along random directions: checking
+/// `directionCount` directions costs 2 * `directionCount` evaluations whatever the number of variables. A wrong
+/// partial derivative changes almost every directional derivative. Directions are spread over threads, so evaluated
+/// functions must be safe to call concurrently (const callbacks are).
+namespace DerivativeCheck {
+
+struct Options {
+    size_t directionCount = 16;
+    double step = 1e-3;  // Along directions with components in [-1, 1]
+    double absTolerance = 1e-6;
+    double relTolerance = 1e-4;  // Relative to the analytical directional derivative
+    /// Allowed cancellation error of the difference, in epsilons of the function values. Matters for functions that
+    /// are large sums, e.g. squared lengths of all corridors.
+    double roundoffTolerance = 64.0;
+    size_t threadCount = 0;  // 0 is the number of hardware threads
+    uint64_t seed = Random::kGlobalSeed;
+};
+
+struct Result {
+    size_t checkedCount = 0;  // Directions times outputs
+    size_t failedCount = 0;
+    double maxError = 0.0;  // Largest |numerical - analytical| among all checks
+};
+
+/// Sparse matrix in the compressed rows format
+struct SparseMatrix {
+    std::vector<size_t> rowOffsets;  // Row i is [rowOffsets[i], rowOffsets[i + 1])
+    std::vector<size_t> columns;
+    std::vector<double> values;
+};
+
+/// Writes values of all outputs at `x` into `values`
+using VectorEval = std::function<void(const double* x, double* values)>;
+
+/// Checks the gradient of a cost function at `x`
+Result checkGradient(const FGEval& function, const std::vector<double>& x, const Options& options = {});
+/// Checks the Jacobian of a vector function at `x`, computed by the caller, e.g. assembled from penalty callbacks.
+/// Every output is compared separately.
+Result checkJacobian(
+    const VectorEval& function, const SparseMatrix& jacobian, const std::vector<double>& x,
+    const Options& options = {});
+
+}  // namespace DerivativeCheck
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -1,100 +1,324 @@
 #include "PushForce.h"
 
+#include <array>
 #include <cassert>
 #include <cstdlib>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 namespace DungeonGeneration {
 namespace Callbacks {
 
-PushForce::PushForce(const Model::Model& model, double scale, double range)
-      : model_(model),
-        scale_(scale),
+#if defined(__AVX2__)
+namespace {
+
+/// Load (x, y) variables of 4 objects and transpose them into vectors of x's and y's. Coordinates of an object are
+/// adjacent, so two 128-bit loads per object are cheaper than two gathers.
+inline void loadVariables(const double* x, const int32_t* xIds, __m256d& xs, __m256d& ys)
+{
+    const __m256d vars02 =
+        _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(x + xIds[0])), _mm_loadu_pd(x + xIds[2]), 1);
+    const __m256d vars13 =
+        _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(x + xIds[1])), _mm_loadu_pd(x + xIds[3]), 1);
+    xs = _mm256_unpacklo_pd(vars02, vars13);
+    ys = _mm256_unpackhi_pd(vars02, vars13);
+}
+
+/// Coordinate differences of 8 pairs, converted to float. Differences are taken in double: coordinates may be large
+/// compared to the rooms, and float would lose the difference to cancellation.
+inline void loadDifferencesFloat(const double* x, const int32_t* x1Ids, const int32_t* x2Ids, __m256& dx, __m256& dy)
+{
+    __m128 dxHalves[2];
+    __m128 dyHalves[2];
+    for (size_t half = 0; half < 2; ++half) {
+        __m256d x1, y1, x2, y2;
+        loadVariables(x, x1Ids + 4 * half, x1, y1);
+        loadVariables(x, x2Ids + 4 * half, x2, y2);
+        dxHalves[half] = _mm256_cvtpd_ps(_mm256_sub_pd(x1, x2));
+        dyHalves[half] = _mm256_cvtpd_ps(_mm256_sub_pd(y1, y2));
+    }
+    dx = _mm256_insertf128_ps(_mm256_castps128_ps256(dxHalves[0]), dxHalves[1], 1);
+    dy = _mm256_insertf128_ps(_mm256_castps128_ps256(dyHalves[0]), dyHalves[1], 1);
+}
+
+}  // namespace
+#endif
+
+PushForce::PushForce(
+    const Model::Model& model, double scale, double range, const std::vector<bool>& activeRooms, Precision precision,
+    std::pmr::memory_resource* resource)
+      : scale_(scale),
         range_(range),
-        disconnectedRooms_(findDisconnectedRooms(model))
-{}
+        precision_(precision),
+        pairX1Ids_(resource),
+        pairX2Ids_(resource),
+        pairInvScaledHW_(resource),
+        pairInvScaledHH_(resource),
+        pairInvScaledHWFloat_(resource),
+        pairInvScaledHHFloat_(resource)
+{
+    buildPairTable(model, activeRooms);
+}
 
 void PushForce::operator()(const double* x, double& f, double* grad) const
 {
-    if constexpr (kPushOnlyDisconnected) {
-        for (RoomPair rooms : disconnectedRooms_) {
-            calculatePush(rooms, x, f, grad);
-        }
+    if (precision_ == Precision::Mixed) {
+        evaluate<float>(x, f, grad);
     } else {
-        size_t roomCount = model_.rooms().size();
-        for (size_t i = 0; i < roomCount; ++i) {
-            for (size_t j = i + 1; j < roomCount; ++j) {
-                calculatePush(RoomPair{i, j}, x, f, grad);
-            }
-        }
+        evaluate<double>(x, f, grad);
     }
 }
 
-PushForce::RoomPairs PushForce::findDisconnectedRooms(const Model::Model& model) const
+bool PushForce::isVectorized()
 {
-    RoomPairs disconnectedRooms;
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
 
-    size_t n = model_.rooms().size();
-    std::vector<std::vector<bool>> areConnected(n, std::vector<bool>(n, false));
-    for (const Model::Corridor& corridor : model_.corridors()) {
-        size_t room1 = corridor.door1.parentRoomId();
-        size_t room2 = corridor.door2.parentRoomId();
+void PushForce::buildPairTable(const Model::Model& model, const std::vector<bool>& activeRooms)
+{
+    const Model::Rooms& rooms = model.rooms();
+    const size_t n = rooms.size();
+    assert((activeRooms.empty() || activeRooms.size() == n) && "Invalid active rooms count");
+    std::pmr::memory_resource* resource = pairX1Ids_.get_allocator().resource();
+    std::pmr::vector<std::pmr::vector<bool>> areConnected(n, std::pmr::vector<bool>(n, false, resource), resource);
+    for (const Model::Corridor& corridor : model.corridors()) {
+        const auto [room1, room2] = model.getCorridorRooms(corridor);
         areConnected[room1][room2] = true;
         areConnected[room2][room1] = true;
     }
-    for (size_t room1 = 0; room1 < n - 1; ++room1) {
+    for (size_t room1 = 0; room1 + 1 < n; ++room1) {
         for (size_t room2 = room1 + 1; room2 < n; ++room2) {
-            if (areConnected[room1][room2]) {
+            if (kPushOnlyDisconnected && areConnected[room1][room2]) {
+                continue;
+            }
+            if (!activeRooms.empty() && !activeRooms[room1] && !activeRooms[room2]) {
                 continue;
             }
-            disconnectedRooms.push_back({room1, room2});
+            addRoomPair(rooms[room1], rooms[room2]);
         }
     }
-    return disconnectedRooms;
 }
 
-void PushForce::calculatePush(RoomPair rooms, const double* x, double& f, double* grad) const
+void PushForce::addRoomPair(const Model::Room& room1, const Model::Room& room2)
 {
-    const Model::Rooms& allRooms = model_.rooms();
-    assert(rooms.roomId1 < allRooms.size() && "Invalid room1Id");
-    assert(rooms.roomId2 < allRooms.size() && "Invalid room2Id");
-    const Model::Room& room1 = allRooms[rooms.roomId1];
-    const Model::Room& room2 = allRooms[rooms.roomId2];
-
-    const auto [x1, y1] = room1.getVariablesVal(x);
-    const auto [x2, y2] = room2.getVariablesVal(x);
     const auto [x1Id, y1Id] = room1.getVariablesIds();
     const auto [x2Id, y2Id] = room2.getVariablesIds();
+    assert(y1Id == x1Id + 1 && y2Id == x2Id + 1 && "PushForce: unexpected variables layout");
 
-    const double dx = x1 - x2;
-    const double dy = y1 - y2;
     const double sumHW = (room1.width() + room2.width()) / 2;
     const double sumHH = (room1.height() + room2.height()) / 2;
+    pairX1Ids_.push_back(static_cast<int32_t>(x1Id));
+    pairX2Ids_.push_back(static_cast<int32_t>(x2Id));
+    if (precision_ == Precision::Mixed) {
+        pairInvScaledHWFloat_.push_back(static_cast<float>(1.0 / (range_ * sumHW)));
+        pairInvScaledHHFloat_.push_back(static_cast<float>(1.0 / (range_ * sumHH)));
+    } else {
+        pairInvScaledHW_.push_back(1.0 / (range_ * sumHW));
+        pairInvScaledHH_.push_back(1.0 / (range_ * sumHH));
+    }
+}
+
+template <typename Real>
+const Real* PushForce::getInvScaledHW() const
+{
+    if constexpr (std::is_same_v<Real, float>) {
+        return pairInvScaledHWFloat_.data();
+    } else {
+        return pairInvScaledHW_.data();
+    }
+}
+
+template <typename Real>
+const Real* PushForce::getInvScaledHH() const
+{
+    if constexpr (std::is_same_v<Real, float>) {
+        return pairInvScaledHHFloat_.data();
+    } else {
+        return pairInvScaledHH_.data();
+    }
+}
 
-    /*
-    xRatio = dx / (range * sumHW)
-    yRatio = dy / (range * sumHH)
-    f = scale / (xRatio^2 + yRatio^2 + 1)
-    gradX1 = -scale * (2 * dx / (range * sumHW)^2) / (xRatio^2 + yRatio^2 + 1)^2
-    gradY1 = -scale * (2 * dy / (range * sumHH)^2) / (xRatio^2 + yRatio^2 + 1)^2
-    gradX2 = -gradX1
-    gradY2 = -gradY1
-    */
-    const double xRatio = dx / (range_ * sumHW);
-    const double yRatio = dy / (range_ * sumHH);
-    const double denominator = xRatio * xRatio + yRatio * yRatio + 1;
-    const double fVal = scale_ / denominator;
-
-    f += fVal;
-    assert(0 <= fVal && fVal <= scale_ && "Room overlap should be in range [0, scale]");
+template <typename Real>
+void PushForce::evaluate(const double* x, double& f, double* grad) const
+{
+    constexpr bool kMixed = std::is_same_v<Real, float>;
 
+    // Scalar kernel handles the tail, or all pairs if vectorization is disabled
     if (grad != nullptr) {
-        const double gradX1 = (-2.0 * xRatio / (range_ * sumHW)) * fVal / denominator;
-        const double gradY1 = (-2.0 * yRatio / (range_ * sumHH)) * fVal / denominator;
-        grad[x1Id] += gradX1;
-        grad[y1Id] += gradY1;
-        grad[x2Id] -= gradX1;
-        grad[y2Id] -= gradY1;
+        const size_t processedCount = (kMixed ? evaluateAVX2Mixed<true>(x, f, grad) : evaluateAVX2<true>(x, f, grad));
+        evaluateScalar<Real, true>(processedCount, x, f, grad);
+    } else {
+        const size_t processedCount =
+            (kMixed ? evaluateAVX2Mixed<false>(x, f, grad) : evaluateAVX2<false>(x, f, grad));
+        evaluateScalar<Real, false>(processedCount, x, f, grad);
+    }
+}
+
+/*
+xRatio = dx / (range * sumHW)
+yRatio = dy / (range * sumHH)
+f = scale / (xRatio^2 + yRatio^2 + 1)
+gradX1 = -scale * (2 * dx / (range * sumHW)^2) / (xRatio^2 + yRatio^2 + 1)^2
+gradY1 = -scale * (2 * dy / (range * sumHH)^2) / (xRatio^2 + yRatio^2 + 1)^2
+gradX2 = -gradX1
+gradY2 = -gradY1
+*/
+template <typename Real, bool kWithGradient>
+void PushForce::evaluateScalar(size_t firstPairId, const double* x, double& f, double* grad) const
+{
+    const size_t pairCount = pairX1Ids_.size();
+    const Real* invScaledHWs = getInvScaledHW<Real>();
+    const Real* invScaledHHs = getInvScaledHH<Real>();
+    const Real scale = static_cast<Real>(scale_);
+    for (size_t pairId = firstPairId; pairId < pairCount; ++pairId) {
+        const size_t x1Id = pairX1Ids_[pairId];
+        const size_t x2Id = pairX2Ids_[pairId];
+        const Real invScaledHW = invScaledHWs[pairId];
+        const Real invScaledHH = invScaledHHs[pairId];
+
+        // Differences are taken in double in both modes, see loadDifferencesFloat
+        const Real xRatio = static_cast<Real>(x[x1Id] - x[x2Id]) * invScaledHW;
+        const Real yRatio = static_cast<Real>(x[x1Id + 1] - x[x2Id + 1]) * invScaledHH;
+        const Real invDenominator = Real(1) / (xRatio * xRatio + yRatio * yRatio + Real(1));
+        const Real fVal = scale * invDenominator;
+
+        f += fVal;
+        assert(0 <= fVal && fVal <= scale && "Room overlap should be in range [0, scale]");
+
+        if constexpr (kWithGradient) {
+            const Real gradFactor = Real(-2) * fVal * invDenominator;
+            const Real gradX1 = gradFactor * xRatio * invScaledHW;
+            const Real gradY1 = gradFactor * yRatio * invScaledHH;
+            grad[x1Id] += gradX1;
+            grad[x1Id + 1] += gradY1;
+            grad[x2Id] -= gradX1;
+            grad[x2Id + 1] -= gradY1;
+        }
+    }
+}
+
+template <bool kWithGradient>
+size_t PushForce::evaluateAVX2(
+    [[maybe_unused]] const double* x, [[maybe_unused]] double& f, [[maybe_unused]] double* grad) const
+{
+#if defined(__AVX2__)
+    constexpr size_t kBatchSize = 4;
+    const size_t pairCount = pairX1Ids_.size();
+    const __m256d ones = _mm256_set1_pd(1.0);
+    const __m256d minusTwos = _mm256_set1_pd(-2.0);
+    const __m256d scales = _mm256_set1_pd(scale_);
+
+    __m256d fSum = _mm256_setzero_pd();
+    size_t pairId = 0;
+    for (; pairId + kBatchSize <= pairCount; pairId += kBatchSize) {
+        __m256d x1, y1, x2, y2;
+        loadVariables(x, pairX1Ids_.data() + pairId, x1, y1);
+        loadVariables(x, pairX2Ids_.data() + pairId, x2, y2);
+        const __m256d invScaledHW = _mm256_loadu_pd(pairInvScaledHW_.data() + pairId);
+        const __m256d invScaledHH = _mm256_loadu_pd(pairInvScaledHH_.data() + pairId);
+
+        // Same operations in the same order as in the scalar kernel
+        const __m256d xRatio = _mm256_mul_pd(_mm256_sub_pd(x1, x2), invScaledHW);
+        const __m256d yRatio = _mm256_mul_pd(_mm256_sub_pd(y1, y2), invScaledHH);
+        const __m256d invDenominator = _mm256_div_pd(
+            ones, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(xRatio, xRatio), _mm256_mul_pd(yRatio, yRatio)), ones));
+        const __m256d fVal = _mm256_mul_pd(scales, invDenominator);
+        fSum = _mm256_add_pd(fSum, fVal);
+
+        if constexpr (kWithGradient) {
+            const __m256d gradFactor = _mm256_mul_pd(_mm256_mul_pd(minusTwos, fVal), invDenominator);
+            alignas(32) std::array<double, kBatchSize> gradX1;
+            alignas(32) std::array<double, kBatchSize> gradY1;
+            _mm256_store_pd(gradX1.data(), _mm256_mul_pd(_mm256_mul_pd(gradFactor, xRatio), invScaledHW));
+            _mm256_store_pd(gradY1.data(), _mm256_mul_pd(_mm256_mul_pd(gradFactor, yRatio), invScaledHH));
+
+            // AVX2 has no scatter. Lanes are added one after another, so pairs sharing a room in one batch are fine.
+            for (size_t lane = 0; lane < kBatchSize; ++lane) {
+                const size_t x1Id = pairX1Ids_[pairId + lane];
+                const size_t x2Id = pairX2Ids_[pairId + lane];
+                grad[x1Id] += gradX1[lane];
+                grad[x1Id + 1] += gradY1[lane];
+                grad[x2Id] -= gradX1[lane];
+                grad[x2Id + 1] -= gradY1[lane];
+            }
+        }
+    }
+
+    alignas(32) std::array<double, 4> fLanes;
+    _mm256_store_pd(fLanes.data(), fSum);
+    f += (fLanes[0] + fLanes[1]) + (fLanes[2] + fLanes[3]);
+    return pairId;
+#else
+    return 0;
+#endif
+}
+
+template <bool kWithGradient>
+size_t PushForce::evaluateAVX2Mixed(
+    [[maybe_unused]] const double* x, [[maybe_unused]] double& f, [[maybe_unused]] double* grad) const
+{
+#if defined(__AVX2__)
+    constexpr size_t kBatchSize = 8;
+    const size_t pairCount = pairX1Ids_.size();
+    const __m256 ones = _mm256_set1_ps(1.0f);
+    const __m256 twos = _mm256_set1_ps(2.0f);
+    const __m256 minusTwos = _mm256_set1_ps(-2.0f);
+    const __m256 scales = _mm256_set1_ps(static_cast<float>(scale_));
+
+    __m256d fSum = _mm256_setzero_pd();
+    size_t pairId = 0;
+    for (; pairId + kBatchSize <= pairCount; pairId += kBatchSize) {
+        __m256 dx, dy;
+        loadDifferencesFloat(x, pairX1Ids_.data() + pairId, pairX2Ids_.data() + pairId, dx, dy);
+        const __m256 invScaledHW = _mm256_loadu_ps(pairInvScaledHWFloat_.data() + pairId);
+        const __m256 invScaledHH = _mm256_loadu_ps(pairInvScaledHHFloat_.data() + pairId);
+
+        const __m256 xRatio = _mm256_mul_ps(dx, invScaledHW);
+        const __m256 yRatio = _mm256_mul_ps(dy, invScaledHH);
+        const __m256 denominator =
+            _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xRatio, xRatio), _mm256_mul_ps(yRatio, yRatio)), ones);
+        // Approximate reciprocal (12 bits) refined with one Newton step is accurate to float precision and is cheaper
+        // than a division
+        const __m256 approxInv = _mm256_rcp_ps(denominator);
+        const __m256 invDenominator =
+            _mm256_mul_ps(approxInv, _mm256_sub_ps(twos, _mm256_mul_ps(denominator, approxInv)));
+        const __m256 fVal = _mm256_mul_ps(scales, invDenominator);
+        // Values are accumulated in double
+        fSum = _mm256_add_pd(fSum, _mm256_cvtps_pd(_mm256_castps256_ps128(fVal)));
+        fSum = _mm256_add_pd(fSum, _mm256_cvtps_pd(_mm256_extractf128_ps(fVal, 1)));
+
+        if constexpr (kWithGradient) {
+            const __m256 gradFactor = _mm256_mul_ps(_mm256_mul_ps(minusTwos, fVal), invDenominator);
+            alignas(32) std::array<float, kBatchSize> gradX1;
+            alignas(32) std::array<float, kBatchSize> gradY1;
+            _mm256_store_ps(gradX1.data(), _mm256_mul_ps(_mm256_mul_ps(gradFactor, xRatio), invScaledHW));
+            _mm256_store_ps(gradY1.data(), _mm256_mul_ps(_mm256_mul_ps(gradFactor, yRatio), invScaledHH));
+
+            for (size_t lane = 0; lane < kBatchSize; ++lane) {
+                const size_t x1Id = pairX1Ids_[pairId + lane];
+                const size_t x2Id = pairX2Ids_[pairId + lane];
+                grad[x1Id] += gradX1[lane];
+                grad[x1Id + 1] += gradY1[lane];
+                grad[x2Id] -= gradX1[lane];
+                grad[x2Id + 1] -= gradY1[lane];
+            }
+        }
     }
+
+    alignas(32) std::array<double, 4> fLanes;
+    _mm256_store_pd(fLanes.data(), fSum);
+    f += (fLanes[0] + fLanes[1]) + (fLanes[2] + fLanes[3]);
+    return pairId;
+#else
+    return 0;
+#endif
 }
 
 }  // namespace Callbacks
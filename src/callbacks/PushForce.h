@@ -1,31 +1,64 @@
 #pragma once
 
+#include <cstdint>
+#include <memory_resource>
+
 #include <model/Model.h>
 
+#include "Defs.h"
+
 namespace DungeonGeneration {
 namespace Callbacks {
 
+/// Pushes apart every pair of rooms. Pairs are precomputed into a structure of arrays, so that the kernel doesn't touch
+/// the model and can evaluate several pairs at once (with AVX2, if enabled at build time).
 class PushForce {
-    struct RoomPair {
-        size_t roomId1;
-        size_t roomId2;
-    };
-    using RoomPairs = std::vector<RoomPair>;
-
 public:
-    PushForce(const Model::Model& model, double scale = 1.0, double range = 1.0);
+    /// If `activeRooms` is not empty, only pairs with at least one active room are pushed.
+    /// Pairs table is allocated in `resource`.
+    PushForce(
+        const Model::Model& model, double scale = 1.0, double range = 1.0, const std::vector<bool>& activeRooms = {},
+        Precision precision = Precision::Double,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
     void operator()(const double* x, double& f, double* grad) const;
 
+    /// Whether the library was built with the AVX2 kernels (see DUNGEON_GENERATION_ENABLE_AVX2)
+    static bool isVectorized();
+
 private:
-    RoomPairs findDisconnectedRooms(const Model::Model& model) const;
-    void calculatePush(RoomPair rooms, const double* x, double& f, double* grad) const;
+    void buildPairTable(const Model::Model& model, const std::vector<bool>& activeRooms);
+    void addRoomPair(const Model::Room& room1, const Model::Room& room2);
+
+    template <typename Real>
+    void evaluate(const double* x, double& f, double* grad) const;
+    template <typename Real, bool kWithGradient>
+    void evaluateScalar(size_t firstPairId, const double* x, double& f, double* grad) const;
+    /// Vectorized kernels return the number of processed pairs, the tail is left to the scalar kernel. They do nothing
+    /// without AVX2.
+    template <bool kWithGradient>
+    size_t evaluateAVX2(const double* x, double& f, double* grad) const;
+    template <bool kWithGradient>
+    size_t evaluateAVX2Mixed(const double* x, double& f, double* grad) const;
+
+    template <typename Real>
+    const Real* getInvScaledHW() const;
+    template <typename Real>
+    const Real* getInvScaledHH() const;
 
     static constexpr bool kPushOnlyDisconnected = true;  // TODO: maybe should be moved to Settings.h
 
-    const Model::Model& model_;
     const double scale_ = 1.0;  // the maximum value of the function
     const double range_ = 1.0;  // coefficient that determines the range where function is getting halved
-    RoomPairs disconnectedRooms_;
+    const Precision precision_ = Precision::Double;
+
+    // Pairs table. Room variables are laid out as (x, y), so only x ids are stored.
+    // Extents are stored only in the precision that is used.
+    std::pmr::vector<int32_t> pairX1Ids_;
+    std::pmr::vector<int32_t> pairX2Ids_;
+    std::pmr::vector<double> pairInvScaledHW_;  // 1 / (range * sumHalfWidth)
+    std::pmr::vector<double> pairInvScaledHH_;  // 1 / (range * sumHalfHeight)
+    std::pmr::vector<float> pairInvScaledHWFloat_;
+    std::pmr::vector<float> pairInvScaledHHFloat_;
 };
 
 }  // namespace Callbacks
@@ -1,5 +1,6 @@
 #include "RoomOverlap.h"
 
+#include <array>
 #include <cassert>
 #include <cstdlib>
 
@@ -8,8 +9,25 @@
 namespace DungeonGeneration {
 namespace Callbacks {
 
-RoomOverlap::RoomOverlap(const Model::Room& room1, const Model::Room& room2, double roomBloating)
+void addOverlapJacobianRow(
+    void* JEqPtr, int cEqId, Model::VariablesIds room1Ids, Model::VariablesIds room2Ids, double gradX1, double gradY1)
+{
+    // Fixed-size buffers: this is called for every pair of rooms on each evaluation
+    const std::array<PetscInt, 1> rowIndexes{cEqId};
+    const std::array<PetscInt, 4> colIndexes{
+        static_cast<PetscInt>(room1Ids.xId), static_cast<PetscInt>(room1Ids.yId), static_cast<PetscInt>(room2Ids.xId),
+        static_cast<PetscInt>(room2Ids.yId)};
+    const std::array<PetscScalar, 4> values{gradX1, gradY1, -gradX1, -gradY1};
+    Mat JEq = reinterpret_cast<Mat>(JEqPtr);
+    [[maybe_unused]] const bool JEqUpdated =
+        MatSetValues(JEq, 1, rowIndexes.data(), 4, colIndexes.data(), values.data(), ADD_VALUES) == PETSC_SUCCESS;
+    assert(JEqUpdated && "addOverlapJacobianRow: failed to update JEq values");
+}
+
+RoomOverlap::RoomOverlap(
+    const Model::Room& room1, const Model::Room& room2, double roomBloating, Precision precision)
       : roomBloating_(roomBloating),
+        precision_(precision),
         room1_(room1),
         room2_(room2)
 {
@@ -18,12 +36,18 @@ RoomOverlap::RoomOverlap(const Model::Room& room1, const Model::Room& room2, dou
 
 void RoomOverlap::operator()(const double* x, double& f, void* JEqPtr, int cEqId) const
 {
-    Mat JEq = reinterpret_cast<Mat>(JEqPtr);
+    if (precision_ == Precision::Mixed) {
+        evaluate<float>(x, f, JEqPtr, cEqId);
+    } else {
+        evaluate<double>(x, f, JEqPtr, cEqId);
+    }
+}
 
+template <typename Real>
+void RoomOverlap::evaluate(const double* x, double& f, void* JEqPtr, int cEqId) const
+{
     const auto [x1, y1] = room1_.getVariablesVal(x);
     const auto [x2, y2] = room2_.getVariablesVal(x);
-    const auto [x1Id, y1Id] = room1_.getVariablesIds();
-    const auto [x2Id, y2Id] = room2_.getVariablesIds();
 
     const double dx = x1 - x2;
     const double dy = y1 - y2;
@@ -32,7 +56,10 @@ void RoomOverlap::operator()(const double* x, double& f, void* JEqPtr, int cEqId
     sumHalfHeight *= roomBloating_;
     sumHalfWidth *= roomBloating_;
     if (std::abs(dx) >= sumHalfWidth || std::abs(dy) >= sumHalfHeight) {
-        // Rooms do not intersect
+        // Rooms do not intersect. Zero gradient is still written: solver expects the Jacobian sparsity to be fixed.
+        if (JEqPtr != nullptr) {
+            addOverlapJacobianRow(JEqPtr, cEqId, room1_.getVariablesIds(), room2_.getVariablesIds(), 0.0, 0.0);
+        }
         return;
     }
 
@@ -45,30 +72,25 @@ void RoomOverlap::operator()(const double* x, double& f, void* JEqPtr, int cEqId
     gradX2 = -gradX1
     gradY2 = -gradY1
     */
-    const double xRatio = dx / sumHalfWidth;
-    const double fx = xRatio * xRatio - 1;
-    const double fxSquared = fx * fx;
+    // The intersection test above is done in double in both modes, so only the bounded terms lose precision
+    const Real invSumHalfWidth = Real(1) / static_cast<Real>(sumHalfWidth);
+    const Real xRatio = static_cast<Real>(dx) * invSumHalfWidth;
+    const Real fx = xRatio * xRatio - Real(1);
+    const Real fxSquared = fx * fx;
 
-    const double yRatio = dy / sumHalfHeight;
-    const double fy = yRatio * yRatio - 1;
-    const double fySquared = fy * fy;
+    const Real invSumHalfHeight = Real(1) / static_cast<Real>(sumHalfHeight);
+    const Real yRatio = static_cast<Real>(dy) * invSumHalfHeight;
+    const Real fy = yRatio * yRatio - Real(1);
+    const Real fySquared = fy * fy;
 
-    const double fVal = fxSquared * fySquared;
+    const Real fVal = fxSquared * fySquared;
     f += fVal;
     assert(fVal <= 1 && "Room overlap should be in range [0, 1]");
 
     if (JEqPtr != nullptr) {
-        const double gradX1 = 4 * fySquared * fx * dx / (sumHalfWidth * sumHalfWidth);
-        const double gradY1 = 4 * fxSquared * fy * dy / (sumHalfHeight * sumHalfHeight);
-
-        const std::vector<PetscInt> rowIndexes{cEqId};
-        const std::vector<PetscInt> colIndexes{
-            static_cast<PetscInt>(x1Id), static_cast<PetscInt>(y1Id), static_cast<PetscInt>(x2Id),
-            static_cast<PetscInt>(y2Id)};
-        const std::vector<PetscScalar> values{gradX1, gradY1, -gradX1, -gradY1};
-        bool JEqUpdated =
-            MatSetValues(JEq, 1, rowIndexes.data(), 4, colIndexes.data(), values.data(), ADD_VALUES) == PETSC_SUCCESS;
-        assert(JEqUpdated && "RoomOverlap::operator(): failed to update JEq values");
+        const Real gradX1 = Real(4) * fySquared * fx * xRatio * invSumHalfWidth;
+        const Real gradY1 = Real(4) * fxSquared * fy * yRatio * invSumHalfHeight;
+        addOverlapJacobianRow(JEqPtr, cEqId, room1_.getVariablesIds(), room2_.getVariablesIds(), gradX1, gradY1);
     }
 }
 
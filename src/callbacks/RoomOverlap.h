@@ -2,18 +2,31 @@
 
 #include <model/Room.h>
 
+#include "Defs.h"
+
 namespace DungeonGeneration {
 namespace Callbacks {
 
+/// Adds the Jacobian row `cEqId` of an overlap constraint to JEq: (gradX1, gradY1) for room 1 and the opposite for
+/// room 2. Zero rows are written too: solver expects the Jacobian sparsity to be fixed.
+void addOverlapJacobianRow(
+    void* JEqPtr, int cEqId, Model::VariablesIds room1Ids, Model::VariablesIds room2Ids, double gradX1, double gradY1);
+
 class RoomOverlap {
     static constexpr double kNoBloating = 1.0;
 
 public:
-    RoomOverlap(const Model::Room& room1, const Model::Room& room2, const double roomBloating = kNoBloating);
+    RoomOverlap(
+        const Model::Room& room1, const Model::Room& room2, const double roomBloating = kNoBloating,
+        Precision precision = Precision::Double);
     void operator()(const double* x, double& f, void* JEqPtr, int cEqId) const;
 
 private:
+    template <typename Real>
+    void evaluate(const double* x, double& f, void* JEqPtr, int cEqId) const;
+
     const double roomBloating_ = kNoBloating;
+    const Precision precision_ = Precision::Double;
     const Model::Room& room1_;
     const Model::Room& room2_;
 };
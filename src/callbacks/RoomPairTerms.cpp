@@ -0,0 +1,174 @@
+#include "RoomPairTerms.h"
+
+#include <cassert>
+#include <cstdlib>
+
+#include "RoomOverlap.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+RoomPairTerms::RoomPairTerms(
+    const Model::Model& model, const std::vector<std::pair<size_t, size_t>>& overlapPairs, double roomBloating,
+    double pushScale, double pushRange, const std::vector<bool>& activeRooms, Precision precision,
+    std::pmr::memory_resource* resource)
+      : pushScale_(pushScale),
+        pushRange_(pushRange),
+        roomBloating_(roomBloating),
+        precision_(precision),
+        constraintCount_(overlapPairs.size()),
+        pairX1Ids_(resource),
+        pairX2Ids_(resource),
+        pairPushScales_(resource),
+        pairInvScaledHW_(resource),
+        pairInvScaledHH_(resource),
+        pairBloatedHW_(resource),
+        pairBloatedHH_(resource),
+        pairCEqIds_(resource)
+{
+    const Model::Rooms& rooms = model.rooms();
+    const size_t n = rooms.size();
+    assert((activeRooms.empty() || activeRooms.size() == n) && "Invalid active rooms count");
+    // Same pairs as in PushForce: connected rooms aren't pushed
+    std::pmr::vector<bool> areConnected(n * n, false, resource);
+    for (const Model::Corridor& corridor : model.corridors()) {
+        const auto [room1, room2] = model.getCorridorRooms(corridor);
+        areConnected[room1 * n + room2] = true;
+        areConnected[room2 * n + room1] = true;
+    }
+    auto isPushed = [&](size_t room1, size_t room2) {
+        return pushScale_ != 0.0 && !areConnected[room1 * n + room2] &&
+               (activeRooms.empty() || activeRooms[room1] || activeRooms[room2]);
+    };
+
+    // Constrained pairs first, in the order of their constraints, then the pairs that are only pushed
+    std::pmr::vector<bool> areConstrained(n * n, false, resource);
+    for (size_t cEqId = 0; cEqId < overlapPairs.size(); ++cEqId) {
+        const auto [room1, room2] = overlapPairs[cEqId];
+        assert(room1 != room2 && "Don't create overlap function for one room");
+        addPair(rooms[room1], rooms[room2], isPushed(room1, room2), static_cast<int32_t>(cEqId));
+        areConstrained[room1 * n + room2] = true;
+        areConstrained[room2 * n + room1] = true;
+    }
+    if (pushScale_ == 0.0) {
+        return;
+    }
+    for (size_t room1 = 0; room1 + 1 < n; ++room1) {
+        for (size_t room2 = room1 + 1; room2 < n; ++room2) {
+            if (isPushed(room1, room2) && !areConstrained[room1 * n + room2]) {
+                addPair(rooms[room1], rooms[room2], true, kNoConstraint);
+            }
+        }
+    }
+}
+
+void RoomPairTerms::operator()(
+    const double* x, double& f, double* grad, double* cEq, void* JEqPtr, int firstCEqId) const
+{
+    if (precision_ == Precision::Mixed) {
+        evaluate<float>(x, f, grad, cEq, JEqPtr, firstCEqId);
+    } else {
+        evaluate<double>(x, f, grad, cEq, JEqPtr, firstCEqId);
+    }
+}
+
+size_t RoomPairTerms::getConstraintCount() const
+{
+    return constraintCount_;
+}
+
+void RoomPairTerms::addPair(const Model::Room& room1, const Model::Room& room2, bool isPushed, int32_t cEqId)
+{
+    const auto [x1Id, y1Id] = room1.getVariablesIds();
+    const auto [x2Id, y2Id] = room2.getVariablesIds();
+    assert(y1Id == x1Id + 1 && y2Id == x2Id + 1 && "RoomPairTerms: unexpected variables layout");
+
+    const double sumHW = (room1.width() + room2.width()) / 2;
+    const double sumHH = (room1.height() + room2.height()) / 2;
+    pairX1Ids_.push_back(static_cast<int32_t>(x1Id));
+    pairX2Ids_.push_back(static_cast<int32_t>(x2Id));
+    pairPushScales_.push_back(isPushed ? pushScale_ : 0.0);
+    pairInvScaledHW_.push_back(1.0 / (pushRange_ * sumHW));
+    pairInvScaledHH_.push_back(1.0 / (pushRange_ * sumHH));
+    pairBloatedHW_.push_back(sumHW * roomBloating_);
+    pairBloatedHH_.push_back(sumHH * roomBloating_);
+    pairCEqIds_.push_back(cEqId);
+}
+
+/*
+Push force, see PushForce:
+f = scale / (xRatio^2 + yRatio^2 + 1), xRatio = dx / (range * sumHW), yRatio = dy / (range * sumHH)
+Overlap, see RoomOverlap:
+c = fx^2 * fy^2, fx = (dx / sumHalfWidth)^2 - 1, fy = (dy / sumHalfHeight)^2 - 1
+*/
+template <typename Real>
+void RoomPairTerms::evaluate(
+    const double* x, double& f, double* grad, double* cEq, void* JEqPtr, int firstCEqId) const
+{
+    const size_t pairCount = pairX1Ids_.size();
+    for (size_t pairId = 0; pairId < pairCount; ++pairId) {
+        const size_t x1Id = pairX1Ids_[pairId];
+        const size_t x2Id = pairX2Ids_[pairId];
+        // Both terms start from the same differences. They are taken in double in both modes: coordinates may be
+        // large compared to the rooms.
+        const double dx = x[x1Id] - x[x2Id];
+        const double dy = x[x1Id + 1] - x[x2Id + 1];
+
+        const double pushScale = pairPushScales_[pairId];
+        if (pushScale != 0.0) {
+            const Real invScaledHW = static_cast<Real>(pairInvScaledHW_[pairId]);
+            const Real invScaledHH = static_cast<Real>(pairInvScaledHH_[pairId]);
+            const Real xRatio = static_cast<Real>(dx) * invScaledHW;
+            const Real yRatio = static_cast<Real>(dy) * invScaledHH;
+            const Real invDenominator = Real(1) / (xRatio * xRatio + yRatio * yRatio + Real(1));
+            const Real fVal = static_cast<Real>(pushScale) * invDenominator;
+            f += fVal;
+
+            if (grad != nullptr) {
+                const Real gradFactor = Real(-2) * fVal * invDenominator;
+                const Real gradX1 = gradFactor * xRatio * invScaledHW;
+                const Real gradY1 = gradFactor * yRatio * invScaledHH;
+                grad[x1Id] += gradX1;
+                grad[x1Id + 1] += gradY1;
+                grad[x2Id] -= gradX1;
+                grad[x2Id + 1] -= gradY1;
+            }
+        }
+
+        const int32_t pairCEqId = pairCEqIds_[pairId];
+        if (pairCEqId == kNoConstraint) {
+            continue;
+        }
+        const int cEqId = firstCEqId + pairCEqId;
+        const Model::VariablesIds room1Ids{x1Id, x1Id + 1};
+        const Model::VariablesIds room2Ids{x2Id, x2Id + 1};
+        const double sumHalfWidth = pairBloatedHW_[pairId];
+        const double sumHalfHeight = pairBloatedHH_[pairId];
+        if (std::abs(dx) >= sumHalfWidth || std::abs(dy) >= sumHalfHeight) {
+            if (JEqPtr != nullptr) {
+                addOverlapJacobianRow(JEqPtr, cEqId, room1Ids, room2Ids, 0.0, 0.0);
+            }
+            continue;
+        }
+
+        const Real invSumHalfWidth = Real(1) / static_cast<Real>(sumHalfWidth);
+        const Real xRatio = static_cast<Real>(dx) * invSumHalfWidth;
+        const Real fx = xRatio * xRatio - Real(1);
+        const Real fxSquared = fx * fx;
+
+        const Real invSumHalfHeight = Real(1) / static_cast<Real>(sumHalfHeight);
+        const Real yRatio = static_cast<Real>(dy) * invSumHalfHeight;
+        const Real fy = yRatio * yRatio - Real(1);
+        const Real fySquared = fy * fy;
+
+        cEq[cEqId] += fxSquared * fySquared;
+        if (JEqPtr != nullptr) {
+            const Real gradX1 = Real(4) * fySquared * fx * xRatio * invSumHalfWidth;
+            const Real gradY1 = Real(4) * fxSquared * fy * yRatio * invSumHalfHeight;
+            addOverlapJacobianRow(JEqPtr, cEqId, room1Ids, room2Ids, gradX1, gradY1);
+        }
+    }
+}
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include <model/Model.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Push force (cost) and room overlaps (constraints) evaluated in a single pass over one table of room pairs, see
+/// FusedEval. Both terms need the same coordinate differences, so each pair loads its rooms' variables once. Values
+/// are the same as the ones of PushForce and RoomOverlap.
+class RoomPairTerms {
+public:
+    /// Overlap of `overlapPairs[k]` is constraint k (plus the first constraint id passed to the call). Pushed pairs are
+    /// the ones of PushForce with the same `activeRooms`; push force is off if `pushScale` is 0.
+    /// Pairs table is allocated in `resource`.
+    RoomPairTerms(
+        const Model::Model& model, const std::vector<std::pair<size_t, size_t>>& overlapPairs, double roomBloating,
+        double pushScale, double pushRange, const std::vector<bool>& activeRooms = {},
+        Precision precision = Precision::Double,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    /// `grad` and `JEqPtr` may be null
+    void operator()(const double* x, double& f, double* grad, double* cEq, void* JEqPtr, int firstCEqId) const;
+
+    size_t getConstraintCount() const;
+
+private:
+    static constexpr int32_t kNoConstraint = -1;
+
+    void addPair(const Model::Room& room1, const Model::Room& room2, bool isPushed, int32_t cEqId);
+
+    template <typename Real>
+    void evaluate(const double* x, double& f, double* grad, double* cEq, void* JEqPtr, int firstCEqId) const;
+
+    const double pushScale_ = 0.0;
+    const double pushRange_ = 1.0;
+    const double roomBloating_ = 1.0;
+    const Precision precision_ = Precision::Double;
+    size_t constraintCount_ = 0;
+
+    // Pairs table. Room variables are laid out as (x, y), so only x ids are stored.
+    std::pmr::vector<int32_t> pairX1Ids_;
+    std::pmr::vector<int32_t> pairX2Ids_;
+    std::pmr::vector<double> pairPushScales_;   // pushScale, or 0 if the pair isn't pushed
+    std::pmr::vector<double> pairInvScaledHW_;  // 1 / (range * sumHalfWidth)
+    std::pmr::vector<double> pairInvScaledHH_;  // 1 / (range * sumHalfHeight)
+    std::pmr::vector<double> pairBloatedHW_;    // roomBloating * sumHalfWidth
+    std::pmr::vector<double> pairBloatedHH_;    // roomBloating * sumHalfHeight
+    std::pmr::vector<int32_t> pairCEqIds_;      // Overlap constraint id, or kNoConstraint
+};
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -5,8 +5,9 @@
 namespace DungeonGeneration {
 namespace Callbacks {
 
-RoomShaker::RoomShaker(const Model::Model& model)
-      : model_(model)
+RoomShaker::RoomShaker(const Model::Model& model, uint64_t seed)
+      : model_(model),
+        rng_(Random::RNG(seed).split(Random::Streams::kRoomShaking))
 {}
 
 void RoomShaker::operator()(double* x)
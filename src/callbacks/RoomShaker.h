@@ -8,12 +8,13 @@ namespace Callbacks {
 
 class RoomShaker {
 public:
-    RoomShaker(const Model::Model& model);
+    /// Shifts come from the room shaking stream of `seed`
+    RoomShaker(const Model::Model& model, uint64_t seed = Random::kGlobalSeed);
     void operator()(double* x);
 
 private:
     const Model::Model& model_;
-    Random::RNG rng_ = Random::RNG(Random::kGlobalSeed);  // random number generator
+    Random::RNG rng_;  // random number generator
 };
 
 }  // namespace Callbacks
@@ -17,16 +17,7 @@ void SVGDumper::operator()(const double* x, int runNum, int iterNum)
 
     // Note that we DO change model_ in here by resetting stored rooms' positions.
     // Idea is, that these positions don't mean anything while solver runs, and are resetted at the solving end.
-
-    // TODO: reuse code from AnalyticalSolver::retrieveSolution
-    const size_t objectCount = model_.getObjectCount();
-    Model::Positions positions(objectCount);
-    for (size_t objId = 0; objId < objectCount; ++objId) {
-        const auto [xId, yId] = Model::VarUtils::getVariablesIds(objId);
-        positions[objId].x = x[xId];
-        positions[objId].y = x[yId];
-    }
-    model_.setPositions(positions);
+    model_.setPositionsFromVars(x);
     const std::string filename = filenamePrefix_ + "_" + std::to_string(runNum) + "_" + std::to_string(iterNum);
     model_.dumpToSVG(pathToSVG_ / (filename + ".svg"));
 }
@@ -0,0 +1,270 @@
+#include "Trajectory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+#include <model/Serialization.h>
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x52544744;  // "DGTR"
+constexpr uint32_t kVersion = 1;
+constexpr uint8_t kKeyframeFlag = 1;
+constexpr double kMaxQuantizedValue = 1e15;  // Keeps zigzag tokens far from overflowing
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    double quantizationStep;
+    uint64_t variablesCount;
+    uint64_t modelSize;  // Serialized model follows the header
+};
+
+uint64_t zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+void appendVarint(std::vector<uint8_t>& buffer, uint64_t value)
+{
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+/// Returns false on a truncated or too long varint
+bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value)
+{
+    value = 0;
+    for (size_t shift = 0; shift < 64; shift += 7) {
+        if (data == end) {
+            return false;
+        }
+        const uint8_t byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+TrajectoryRecorder::TrajectoryRecorder(Model::Model& model, const std::filesystem::path& path, double quantizationStep)
+      : model_(model),
+        path_(path),
+        ofstream_(path, std::ios::binary),
+        quantizationStep_(quantizationStep)
+{
+    assert(quantizationStep_ > 0 && "TrajectoryRecorder: quantization step must be positive");
+    if (!ofstream_) {
+        std::cerr << "(!) TrajectoryRecorder::TrajectoryRecorder: can't open " << path_ << "\n";
+    }
+}
+
+void TrajectoryRecorder::operator()(const double* x, int runNum, int iterNum)
+{
+    assert(x && "TrajectoryRecorder::operator(): Null variables array");
+    if (!ofstream_) {
+        return;
+    }
+    if (frameCount_ == 0) {
+        writeHeader(x);
+    }
+
+    const bool isKeyframe = (frameCount_ % Trajectory::kKeyframeInterval == 0);
+    if (isKeyframe) {
+        std::fill(prevQuantizedX_.begin(), prevQuantizedX_.end(), 0);
+    }
+
+    // Runs of unchanged variables are written as (run << 1) | 1, changes as zigzag(delta) << 1.
+    // A trailing run is omitted.
+    frameBuffer_.clear();
+    size_t unchangedCount = 0;
+    for (size_t varId = 0; varId < prevQuantizedX_.size(); ++varId) {
+        // Non-finite values keep the previous position, there is nothing to draw for them anyway
+        int64_t quantized = prevQuantizedX_[varId];
+        if (std::isfinite(x[varId])) {
+            const double scaled = std::clamp(x[varId] / quantizationStep_, -kMaxQuantizedValue, kMaxQuantizedValue);
+            quantized = std::llround(scaled);
+        }
+        const int64_t delta = quantized - prevQuantizedX_[varId];
+        if (delta == 0) {
+            ++unchangedCount;
+            continue;
+        }
+        if (unchangedCount > 0) {
+            appendVarint(frameBuffer_, (static_cast<uint64_t>(unchangedCount) << 1) | 1);
+            unchangedCount = 0;
+        }
+        appendVarint(frameBuffer_, zigzagEncode(delta) << 1);
+        prevQuantizedX_[varId] = quantized;
+    }
+
+    std::vector<uint8_t> frameHeader;
+    appendVarint(frameHeader, zigzagEncode(runNum));
+    appendVarint(frameHeader, zigzagEncode(iterNum));
+    frameHeader.push_back(isKeyframe ? kKeyframeFlag : 0);
+    appendVarint(frameHeader, frameBuffer_.size());
+    ofstream_.write(reinterpret_cast<const char*>(frameHeader.data()), frameHeader.size());
+    ofstream_.write(reinterpret_cast<const char*>(frameBuffer_.data()), frameBuffer_.size());
+    // Frames written before a crash stay readable
+    ofstream_.flush();
+    if (!ofstream_) {
+        std::cerr << "(!) TrajectoryRecorder::operator(): can't write " << path_ << "\n";
+        return;
+    }
+    ++frameCount_;
+}
+
+size_t TrajectoryRecorder::getFrameCount() const
+{
+    return frameCount_;
+}
+
+void TrajectoryRecorder::writeHeader(const double* x)
+{
+    // Note that model_ positions are changed, like in SVGDumper: they don't mean anything while solver runs
+    model_.setPositionsFromVars(x);
+    const std::vector<uint8_t> serializedModel = Model::Serialization::serialize(model_);
+    const Header header{
+        .magic = kMagic,
+        .version = kVersion,
+        .quantizationStep = quantizationStep_,
+        .variablesCount = model_.getVariablesCount(),
+        .modelSize = serializedModel.size()};
+    ofstream_.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    ofstream_.write(reinterpret_cast<const char*>(serializedModel.data()), serializedModel.size());
+    prevQuantizedX_.assign(model_.getVariablesCount(), 0);
+}
+
+std::optional<TrajectoryReader> TrajectoryReader::open(const std::filesystem::path& path)
+{
+    std::ifstream ifstream(path, std::ios::binary);
+    if (!ifstream) {
+        std::cerr << "(!) TrajectoryReader::open: can't open " << path << "\n";
+        return std::nullopt;
+    }
+    TrajectoryReader reader;
+    reader.data_.assign(std::istreambuf_iterator<char>(ifstream), std::istreambuf_iterator<char>());
+
+    Header header;
+    if (reader.data_.size() < sizeof(Header)) {
+        std::cerr << "(!) TrajectoryReader::open: file is too short\n";
+        return std::nullopt;
+    }
+    std::memcpy(&header, reader.data_.data(), sizeof(Header));
+    if (header.magic != kMagic || header.version != kVersion || !(header.quantizationStep > 0) ||
+        header.modelSize > reader.data_.size() - sizeof(Header)) {
+        std::cerr << "(!) TrajectoryReader::open: invalid header\n";
+        return std::nullopt;
+    }
+    std::optional<Model::Model> model =
+        Model::Serialization::deserialize(reader.data_.data() + sizeof(Header), header.modelSize);
+    if (!model.has_value() || model->getVariablesCount() != header.variablesCount) {
+        std::cerr << "(!) TrajectoryReader::open: invalid model\n";
+        return std::nullopt;
+    }
+    reader.model_ = std::move(model.value());
+    reader.quantizationStep_ = header.quantizationStep;
+    reader.variablesCount_ = header.variablesCount;
+
+    // Index frames. A truncated last frame (the solver was interrupted) is dropped.
+    const uint8_t* data = reader.data_.data() + sizeof(Header) + header.modelSize;
+    const uint8_t* end = reader.data_.data() + reader.data_.size();
+    while (data != end) {
+        uint64_t runNum, iterNum, payloadSize;
+        if (!readVarint(data, end, runNum) || !readVarint(data, end, iterNum) || data == end) {
+            std::cerr << "(!) TrajectoryReader::open: truncated frame " << reader.frames_.size() << "\n";
+            break;
+        }
+        const bool isKeyframe = (*data++ & kKeyframeFlag) != 0;
+        if (!readVarint(data, end, payloadSize) || payloadSize > static_cast<uint64_t>(end - data)) {
+            std::cerr << "(!) TrajectoryReader::open: truncated frame " << reader.frames_.size() << "\n";
+            break;
+        }
+        if (reader.frames_.empty() && !isKeyframe) {
+            std::cerr << "(!) TrajectoryReader::open: the first frame must be a keyframe\n";
+            return std::nullopt;
+        }
+        const size_t frameId = reader.frames_.size();
+        reader.frames_.push_back(Trajectory::FrameInfo{
+            .runNum = static_cast<int>(zigzagDecode(runNum)), .iterNum = static_cast<int>(zigzagDecode(iterNum))});
+        reader.frameOffsets_.push_back(data - reader.data_.data());
+        reader.frameSizes_.push_back(payloadSize);
+        reader.keyframeIds_.push_back(isKeyframe ? frameId : reader.keyframeIds_.back());
+        data += payloadSize;
+    }
+    return reader;
+}
+
+const std::vector<Trajectory::FrameInfo>& TrajectoryReader::getFrames() const
+{
+    return frames_;
+}
+
+const Model::Model& TrajectoryReader::getModel() const
+{
+    return model_;
+}
+
+std::optional<std::vector<double>> TrajectoryReader::getFrameVariables(size_t frameId) const
+{
+    assert(frameId < frames_.size() && "TrajectoryReader::getFrameVariables: invalid frame id");
+    std::vector<int64_t> quantizedX(variablesCount_, 0);
+    for (size_t decodedId = keyframeIds_[frameId]; decodedId <= frameId; ++decodedId) {
+        if (!decodeFrame(decodedId, quantizedX)) {
+            std::cerr << "(!) TrajectoryReader::getFrameVariables: frame " << decodedId << " is corrupted\n";
+            return std::nullopt;
+        }
+    }
+    std::vector<double> result(variablesCount_);
+    for (size_t varId = 0; varId < variablesCount_; ++varId) {
+        result[varId] = static_cast<double>(quantizedX[varId]) * quantizationStep_;
+    }
+    return result;
+}
+
+bool TrajectoryReader::decodeFrame(size_t frameId, std::vector<int64_t>& quantizedX) const
+{
+    const uint8_t* data = data_.data() + frameOffsets_[frameId];
+    const uint8_t* end = data + frameSizes_[frameId];
+    size_t varId = 0;
+    while (data != end) {
+        uint64_t token;
+        if (!readVarint(data, end, token)) {
+            return false;
+        }
+        if ((token & 1) != 0) {
+            const uint64_t unchangedCount = token >> 1;
+            if (unchangedCount > variablesCount_ - varId) {
+                return false;
+            }
+            varId += unchangedCount;
+            continue;
+        }
+        if (varId == variablesCount_) {
+            return false;
+        }
+        quantizedX[varId++] += zigzagDecode(token >> 1);
+    }
+    return true;
+}
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include <model/Model.h>
+
+namespace DungeonGeneration {
+namespace Callbacks {
+
+/// Solver trajectory file: the model, as it is at the first recorded iteration, followed by a frame per iteration.
+/// Frames store variables quantized to a fixed step, as differences from the previous frame: zigzag varints, with runs
+/// of unchanged variables collapsed into a single token. Every `kKeyframeInterval`-th frame stores full values, so that
+/// any frame is decoded from at most that many frames.
+namespace Trajectory {
+
+constexpr double kDefaultQuantizationStep = 1.0 / 64;
+constexpr size_t kKeyframeInterval = 64;
+
+struct FrameInfo {
+    int runNum;
+    int iterNum;
+};
+
+}  // namespace Trajectory
+
+/// Reader callback that appends solver iterations to a trajectory file. Replacement for SVGDumper when there are many
+/// iterations or big maps: a frame costs a few bytes per moving variable instead of a whole SVG.
+class TrajectoryRecorder {
+public:
+    TrajectoryRecorder(
+        Model::Model& model, const std::filesystem::path& path,
+        double quantizationStep = Trajectory::kDefaultQuantizationStep);
+    void operator()(const double* x, int runNum, int iterNum);
+
+    size_t getFrameCount() const;
+
+private:
+    void writeHeader(const double* x);
+
+    Model::Model& model_;
+    std::filesystem::path path_;
+    std::ofstream ofstream_;
+    double quantizationStep_;
+    size_t frameCount_ = 0;
+    std::vector<int64_t> prevQuantizedX_;
+    std::vector<uint8_t> frameBuffer_;
+};
+
+/// Loads a whole trajectory file and decodes frames on demand
+class TrajectoryReader {
+public:
+    /// Returns nullopt if the file can't be read or isn't a valid trajectory
+    static std::optional<TrajectoryReader> open(const std::filesystem::path& path);
+
+    const std::vector<Trajectory::FrameInfo>& getFrames() const;
+    /// Positions are those of the first frame
+    const Model::Model& getModel() const;
+    /// Returns nullopt if the frame is corrupted
+    std::optional<std::vector<double>> getFrameVariables(size_t frameId) const;
+
+private:
+    TrajectoryReader() = default;
+
+    /// Applies the frame's differences to `quantizedX`
+    bool decodeFrame(size_t frameId, std::vector<int64_t>& quantizedX) const;
+
+    std::vector<uint8_t> data_;
+    Model::Model model_;
+    double quantizationStep_;
+    size_t variablesCount_;
+    std::vector<Trajectory::FrameInfo> frames_;
+    std::vector<size_t> frameOffsets_;  // Offsets of frame payloads in data_
+    std::vector<size_t> frameSizes_;
+    std::vector<size_t> keyframeIds_;  // Nearest keyframe at or before each frame
+};
+
+}  // namespace Callbacks
+}  // namespace DungeonGeneration
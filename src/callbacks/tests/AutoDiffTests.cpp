@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <callbacks/AutoDiffTerms.h>
+#include <callbacks/CorridorLength.h>
+#include <callbacks/DerivativeCheck.h>
+#include <callbacks/PushForce.h>
+#include <callbacks/RoomOverlap.h>
+#include <test-utils/TestUtils.h>
+#include <utils/Random.h>
+
+#include "Common.h"
+
+using namespace DungeonGeneration;
+
+namespace {
+
+/// Rooms connected into a chain by movable doors, with random variables
+Model::Model createChainModel(size_t roomCount, double roomRange, std::vector<double>& x)
+{
+    Random::RNG rng(42);
+    Model::Model model = TestUtils::createRandomModel(
+        roomCount, TestUtils::Connectivity::Chain, TestUtils::DoorKinds::Movable, rng);
+    x = TestUtils::createRandomVariables(model, roomRange, 100.0, rng);
+    return model;
+}
+
+void expectSameEvaluation(const Callbacks::FGEval& expected, const Callbacks::FGEval& actual, const double* x, size_t n)
+{
+    constexpr double tolerance = 1e-9;
+    double fExpected = 0.0, fActual = 0.0;
+    std::vector<double> gradExpected(n, 0.0), gradActual(n, 0.0);
+    expected(x, fExpected, gradExpected.data());
+    actual(x, fActual, gradActual.data());
+    EXPECT_NEAR(fActual, fExpected, tolerance * std::abs(fExpected));
+    for (size_t i = 0; i < n; ++i) {
+        EXPECT_NEAR(gradActual[i], gradExpected[i], tolerance * (1.0 + std::abs(gradExpected[i])))
+            << "Gradient mismatch at " << i;
+    }
+}
+
+}  // namespace
+
+TEST(AutoDiffTests, DualArithmeticTest)
+{
+    using Dual = Callbacks::AutoDiff::Dual<2>;
+    constexpr double tolerance = 1e-12;
+    const double x = 1.5, y = -0.5;
+    const Dual xDual = Dual::variable(x, 0);
+    const Dual yDual = Dual::variable(y, 1);
+
+    // f = x * y / (x + 1) + sqrt(x) * exp(y) - log(x) / y
+    const Dual f = xDual * yDual / (xDual + 1.0) + Callbacks::AutoDiff::sqrt(xDual) * Callbacks::AutoDiff::exp(yDual) -
+                   Callbacks::AutoDiff::log(xDual) / yDual;
+    EXPECT_NEAR(f.value, x * y / (x + 1) + std::sqrt(x) * std::exp(y) - std::log(x) / y, tolerance);
+    const double dfdx = y / ((x + 1) * (x + 1)) + std::exp(y) / (2 * std::sqrt(x)) - 1 / (x * y);
+    const double dfdy = x / (x + 1) + std::sqrt(x) * std::exp(y) + std::log(x) / (y * y);
+    EXPECT_NEAR(f.derivatives[0], dfdx, tolerance);
+    EXPECT_NEAR(f.derivatives[1], dfdy, tolerance);
+}
+
+TEST(AutoDiffTests, MatchesHandWrittenKernelsTest)
+{
+    std::vector<double> x;
+    const Model::Model model = createChainModel(200, 100.0, x);
+
+    // PushForce pushes only rooms that aren't connected by a corridor
+    const double scale = 2.5, range = 1.5;
+    std::vector<Callbacks::AutoDiffTerms::PushForceTerm> pushTerms;
+    for (size_t i = 0; i < model.rooms().size(); ++i) {
+        for (size_t j = i + 2; j < model.rooms().size(); ++j) {
+            pushTerms.push_back(
+                Callbacks::AutoDiffTerms::PushForceTerm::create(model.rooms()[i], model.rooms()[j], scale, range));
+        }
+    }
+    const Callbacks::PushForce pushForce(model, scale, range);
+    const Callbacks::AutoDiffCost<Callbacks::AutoDiffTerms::PushForceTerm> pushForceAD(std::move(pushTerms));
+    expectSameEvaluation(pushForce, pushForceAD, x.data(), x.size());
+
+    std::vector<Callbacks::AutoDiffTerms::CorridorLengthTerm> corridorTerms;
+    for (const Model::Corridor& corridor : model.corridors()) {
+        corridorTerms.push_back(Callbacks::AutoDiffTerms::CorridorLengthTerm::create(
+            model.doors()[corridor.door1Id], model.doors()[corridor.door2Id]));
+    }
+    const Callbacks::CorridorLength corridorLength(model);
+    const Callbacks::AutoDiffCost<Callbacks::AutoDiffTerms::CorridorLengthTerm> corridorLengthAD(
+        std::move(corridorTerms));
+    expectSameEvaluation(corridorLength, corridorLengthAD, x.data(), x.size());
+}
+
+TEST(AutoDiffTests, BranchingTermGradientTest)
+{
+    // Rooms are packed densely, so that both branches of RoomOverlapTerm are taken
+    std::vector<double> x;
+    const Model::Model model = createChainModel(300, 50.0, x);
+    std::vector<Callbacks::AutoDiffTerms::RoomOverlapTerm> terms;
+    for (size_t i = 0; i < model.rooms().size(); ++i) {
+        for (size_t j = i + 1; j < model.rooms().size(); ++j) {
+            terms.push_back(Callbacks::AutoDiffTerms::RoomOverlapTerm::create(model.rooms()[i], model.rooms()[j]));
+        }
+    }
+    const Callbacks::AutoDiffCost<Callbacks::AutoDiffTerms::RoomOverlapTerm> overlaps(std::move(terms));
+    double f = 0.0;
+    overlaps(x.data(), f, nullptr);
+    ASSERT_GT(f, 0.0);
+    const Callbacks::DerivativeCheck::Result result = Callbacks::DerivativeCheck::checkGradient(overlaps, x);
+    EXPECT_EQ(result.failedCount, 0u) << "Max error: " << result.maxError;
+}
+
+TEST(AutoDiffTests, PenaltyJacobianTest)
+{
+    // Rooms packed densely enough that many pairs overlap
+    std::vector<double> x;
+    const Model::Model model = createChainModel(100, 100.0, x);
+    std::vector<Callbacks::AutoDiffPenalty<Callbacks::AutoDiffTerms::RoomOverlapTerm>> penaltiesAD;
+    std::vector<Callbacks::RoomOverlap> overlaps;
+    for (size_t i = 0; i < model.rooms().size(); ++i) {
+        for (size_t j = i + 1; j < model.rooms().size(); ++j) {
+            penaltiesAD.emplace_back(
+                Callbacks::AutoDiffTerms::RoomOverlapTerm::create(model.rooms()[i], model.rooms()[j]));
+            overlaps.emplace_back(model.rooms()[i], model.rooms()[j]);
+        }
+    }
+    const std::vector<Callbacks::CEqFGEval> penalties(penaltiesAD.begin(), penaltiesAD.end());
+    const Callbacks::DerivativeCheck::SparseMatrix jacobian = assembleJacobian(penalties, x);
+    ASSERT_TRUE(std::any_of(jacobian.values.begin(), jacobian.values.end(), [](double v) { return v != 0.0; }));
+    const Callbacks::DerivativeCheck::Result result =
+        Callbacks::DerivativeCheck::checkJacobian(makePenaltiesEval(penalties), jacobian, x);
+    EXPECT_GT(result.checkedCount, 0u);
+    EXPECT_EQ(result.failedCount, 0u) << "Max error: " << result.maxError;
+
+    // Rows are the same as the ones of the hand-written callback, zeros included
+    const std::vector<Callbacks::CEqFGEval> handWrittenPenalties(overlaps.begin(), overlaps.end());
+    const Callbacks::DerivativeCheck::SparseMatrix handWrittenJacobian = assembleJacobian(handWrittenPenalties, x);
+    ASSERT_EQ(jacobian.rowOffsets, handWrittenJacobian.rowOffsets);
+    EXPECT_EQ(jacobian.columns, handWrittenJacobian.columns);
+    for (size_t entryId = 0; entryId < jacobian.values.size(); ++entryId) {
+        EXPECT_NEAR(jacobian.values[entryId], handWrittenJacobian.values[entryId], 1e-9) << "Entry " << entryId;
+    }
+}
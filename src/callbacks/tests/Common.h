@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <callbacks/Defs.h>
+#include <callbacks/DerivativeCheck.h>
+#include <petsc.h>
 
 using namespace DungeonGeneration;
 
@@ -20,3 +22,44 @@ inline void checkGradientCorrectness(Callbacks::FGEval func, std::vector<double>
         x[i] -= dx;
     }
 }
+
+/// Jacobian of `penalties` at `x`, assembled into a PETSc matrix the way the solver does it and converted to compressed
+/// rows
+inline Callbacks::DerivativeCheck::SparseMatrix assembleJacobian(
+    const std::vector<Callbacks::CEqFGEval>& penalties, const std::vector<double>& x)
+{
+    PetscInitializeNoArguments();
+    Mat JEq;
+    MatCreateSeqAIJ(PETSC_COMM_SELF, penalties.size(), x.size(), 4, nullptr, &JEq);
+    for (size_t cEqId = 0; cEqId < penalties.size(); ++cEqId) {
+        double value = 0.0;
+        penalties[cEqId](x.data(), value, JEq, static_cast<int>(cEqId));
+    }
+    MatAssemblyBegin(JEq, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(JEq, MAT_FINAL_ASSEMBLY);
+    Callbacks::DerivativeCheck::SparseMatrix jacobian;
+    jacobian.rowOffsets.push_back(0);
+    for (size_t row = 0; row < penalties.size(); ++row) {
+        PetscInt colCount;
+        const PetscInt* columns;
+        const PetscScalar* values;
+        MatGetRow(JEq, row, &colCount, &columns, &values);
+        jacobian.columns.insert(jacobian.columns.end(), columns, columns + colCount);
+        jacobian.values.insert(jacobian.values.end(), values, values + colCount);
+        jacobian.rowOffsets.push_back(jacobian.columns.size());
+        MatRestoreRow(JEq, row, &colCount, &columns, &values);
+    }
+    MatDestroy(&JEq);
+    return jacobian;
+}
+
+/// Values of all `penalties`, for DerivativeCheck::checkJacobian
+inline Callbacks::DerivativeCheck::VectorEval makePenaltiesEval(const std::vector<Callbacks::CEqFGEval>& penalties)
+{
+    return [&penalties](const double* x, double* values) {
+        for (size_t cEqId = 0; cEqId < penalties.size(); ++cEqId) {
+            values[cEqId] = 0.0;
+            penalties[cEqId](x, values[cEqId], nullptr, static_cast<int>(cEqId));
+        }
+    };
+}
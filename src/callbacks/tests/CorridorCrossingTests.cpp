@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <callbacks/CorridorCrossing.h>
+#include <test-utils/TestUtils.h>
+#include <utils/Random.h>
+
+#include "Common.h"
+
+using namespace DungeonGeneration;
+
+TEST(CallbacksTests, CorridorCrossingTest)
+{
+    // Corridors 0-1 and 2-3 between centers of the rooms, room 4 is in the middle
+    Model::Rooms rooms;
+    for (size_t roomId = 0; roomId < 5; ++roomId) {
+        rooms.emplace_back(roomId, 10, 10);
+    }
+    Model::Doors doors;
+    for (size_t roomId = 0; roomId < 4; ++roomId) {
+        doors.push_back(Model::Door::createFixedDoor(roomId, {0, 0}));
+    }
+    Model::Corridors corridors{
+        {.door1Id = 0, .door2Id = 1},
+        {.door1Id = 2, .door2Id = 3}
+    };
+    const Model::Model model(std::move(rooms), std::move(doors), std::move(corridors));
+    Callbacks::CorridorCrossing corridorCrossing(model, 1.0, 5.0);
+
+    // X-shaped layout: corridors cross each other and room 4
+    std::vector<double> x{-50, -50, 50, 50, -50, 50, 50, -50, 0, 0};
+    double f = 0.0;
+    corridorCrossing(x.data(), f, nullptr);
+    EXPECT_EQ(f, 0.0) << "No candidates before the first update";
+
+    corridorCrossing.updateCandidates(x.data());
+    EXPECT_EQ(corridorCrossing.getCorridorPairCount(), 1u);
+    // Boxes of the diagonal corridors contain all rooms except their own ones
+    EXPECT_EQ(corridorCrossing.getCorridorRoomPairCount(), 6u);
+    corridorCrossing(x.data(), f, nullptr);
+    // Corridors bisect each other and pass through the room center: both terms are at their maximum
+    EXPECT_NEAR(f, 3.0, 1e-9);
+    x[9] = 3.0;
+    checkGradientCorrectness(corridorCrossing, x);
+
+    // Parallel corridors, room 4 is far away
+    x = {-50, -50, 50, -50, -50, 50, 50, 50, 0, 200};
+    corridorCrossing.updateCandidates(x.data());
+    f = 0.0;
+    corridorCrossing(x.data(), f, nullptr);
+    EXPECT_EQ(f, 0.0);
+}
+
+TEST(CallbacksTests, CorridorCrossingCandidatesTest)
+{
+    // Broad phase must find the same pairs as the brute force check of boxes
+    constexpr size_t kRoomCount = 300;
+    constexpr double kMargin = 5.0;
+    Random::RNG rng(42);
+    const Model::Model model =
+        TestUtils::createRandomModel(kRoomCount, TestUtils::Connectivity::RandomTree, TestUtils::DoorKinds::Mixed, rng);
+    const std::vector<double> x = TestUtils::createRandomVariables(model, 300.0, 5.0, rng);
+    Callbacks::CorridorCrossing corridorCrossing(model, 1.0, kMargin);
+    corridorCrossing.updateCandidates(x.data());
+
+    struct Box {
+        double minX, minY, maxX, maxY;
+    };
+    auto intersects = [](const Box& a, const Box& b) {
+        return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+    };
+    std::vector<Box> corridorBoxes;
+    for (const Model::Corridor& corridor : model.corridors()) {
+        const Model::Position a = model.doors()[corridor.door1Id].getCenterPositionFromVars(x.data());
+        const Model::Position b = model.doors()[corridor.door2Id].getCenterPositionFromVars(x.data());
+        corridorBoxes.push_back(Box{
+            std::min(a.x, b.x) - kMargin, std::min(a.y, b.y) - kMargin, std::max(a.x, b.x) + kMargin,
+            std::max(a.y, b.y) + kMargin});
+    }
+    size_t corridorPairCount = 0;
+    size_t corridorRoomPairCount = 0;
+    for (size_t i = 0; i < corridorBoxes.size(); ++i) {
+        for (size_t j = i + 1; j < corridorBoxes.size(); ++j) {
+            corridorPairCount += intersects(corridorBoxes[i], corridorBoxes[j]);
+        }
+        const Model::Corridor& corridor = model.corridors()[i];
+        for (const Model::Room& room : model.rooms()) {
+            const auto [roomX, roomY] = room.getVariablesVal(x.data());
+            const Box roomBox{
+                roomX - room.width() / 2 - kMargin, roomY - room.height() / 2 - kMargin,
+                roomX + room.width() / 2 + kMargin, roomY + room.height() / 2 + kMargin};
+            const bool isOwnRoom = room.id() == model.doors()[corridor.door1Id].parentRoomId() ||
+                                   room.id() == model.doors()[corridor.door2Id].parentRoomId();
+            corridorRoomPairCount += !isOwnRoom && intersects(corridorBoxes[i], roomBox);
+        }
+    }
+    EXPECT_GT(corridorPairCount, 0u);
+    EXPECT_EQ(corridorCrossing.getCorridorPairCount(), corridorPairCount);
+    EXPECT_EQ(corridorCrossing.getCorridorRoomPairCount(), corridorRoomPairCount);
+}
@@ -26,3 +26,42 @@ TEST(CallbacksTests, CorridorLengthGradientTest)
         checkGradientCorrectness(corridorLength, x);
     }
 }
+
+TEST(CallbacksTests, CorridorLengthDoorKindsTest)
+{
+    // Each corridor kind is evaluated by its own kernel, check all of them (including movable-fixed order)
+    Model::Room room1(0, 10, 10, {});
+    Model::Room room2(1, 20, 20, {});
+    Model::Door fixedDoor1 = Model::Door::createFixedDoor(0, {5, 0});
+    Model::Door fixedDoor2 = Model::Door::createFixedDoor(1, {0, -10});
+    Model::Door movableDoor1 = Model::Door::createMovableDoor(0, 2);
+    Model::Door movableDoor2 = Model::Door::createMovableDoor(1, 3);
+    const std::vector<std::pair<const Model::Door&, const Model::Door&>> doorPairs{
+        {  fixedDoor1,   fixedDoor2},
+        {  fixedDoor1, movableDoor2},
+        {movableDoor1,   fixedDoor2},
+        {movableDoor1, movableDoor2},
+    };
+
+    Random::RNG rng(42);
+    for (const auto& [door1, door2] : doorPairs) {
+        Callbacks::CorridorLength corridorLength(door1, door2);
+        for (size_t it = 0; it < 1000; ++it) {
+            std::vector<double> x(8, 0.0);
+            for (size_t i = 0; i < x.size(); ++i) {
+                x[i] = Random::uniformRangeContinuous(-50.0, 50.0, rng);
+            }
+
+            // Compare with the direct formula
+            const Model::Position pos1 = door1.getCenterPositionFromVars(x.data());
+            const Model::Position pos2 = door2.getCenterPositionFromVars(x.data());
+            const double dx = pos1.x - pos2.x;
+            const double dy = pos1.y - pos2.y;
+            double val = 0.0;
+            corridorLength(x.data(), val, nullptr);
+            EXPECT_NEAR(val, dx * dx + dy * dy, 1e-9) << "Incorrect corridor length";
+
+            checkGradientCorrectness(corridorLength, x);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include <callbacks/CorridorCrossing.h>
+#include <callbacks/CorridorLength.h>
+#include <callbacks/DerivativeCheck.h>
+#include <callbacks/PushForce.h>
+#include <callbacks/RoomOverlap.h>
+#include <test-utils/TestUtils.h>
+#include <utils/Random.h>
+
+#include "Common.h"
+
+using namespace DungeonGeneration;
+
+namespace {
+
+constexpr size_t kRoomCount = 2000;
+
+/// Random model with rooms scattered densely enough to overlap, and corridors of every door kind. Variables are
+/// returned in `x`.
+Model::Model createRandomModel(size_t roomCount, std::vector<double>& x)
+{
+    Random::RNG rng(42);
+    Model::Model model = TestUtils::createRandomModel(
+        roomCount, TestUtils::Connectivity::RandomPairs, TestUtils::DoorKinds::Mixed, rng);
+    x = TestUtils::createRandomVariables(model, std::sqrt(static_cast<double>(roomCount)) * 10.0, 10.0, rng);
+    return model;
+}
+
+void expectNoFailures(const Callbacks::DerivativeCheck::Result& result)
+{
+    EXPECT_GT(result.checkedCount, 0u);
+    EXPECT_EQ(result.failedCount, 0u) << "Max error: " << result.maxError;
+}
+
+}  // namespace
+
+TEST(LargeModelDerivativeTests, CorridorLengthGradientTest)
+{
+    std::vector<double> x;
+    const Model::Model model = createRandomModel(kRoomCount, x);
+    const Callbacks::CorridorLength corridorLength(model);
+    expectNoFailures(Callbacks::DerivativeCheck::checkGradient(corridorLength, x));
+}
+
+TEST(LargeModelDerivativeTests, PushForceGradientTest)
+{
+    std::vector<double> x;
+    const Model::Model model = createRandomModel(kRoomCount, x);
+    const Callbacks::PushForce pushForce(model, 2.5, 1.5);
+    expectNoFailures(Callbacks::DerivativeCheck::checkGradient(pushForce, x));
+
+    // Float terms: the error is bounded by float precision of each term times the number of pairs in a direction
+    const Callbacks::PushForce pushForceMixed(model, 2.5, 1.5, {}, Callbacks::Precision::Mixed);
+    const Callbacks::DerivativeCheck::Options mixedOptions{.step = 1e-2, .absTolerance = 1e-2, .relTolerance = 1e-2};
+    expectNoFailures(Callbacks::DerivativeCheck::checkGradient(pushForceMixed, x, mixedOptions));
+}
+
+TEST(LargeModelDerivativeTests, RoomOverlapJacobianTest)
+{
+    std::vector<double> x;
+    const Model::Model model = createRandomModel(kRoomCount, x);
+    const Model::Rooms& rooms = model.rooms();
+
+    // All overlapping pairs and the same number of random pairs, which mostly don't overlap
+    std::vector<Callbacks::RoomOverlap> overlaps;
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        for (size_t j = i + 1; j < rooms.size(); ++j) {
+            const auto [x1, y1] = rooms[i].getVariablesVal(x.data());
+            const auto [x2, y2] = rooms[j].getVariablesVal(x.data());
+            if (std::abs(x1 - x2) < (rooms[i].width() + rooms[j].width()) / 2 &&
+                std::abs(y1 - y2) < (rooms[i].height() + rooms[j].height()) / 2) {
+                overlaps.emplace_back(rooms[i], rooms[j]);
+            }
+        }
+    }
+    ASSERT_GT(overlaps.size(), 0u);
+    Random::RNG rng(42);
+    for (size_t overlappingCount = overlaps.size(), pairId = 0; pairId < overlappingCount; ++pairId) {
+        const size_t room1 = Random::uniformDiscrete(rooms.size() - 1, rng);
+        const size_t room2 = (room1 + 1 + Random::uniformDiscrete(rooms.size() - 2, rng)) % rooms.size();
+        overlaps.emplace_back(rooms[room1], rooms[room2]);
+    }
+    const std::vector<Callbacks::CEqFGEval> penalties(overlaps.begin(), overlaps.end());
+
+    const Callbacks::DerivativeCheck::SparseMatrix jacobian = assembleJacobian(penalties, x);
+    expectNoFailures(Callbacks::DerivativeCheck::checkJacobian(makePenaltiesEval(penalties), jacobian, x));
+}
+
+TEST(LargeModelDerivativeTests, CorridorCrossingGradientTest)
+{
+    std::vector<double> x;
+    const Model::Model model = createRandomModel(kRoomCount, x);
+    Callbacks::CorridorCrossing corridorCrossing(model, 2.5, 5.0);
+    corridorCrossing.updateCandidates(x.data());
+    ASSERT_GT(corridorCrossing.getCorridorPairCount(), 0u);
+    expectNoFailures(Callbacks::DerivativeCheck::checkGradient(std::cref(corridorCrossing), x));
+}
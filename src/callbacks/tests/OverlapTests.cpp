@@ -11,8 +11,10 @@ using namespace DungeonGeneration;
 // A wrapper class that uses non PETSc TAO interface
 class OverlapWrapper {
 public:
-    OverlapWrapper(const Model::Room& room1, const Model::Room& room2)
-          : overlap_(room1, room2, 1.0)
+    OverlapWrapper(
+        const Model::Room& room1, const Model::Room& room2,
+        Callbacks::Precision precision = Callbacks::Precision::Double)
+          : overlap_(room1, room2, 1.0, precision)
     {
         PetscInitializeNoArguments();
         MatCreateSeqDense(PETSC_COMM_SELF, cEqCnt_, varCnt_, nullptr, &JEq_);
@@ -94,3 +96,30 @@ TEST(CallbacksTests, OverlapGradientTest)
         checkGradientCorrectness(overlap, x);
     }
 }
+
+TEST(CallbacksTests, OverlapMixedPrecisionTest)
+{
+    // Float has ~7 significant digits, values and gradients are bounded, so an absolute tolerance is enough
+    constexpr double tolerance = 1e-5;
+    Model::Room room1(0, 10, 10, {});
+    Model::Room room2(1, 20, 20, {});
+    OverlapWrapper overlapDouble(room1, room2);
+    OverlapWrapper overlapMixed(room1, room2, Callbacks::Precision::Mixed);
+
+    constexpr size_t iterCount = 1000;
+    Random::RNG rng(42);
+    for (size_t it = 0; it < iterCount; ++it) {
+        std::vector<double> x(4, 0.0);
+        for (size_t i = 2; i < 4; ++i) {
+            x[i] = Random::uniformRangeContinuous(-17.0, 17.0, rng);
+        }
+        double fDouble = 0.0, fMixed = 0.0;
+        std::vector<double> gradDouble(4, 0.0), gradMixed(4, 0.0);
+        overlapDouble(x.data(), fDouble, gradDouble.data());
+        overlapMixed(x.data(), fMixed, gradMixed.data());
+        EXPECT_NEAR(fMixed, fDouble, tolerance);
+        for (size_t i = 0; i < x.size(); ++i) {
+            EXPECT_NEAR(gradMixed[i], gradDouble[i], tolerance) << "Gradient mismatch at " << i;
+        }
+    }
+}
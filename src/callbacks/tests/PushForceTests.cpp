@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+
 #include <callbacks/PushForce.h>
 #include <utils/Random.h>
 
@@ -13,7 +16,7 @@ TEST(CallbacksTests, PushForceValueTest)
     Model::Room room1(0, 10, 10, {});
     Model::Room room2(1, 20, 20, {});
     Model::Rooms rooms = {room1, room2};
-    Model::Model model(std::move(rooms), {});
+    Model::Model model(std::move(rooms), {}, {});
     Callbacks::PushForce pushForce(model);
 
     // Rooms are right on top of each other
@@ -41,7 +44,7 @@ TEST(CallbacksTests, PushForceGradientTest)
     Model::Room room1(0, 10, 10, {});
     Model::Room room2(1, 20, 20, {});
     Model::Rooms rooms = {room1, room2};
-    Model::Model model(std::move(rooms), {});
+    Model::Model model(std::move(rooms), {}, {});
     Callbacks::PushForce pushForce(model);
 
     constexpr size_t iterCount = 1000;
@@ -54,3 +57,92 @@ TEST(CallbacksTests, PushForceGradientTest)
         checkGradientCorrectness(pushForce, x);
     }
 }
+
+TEST(CallbacksTests, PushForceMatchesPairwiseReferenceTest)
+{
+    // Pairs count is not a multiple of the batch size, so both vectorized and scalar kernels are used
+    constexpr size_t roomCount = 37;
+    constexpr double scale = 2.5, range = 1.5, tolerance = 1e-12;
+    Random::RNG rng(42);
+    Model::Rooms rooms;
+    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
+        const double width = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        const double height = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        rooms.emplace_back(roomId, width, height);
+    }
+    std::vector<double> x(2 * roomCount);
+    for (double& var : x) {
+        var = Random::uniformRangeContinuous(-100.0, 100.0, rng);
+    }
+
+    // Straightforward per-pair evaluation of the same function
+    double fExpected = 0.0;
+    std::vector<double> gradExpected(x.size(), 0.0);
+    for (size_t i = 0; i < roomCount; ++i) {
+        for (size_t j = i + 1; j < roomCount; ++j) {
+            const double scaledHW = range * (rooms[i].width() + rooms[j].width()) / 2;
+            const double scaledHH = range * (rooms[i].height() + rooms[j].height()) / 2;
+            const double xRatio = (x[2 * i] - x[2 * j]) / scaledHW;
+            const double yRatio = (x[2 * i + 1] - x[2 * j + 1]) / scaledHH;
+            const double denominator = xRatio * xRatio + yRatio * yRatio + 1;
+            fExpected += scale / denominator;
+            const double gradX = -2.0 * scale * xRatio / scaledHW / (denominator * denominator);
+            const double gradY = -2.0 * scale * yRatio / scaledHH / (denominator * denominator);
+            gradExpected[2 * i] += gradX;
+            gradExpected[2 * i + 1] += gradY;
+            gradExpected[2 * j] -= gradX;
+            gradExpected[2 * j + 1] -= gradY;
+        }
+    }
+
+    Model::Model model(std::move(rooms), {}, {});
+    Callbacks::PushForce pushForce(model, scale, range);
+    double f = 0.0;
+    std::vector<double> grad(x.size(), 0.0);
+    pushForce(x.data(), f, grad.data());
+    EXPECT_NEAR(f, fExpected, tolerance * fExpected);
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_NEAR(grad[i], gradExpected[i], tolerance) << "Gradient mismatch at " << i;
+    }
+
+    // Evaluation without gradient gives the same value
+    double fNoGrad = 0.0;
+    pushForce(x.data(), fNoGrad, nullptr);
+    EXPECT_NEAR(fNoGrad, fExpected, tolerance * fExpected);
+}
+
+TEST(CallbacksTests, PushForceMixedPrecisionTest)
+{
+    // Pairs count is not a multiple of 8, so the tail goes through the scalar float kernel
+    constexpr size_t roomCount = 45;
+    constexpr double scale = 2.5, range = 1.5, relativeTolerance = 1e-5;
+    Random::RNG rng(7);
+    Model::Rooms rooms;
+    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
+        const double width = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        const double height = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        rooms.emplace_back(roomId, width, height);
+    }
+    // Coordinates are far from the origin: differences must not lose precision to cancellation
+    std::vector<double> x(2 * roomCount);
+    for (double& var : x) {
+        var = 1e6 + Random::uniformRangeContinuous(-100.0, 100.0, rng);
+    }
+
+    Model::Model model(std::move(rooms), {}, {});
+    const Callbacks::PushForce pushForceDouble(model, scale, range);
+    const Callbacks::PushForce pushForceMixed(model, scale, range, {}, Callbacks::Precision::Mixed);
+    double fDouble = 0.0, fMixed = 0.0;
+    std::vector<double> gradDouble(x.size(), 0.0), gradMixed(x.size(), 0.0);
+    pushForceDouble(x.data(), fDouble, gradDouble.data());
+    pushForceMixed(x.data(), fMixed, gradMixed.data());
+
+    EXPECT_NEAR(fMixed, fDouble, relativeTolerance * fDouble);
+    double maxGrad = 0.0;
+    for (double gradVal : gradDouble) {
+        maxGrad = std::max(maxGrad, std::abs(gradVal));
+    }
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_NEAR(gradMixed[i], gradDouble[i], relativeTolerance * maxGrad) << "Gradient mismatch at " << i;
+    }
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <callbacks/PushForce.h>
+#include <callbacks/RoomOverlap.h>
+#include <callbacks/RoomPairTerms.h>
+#include <petsc.h>
+#include <utils/Random.h>
+
+#include "Common.h"
+
+using namespace DungeonGeneration;
+
+namespace {
+
+constexpr size_t kRoomCount = 23;
+constexpr double kBloating = 1.1, kPushScale = 2.5, kPushRange = 1.5;
+
+/// Random rooms crowded enough to overlap; room i is connected to room i + 1 for every third i
+Model::Model createModel(Random::RNG& rng)
+{
+    Model::Rooms rooms;
+    Model::Doors doors;
+    for (size_t roomId = 0; roomId < kRoomCount; ++roomId) {
+        const double width = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        const double height = Random::uniformRangeContinuous(5.0, 30.0, rng);
+        rooms.emplace_back(roomId, width, height);
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = 0.0, .y = height / 2}));
+    }
+    Model::Corridors corridors;
+    for (size_t roomId = 0; roomId + 1 < kRoomCount; roomId += 3) {
+        corridors.push_back(Model::Corridor{.door1Id = roomId, .door2Id = roomId + 1});
+    }
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+/// Some of the pairs, not in the order of room ids
+std::vector<std::pair<size_t, size_t>> selectPairs()
+{
+    std::vector<std::pair<size_t, size_t>> pairs;
+    for (size_t i = kRoomCount; i-- > 0;) {
+        for (size_t j = i + 1; j < kRoomCount; ++j) {
+            if ((i + j) % 3 != 0) {
+                pairs.emplace_back(i, j);
+            }
+        }
+    }
+    return pairs;
+}
+
+struct Evaluation {
+    double f = 0.0;
+    std::vector<double> grad;
+    std::vector<double> cEq;
+    std::vector<double> JEq;  // Dense, row-major
+};
+
+/// Evaluates `terms` the way the solver does: constraints start at `firstCEqId`, Jacobian is assembled into a PETSc
+/// matrix
+Evaluation evaluate(
+    const Callbacks::FusedEval& terms, size_t cEqCount, const std::vector<double>& x, size_t firstCEqId = 0)
+{
+    PetscInitializeNoArguments();
+    const size_t totalCEqCount = firstCEqId + cEqCount;
+    Mat JEq;
+    MatCreateSeqAIJ(PETSC_COMM_SELF, totalCEqCount, x.size(), 4, nullptr, &JEq);
+    Evaluation evaluation{.grad = std::vector<double>(x.size(), 0.0), .cEq = std::vector<double>(totalCEqCount, 0.0)};
+    terms(x.data(), evaluation.f, evaluation.grad.data(), evaluation.cEq.data(), JEq, static_cast<int>(firstCEqId));
+    MatAssemblyBegin(JEq, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(JEq, MAT_FINAL_ASSEMBLY);
+    evaluation.JEq.assign(totalCEqCount * x.size(), 0.0);
+    for (size_t row = 0; row < totalCEqCount; ++row) {
+        PetscInt colCount;
+        const PetscInt* columns;
+        const PetscScalar* values;
+        MatGetRow(JEq, row, &colCount, &columns, &values);
+        for (PetscInt i = 0; i < colCount; ++i) {
+            evaluation.JEq[row * x.size() + columns[i]] += values[i];
+        }
+        MatRestoreRow(JEq, row, &colCount, &columns, &values);
+    }
+    MatDestroy(&JEq);
+    return evaluation;
+}
+
+/// Same terms evaluated by PushForce and separate RoomOverlap constraints
+Callbacks::FusedEval makeSeparateTerms(
+    const Callbacks::PushForce& pushForce, const std::vector<Callbacks::RoomOverlap>& overlaps)
+{
+    return [&](const double* x, double& f, double* grad, double* cEq, void* JEq, int firstCEqId) {
+        pushForce(x, f, grad);
+        for (size_t cEqId = 0; cEqId < overlaps.size(); ++cEqId) {
+            overlaps[cEqId](x, cEq[firstCEqId + cEqId], JEq, firstCEqId + static_cast<int>(cEqId));
+        }
+    };
+}
+
+void expectNear(const std::vector<double>& actual, const std::vector<double>& expected, double tolerance)
+{
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_NEAR(actual[i], expected[i], tolerance) << "Mismatch at " << i;
+    }
+}
+
+double maxAbs(const std::vector<double>& values)
+{
+    double result = 0.0;
+    for (double value : values) {
+        result = std::max(result, std::abs(value));
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(CallbacksTests, RoomPairTermsMatchSeparateTermsTest)
+{
+    Random::RNG rng(42);
+    const Model::Model model = createModel(rng);
+    const std::vector<std::pair<size_t, size_t>> pairs = selectPairs();
+    std::vector<bool> activeRooms(kRoomCount);
+    for (size_t roomId = 0; roomId < kRoomCount; ++roomId) {
+        activeRooms[roomId] = roomId % 4 != 0;
+    }
+    std::vector<double> x(2 * kRoomCount);
+    for (double& var : x) {
+        var = Random::uniformRangeContinuous(-40.0, 40.0, rng);
+    }
+
+    for (const Callbacks::Precision precision : {Callbacks::Precision::Double, Callbacks::Precision::Mixed}) {
+        SCOPED_TRACE(precision == Callbacks::Precision::Double ? "double" : "mixed");
+        const double relativeTolerance = precision == Callbacks::Precision::Double ? 1e-12 : 1e-5;
+        const Callbacks::PushForce pushForce(model, kPushScale, kPushRange, activeRooms, precision);
+        std::vector<Callbacks::RoomOverlap> overlaps;
+        for (const auto& [room1, room2] : pairs) {
+            overlaps.emplace_back(model.rooms()[room1], model.rooms()[room2], kBloating, precision);
+        }
+        const Callbacks::RoomPairTerms roomPairTerms(
+            model, pairs, kBloating, kPushScale, kPushRange, activeRooms, precision);
+        ASSERT_EQ(roomPairTerms.getConstraintCount(), pairs.size());
+
+        // Constraints of the terms don't have to start at 0
+        constexpr size_t firstCEqId = 3;
+        const Evaluation expected = evaluate(makeSeparateTerms(pushForce, overlaps), pairs.size(), x, firstCEqId);
+        const Evaluation actual = evaluate(std::cref(roomPairTerms), pairs.size(), x, firstCEqId);
+        ASSERT_GT(maxAbs(expected.cEq), 0.0) << "Test layout has no overlaps";
+        EXPECT_NEAR(actual.f, expected.f, relativeTolerance * expected.f);
+        expectNear(actual.grad, expected.grad, relativeTolerance * maxAbs(expected.grad));
+        expectNear(actual.cEq, expected.cEq, relativeTolerance * maxAbs(expected.cEq));
+        expectNear(actual.JEq, expected.JEq, relativeTolerance * maxAbs(expected.JEq));
+    }
+}
+
+TEST(CallbacksTests, RoomPairTermsWithoutPushForceTest)
+{
+    Random::RNG rng(7);
+    const Model::Model model = createModel(rng);
+    const std::vector<std::pair<size_t, size_t>> pairs = selectPairs();
+    std::vector<double> x(2 * kRoomCount);
+    for (double& var : x) {
+        var = Random::uniformRangeContinuous(-40.0, 40.0, rng);
+    }
+
+    std::vector<Callbacks::CEqFGEval> overlaps;
+    for (const auto& [room1, room2] : pairs) {
+        overlaps.push_back(Callbacks::RoomOverlap(model.rooms()[room1], model.rooms()[room2], kBloating));
+    }
+    const Callbacks::RoomPairTerms roomPairTerms(model, pairs, kBloating, 0.0, kPushRange);
+    const Evaluation evaluation = evaluate(std::cref(roomPairTerms), pairs.size(), x);
+    EXPECT_EQ(evaluation.f, 0.0);
+    EXPECT_EQ(maxAbs(evaluation.grad), 0.0);
+
+    std::vector<double> expectedCEq(pairs.size());
+    makePenaltiesEval(overlaps)(x.data(), expectedCEq.data());
+    expectNear(evaluation.cEq, expectedCEq, 1e-12 * maxAbs(expectedCEq));
+
+    // Jacobian is the one of the separate constraints
+    const Callbacks::DerivativeCheck::SparseMatrix jacobian = assembleJacobian(overlaps, x);
+    for (size_t row = 0; row < pairs.size(); ++row) {
+        for (size_t i = jacobian.rowOffsets[row]; i < jacobian.rowOffsets[row + 1]; ++i) {
+            EXPECT_NEAR(
+                evaluation.JEq[row * x.size() + jacobian.columns[i]], jacobian.values[i],
+                1e-12 * maxAbs(jacobian.values));
+        }
+    }
+}
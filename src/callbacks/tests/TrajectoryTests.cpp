@@ -0,0 +1,53 @@
+#include <gtest/gtest.h>
+
+#include <callbacks/Trajectory.h>
+#include <utils/Random.h>
+
+using namespace DungeonGeneration;
+
+TEST(TrajectoryTests, TestFramesRoundTrip)
+{
+    // Two rooms connected by movable doors
+    Model::Rooms rooms;
+    rooms.emplace_back(0, 10.0, 10.0);
+    rooms.emplace_back(1, 20.0, 10.0);
+    Model::Doors doors;
+    doors.push_back(Model::Door::createMovableDoor(0, 2));
+    doors.push_back(Model::Door::createMovableDoor(1, 3));
+    Model::Corridors corridors{Model::Corridor{.door1Id = 0, .door2Id = 1}};
+    Model::Model model(std::move(rooms), std::move(doors), std::move(corridors));
+
+    constexpr double kStep = Callbacks::Trajectory::kDefaultQuantizationStep;
+    // More frames than the keyframe interval, only some variables move
+    constexpr size_t kFrameCount = Callbacks::Trajectory::kKeyframeInterval + 10;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "trajectory_tests.bin";
+    Random::RNG rng(42);
+    std::vector<std::vector<double>> recordedX;
+    {
+        Callbacks::TrajectoryRecorder recorder(model, path);
+        std::vector<double> x(model.getVariablesCount(), 0.0);
+        for (size_t frameId = 0; frameId < kFrameCount; ++frameId) {
+            for (size_t varId = 0; varId < x.size(); varId += 3) {
+                x[varId] += Random::uniformRangeContinuous(-10.0, 10.0, rng);
+            }
+            recorder(x.data(), 0, static_cast<int>(frameId + 1));
+            recordedX.push_back(x);
+        }
+        EXPECT_EQ(recorder.getFrameCount(), kFrameCount);
+    }
+
+    const std::optional<Callbacks::TrajectoryReader> reader = Callbacks::TrajectoryReader::open(path);
+    ASSERT_TRUE(reader.has_value());
+    ASSERT_EQ(reader->getFrames().size(), kFrameCount);
+    EXPECT_EQ(reader->getModel().rooms().size(), 2u);
+    for (const size_t frameId : {size_t(0), size_t(1), kFrameCount / 2, kFrameCount - 1}) {
+        EXPECT_EQ(reader->getFrames()[frameId].iterNum, static_cast<int>(frameId + 1));
+        const std::optional<std::vector<double>> x = reader->getFrameVariables(frameId);
+        ASSERT_TRUE(x.has_value());
+        ASSERT_EQ(x->size(), recordedX[frameId].size());
+        for (size_t varId = 0; varId < x->size(); ++varId) {
+            EXPECT_NEAR((*x)[varId], recordedX[frameId][varId], kStep / 2 + 1e-12);
+        }
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,60 @@
+#include "ConfigurationHash.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <utils/Hash.h>
+
+namespace DungeonGeneration {
+
+namespace {
+
+void addRoomTypes(Hash::Hasher& hasher, const std::vector<RoomType>& roomTypes)
+{
+    hasher.add(roomTypes.size());
+    for (const RoomType& roomType : roomTypes) {
+        hasher.add(roomType.dimensions.width).add(roomType.dimensions.height).add(roomType.distributionWeight);
+    }
+}
+
+}  // namespace
+
+uint64_t hashConfiguration(const GenerationConfig& config, const LayoutSettings& settings)
+{
+    Hash::Hasher hasher;
+    hasher.add(kResultCacheVersion);
+
+    // Model generation
+    hasher.add(config.dungeonType).add(config.roomCount).add(config.seed);
+    hasher.add(settings.additionalEdgesRatio).add(settings.treeGenerationStrategy).add(settings.uniformRooms);
+    hasher.add(settings.enableHubRoom).add(settings.maxHubNeighborsCount).add(settings.hubNeighborsRatio);
+    addRoomTypes(hasher, settings.hubRoomTypes);
+    if (settings.roomCatalogPath.has_value()) {
+        // Contents, not the path: the file may change
+        std::ifstream ifstream(settings.roomCatalogPath.value(), std::ios::binary);
+        hasher.add(std::string(std::istreambuf_iterator<char>(ifstream), std::istreambuf_iterator<char>()));
+    } else {
+        addRoomTypes(hasher, settings.regularRoomTypes);
+    }
+
+    // Solving
+    const SolverParameters& parameters = config.solverParameters;
+    hasher.add(parameters.seed).add(parameters.muFactor).add(parameters.pushForceScale).add(parameters.pushForceRange);
+    hasher.add(parameters.roomBloating).add(parameters.normalizeCoordinates);
+    hasher.add(settings.enablePushForce).add(settings.callbacksPrecision).add(settings.solverRerunCount);
+    hasher.add(settings.enableCorridorCrossing).add(settings.corridorCrossingScale);
+    hasher.add(settings.corridorCrossingMargin);
+    hasher.add(settings.solverTimeLimit.has_value());
+    hasher.add(settings.solverTimeLimit.has_value() ? settings.solverTimeLimit->count() : 0);
+    hasher.add(settings.useSolverCheckpoint);
+    hasher.add(settings.enableLocalRepair).add(settings.repairMaxAttempts).add(settings.repairNeighborhoodDepth);
+    hasher.add(settings.repairOverlapMargin).add(settings.repairInitialPenalty);
+    hasher.add(config.usePortfolio);
+    if (config.usePortfolio) {
+        hasher.add(settings.portfolioSize).add(settings.portfolioAcceptableDefects);
+    }
+    return hasher.digest();
+}
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <callbacks/Defs.h>
+
+#include "Defs.h"
+#include "Settings.h"
+
+namespace DungeonGeneration {
+
+/// Values of Settings.h that affect the generated layout. Defaults are the current settings, tests vary them. A new
+/// setting that changes results must be added here and to hashConfiguration.
+struct LayoutSettings {
+    // Model generation
+    double additionalEdgesRatio = kAdditionalEdgesRatio;
+    TreeGenerationStrategy treeGenerationStrategy = kTreeGenerationStrategy;
+    bool uniformRooms = kUniformRooms;
+    std::vector<RoomType> regularRoomTypes = kRegularRoomTypes;
+    std::optional<std::filesystem::path> roomCatalogPath = kRoomCatalogPath;
+    bool enableHubRoom = kEnableHubRoom;
+    std::vector<RoomType> hubRoomTypes = kHubRoomTypes;
+    size_t maxHubNeighborsCount = kMaxHubNeighborsCount;
+    double hubNeighborsRatio = kHubNeighborsRatio;
+
+    // Solving
+    bool enablePushForce = kEnablePushForce;
+    Callbacks::Precision callbacksPrecision = kCallbacksPrecision;
+    size_t solverRerunCount = kSolverRerunCount;
+    bool enableCorridorCrossing = kEnableCorridorCrossing;
+    double corridorCrossingScale = kCorridorCrossingScale;
+    double corridorCrossingMargin = kCorridorCrossingMargin;
+    std::optional<std::chrono::milliseconds> solverTimeLimit = kSolverTimeLimit;
+    bool useSolverCheckpoint = kUseSolverCheckpoint;  // A resumed solve may end elsewhere than an uninterrupted one
+
+    // Local repair
+    bool enableLocalRepair = kEnableLocalRepair;
+    size_t repairMaxAttempts = kRepairMaxAttempts;
+    size_t repairNeighborhoodDepth = kRepairNeighborhoodDepth;
+    double repairOverlapMargin = kRepairOverlapMargin;
+    double repairInitialPenalty = kRepairInitialPenalty;
+
+    // Portfolio, only used if the config asks for it
+    size_t portfolioSize = kPortfolioSize;
+    size_t portfolioAcceptableDefects = kPortfolioAcceptableDefects;
+};
+
+/// Key of the result cache and solver checkpoints: everything that affects the layout generated for `config`
+uint64_t hashConfiguration(const GenerationConfig& config, const LayoutSettings& settings = {});
+
+}  // namespace DungeonGeneration
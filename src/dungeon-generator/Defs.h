@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
 namespace DungeonGeneration {
 
 enum class DungeonType {
@@ -24,4 +29,41 @@ struct RoomType {
     double distributionWeight;
 };
 
+/// Parameters that affect a single solver run. Portfolio runs differ only in these.
+struct SolverParameters {
+    uint64_t seed;  /// Seed for random shaking of the rooms
+    double muFactor;
+    double pushForceScale;
+    double pushForceRange;
+    double roomBloating;
+    bool normalizeCoordinates;  /// Precondition variables, see Normalization.h
+};
+
+/// Everything a caller chooses about a single dungeon. The rest comes from Settings.h.
+struct GenerationConfig {
+    DungeonType dungeonType;
+    size_t roomCount;  /// Ignored for DungeonType::Grid
+    uint64_t seed;     /// Seed of the model: room sizes and the graph
+    SolverParameters solverParameters;
+    bool usePortfolio;  /// Solve with several perturbed solvers in parallel, see DungeonGenerator::runSolverPortfolio
+};
+
+/// Open world that is generated and solved chunk by chunk, see WorldGenerator
+struct WorldConfig {
+    uint64_t seed;
+    size_t chunkRoomCount;     /// New rooms per chunk
+    size_t frontierRoomCount;  /// Rooms of a chunk that the next chunk connects to
+    SolverParameters solverParameters;
+};
+
+/// Side effects of a generator. By default it doesn't touch the filesystem.
+struct GeneratorOptions {
+    /// Debug SVG dumps and solver checkpoints are written here, if set
+    std::optional<std::filesystem::path> outputDirectory;
+    bool enableResultCache = false;
+    /// Cached results are also stored in this directory, if set. Otherwise they are kept only in memory.
+    std::optional<std::filesystem::path> resultCacheDirectory;
+    size_t resultCacheMemoryCapacity = 16;
+};
+
 }  // namespace DungeonGeneration
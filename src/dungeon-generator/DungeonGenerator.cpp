@@ -1,100 +1,406 @@
 #include "DungeonGenerator.h"
 
+#include <array>
 #include <cassert>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <tuple>
 
 #include <AnalyticalSolver.h>
+#include <callbacks/CorridorCrossing.h>
 #include <callbacks/CorridorLength.h>
-#include <callbacks/PushForce.h>
-#include <callbacks/RoomOverlap.h>
+#include <callbacks/RoomPairTerms.h>
 #include <callbacks/RoomShaker.h>
 #include <callbacks/SVGDumper.h>
+#include <callbacks/Trajectory.h>
+#include <model/Serialization.h>
+#include <model/Validation.h>
+#include <utils/Hash.h>
 
+#include "ConfigurationHash.h"
 #include "ModelGenerator.h"
+#include "Normalization.h"
+#include "ResultCache.h"
 #include "Settings.h"
+#include "SolutionRepairer.h"
 
-static std::filesystem::path kPathToSVG
+namespace DungeonGeneration {
+
+namespace {
+
+/// Parameters for the portfolio member. The first member always uses the default parameters.
+SolverParameters getPortfolioParameters(const SolverParameters& defaultParameters, size_t memberId)
 {
-#if defined(PATH_TO_SVG)
-    PATH_TO_SVG
-#endif
+    // Perturbations are cycled through, each cycle also gets its own seed
+    constexpr std::array<double, 4> kMuFactorScales{1.0, 0.4, 2.0, 1.0};
+    constexpr std::array<double, 4> kPushForceScales{1.0, 1.0, 0.5, 2.0};
+    constexpr std::array<double, 4> kRoomBloatings{1.5, 1.3, 1.5, 1.7};
+
+    const size_t variation = memberId % kMuFactorScales.size();
+    SolverParameters parameters = defaultParameters;
+    parameters.seed += memberId;
+    parameters.muFactor *= kMuFactorScales[variation];
+    parameters.pushForceScale *= kPushForceScales[variation];
+    parameters.roomBloating = kRoomBloatings[variation];
+    return parameters;
+}
+
+struct LayoutScore {
+    size_t defectsCount;
+    double corridorLength;
+
+    bool operator<(const LayoutScore& other) const
+    {
+        return std::tie(defectsCount, corridorLength) < std::tie(other.defectsCount, other.corridorLength);
+    }
 };
 
-namespace DungeonGeneration {
+LayoutScore scoreLayout(const Model::Model& model)
+{
+    return LayoutScore{
+        .defectsCount = Model::Validation::findDefects(model).count(),
+        .corridorLength = Model::Validation::totalCorridorLength(model)};
+}
+
+ModelGenerator createModelGenerator(uint64_t seed, std::pmr::memory_resource* resource)
+{
+    if (kRoomCatalogPath.has_value()) {
+        std::optional<RoomCatalog> regularRooms = RoomCatalog::loadFromFile(kRoomCatalogPath.value());
+        if (regularRooms.has_value()) {
+            return ModelGenerator(std::move(regularRooms.value()), RoomCatalog(kHubRoomTypes), resource, seed);
+        }
+        std::cerr << "(!) DungeonGenerator: failed to load room catalog, default room types are used\n";
+    }
+    return ModelGenerator(resource, seed);
+}
+
+/// Deadline of a solver run that starts now. Every run (the first solve, each rerun, the local repair) gets the full
+/// time limit, so that one run hitting it doesn't leave the following ones without time.
+std::optional<AnalyticalSolver::Clock::time_point> getRunDeadline()
+{
+    if (!kSolverTimeLimit.has_value()) {
+        return std::nullopt;
+    }
+    return AnalyticalSolver::Clock::now() + kSolverTimeLimit.value();
+}
+
+void logArenaStats(const Memory::Arena& arena, const std::string& jobName)
+{
+    const Memory::AllocationStats requested = arena.requestedStats();
+    const Memory::AllocationStats upstream = arena.upstreamStats();
+    std::cerr << "DungeonGenerator: " << jobName << " made " << requested.allocationCount << " allocations ("
+              << requested.allocatedBytes << " bytes), served by " << upstream.allocationCount << " block allocations ("
+              << upstream.allocatedBytes << " bytes)\n";
+}
+
+}  // namespace
+
+DungeonGenerator::DungeonGenerator(GeneratorOptions options)
+      : options_(std::move(options)),
+        workMemory_(std::pmr::new_delete_resource(), kWorkMemoryCacheCapacity)
+{
+    if (options_.enableResultCache) {
+        resultCache_ = std::make_unique<ResultCache>(options_.resultCacheDirectory, options_.resultCacheMemoryCapacity);
+    }
+}
+
+DungeonGenerator::~DungeonGenerator() = default;
+
+GenerationConfig DungeonGenerator::getDefaultConfig()
+{
+    return GenerationConfig{
+        .dungeonType = kDungeonType,
+        .roomCount = kRoomCount,
+        .seed = kSeed,
+        .solverParameters = kDefaultSolverParameters,
+        .usePortfolio = kEnablePortfolio};
+}
+
+GeneratorOptions DungeonGenerator::getDefaultOptions(const std::filesystem::path& outputDirectory)
+{
+    return GeneratorOptions{
+        .outputDirectory = outputDirectory,
+        .enableResultCache = kEnableResultCache,
+        .resultCacheDirectory = outputDirectory / "result_cache",
+        .resultCacheMemoryCapacity = kResultCacheMemoryCapacity};
+}
 
 Model::Model DungeonGenerator::generateDungeon() const
 {
-    Model::Model model = generateModel();
-    model = runSolver(std::move(model));
+    return generateDungeon(getDefaultConfig());
+}
+
+Model::Model DungeonGenerator::generateDungeon(
+    const GenerationConfig& config, AnalyticalSolver::SolveStatistics* statistics,
+    AnalyticalSolver::SolverWorkspace* workspace) const
+{
+    if (statistics != nullptr) {
+        *statistics = {};
+    }
+    if (config.usePortfolio) {
+        return generateCached(config, [this, &config](bool& interrupted) {
+            return runSolverPortfolio(config, interrupted);
+        });
+    }
+    return generateCached(config, [&](bool& interrupted) {
+        Memory::Arena arena(&workMemory_);
+        const Model::Model model = runSolver(
+            generateModel(config, arena.resource()), config.solverParameters, hashConfiguration(config),
+            arena.resource(), "", nullptr, statistics, workspace, &interrupted);
+        logArenaStats(arena, "generation");
+        // Result must outlive the arena
+        return Model::Model(model, std::pmr::get_default_resource());
+    });
+}
+
+std::vector<uint8_t> DungeonGenerator::generateSerialized(const GenerationConfig& config) const
+{
+    return Model::Serialization::serialize(generateDungeon(config));
+}
+
+Model::Model DungeonGenerator::generateCached(
+    const GenerationConfig& config, const std::function<Model::Model(bool& interrupted)>& generate) const
+{
+    bool interrupted = false;
+    if (resultCache_ == nullptr) {
+        return generate(interrupted);
+    }
+    const uint64_t key = hashConfiguration(config);
+    std::optional<Model::Model> cachedModel = resultCache_->find(key, [this, &config]() {
+        return generateModel(config, std::pmr::get_default_resource());
+    });
+    if (cachedModel.has_value()) {
+        std::cerr << "DungeonGenerator: result is served from the cache\n";
+        return std::move(cachedModel.value());
+    }
+    Model::Model model = generate(interrupted);
+    // Another run with more time could do better
+    if (interrupted) {
+        std::cerr << "DungeonGenerator: result was interrupted, it isn't cached\n";
+    } else {
+        resultCache_->insert(key, model);
+    }
     return model;
 }
 
-Model::Model DungeonGenerator::generateModel() const
+Model::Model DungeonGenerator::generateModel(const GenerationConfig& config, std::pmr::memory_resource* resource) const
 {
-    ModelGenerator modelGenerator;
-    switch (kDungeonType) {
+    ModelGenerator modelGenerator = createModelGenerator(config.seed, resource);
+    switch (config.dungeonType) {
         case DungeonType::Grid: {
             // More of a test run
             constexpr size_t kGridSide = 5;
             Model::Model model = modelGenerator.generateGrid(kGridSide);
-            model.dumpToSVG(kPathToSVG / "grid_input.svg");
+            dumpToSVG(model, "grid_input.svg");
             return model;
         }
         case DungeonType::CenterDoors:
-            return modelGenerator.generateModelCenterDoors(kRoomCount);
+            return modelGenerator.generateModelCenterDoors(config.roomCount);
         case DungeonType::TreeFixedDoors:
-            return modelGenerator.generateTreeFixedDoors(kRoomCount);
+            return modelGenerator.generateTreeFixedDoors(config.roomCount);
         case DungeonType::MovableDoors:
-            return modelGenerator.generateModelMovableDoors(kRoomCount);
+            return modelGenerator.generateModelMovableDoors(config.roomCount);
         default:
             assert(false && "Unsupported DungeonType");
             return Model::Model();
     }
 }
 
-Model::Model DungeonGenerator::runSolver(Model::Model&& model) const
+Model::Model DungeonGenerator::runSolver(
+    Model::Model&& model, const SolverParameters& parameters, uint64_t configurationHash,
+    std::pmr::memory_resource* resource, const std::string& filenamePrefix,
+    const AnalyticalSolver::CancellationToken* cancellationToken, AnalyticalSolver::SolveStatistics* statistics,
+    AnalyticalSolver::SolverWorkspace* workspace, bool* interrupted) const
 {
+    // Callback objects live in this scope and are passed to the solver by reference, so that wrapping them into
+    // std::function doesn't need a heap allocation per callback. They must outlive the solver.
+
     // Cost functions
-    std::vector<Callbacks::FGEval> costFunctions;
-    for (const auto& [door1, door2] : model.corridors()) {
-        costFunctions.push_back(Callbacks::CorridorLength(door1, door2));
-    }
-    if (kEnablePushForce) {
-        costFunctions.push_back(Callbacks::PushForce(model, kPushForceScale, kPushForceRange));
+    const Callbacks::CorridorLength corridorLength(model, {}, resource);
+    std::vector<Callbacks::FGEval> costFunctions{std::cref(corridorLength)};
+    // Candidate pairs are refreshed after each ALMM iteration by a reader callback below
+    std::optional<Callbacks::CorridorCrossing> corridorCrossing;
+    if (kEnableCorridorCrossing) {
+        corridorCrossing.emplace(model, kCorridorCrossingScale, kCorridorCrossingMargin, resource);
+        costFunctions.push_back(std::cref(corridorCrossing.value()));
     }
 
-    // Penalty functions
-    std::vector<Callbacks::CEqFGEval> penaltyFunctions;
+    // Push force and overlap penalties of all room pairs, evaluated in one pass
     const Model::Rooms& rooms = model.rooms();
+    std::vector<std::pair<size_t, size_t>> roomPairs;
+    roomPairs.reserve(rooms.size() * (rooms.size() - 1) / 2);
     for (size_t i = 0; i < rooms.size(); ++i) {
         for (size_t j = i + 1; j < rooms.size(); ++j) {
-            penaltyFunctions.push_back(Callbacks::RoomOverlap(rooms[i], rooms[j], kRoomBloating));
+            roomPairs.emplace_back(i, j);
         }
     }
+    const Callbacks::RoomPairTerms roomPairTerms(
+        model, roomPairs, parameters.roomBloating, kEnablePushForce ? parameters.pushForceScale : 0.0,
+        parameters.pushForceRange, {}, kCallbacksPrecision, resource);
+    std::vector<AnalyticalSolver::FusedTerms> fusedTerms{
+        {.evaluate = std::cref(roomPairTerms), .constraintCount = roomPairTerms.getConstraintCount()}};
 
     // On iteration callbacks
-    std::vector<Callbacks::ModifierCallback> modifierCallbacks{Callbacks::RoomShaker(model)};
-    std::vector<Callbacks::ReaderCallback> readerCallbacks{Callbacks::SVGDumper(model, kPathToSVG, "iter")};
+    Callbacks::RoomShaker roomShaker(model, parameters.seed);
+    std::optional<Callbacks::SVGDumper> svgDumper;
+    std::optional<Callbacks::TrajectoryRecorder> trajectoryRecorder;
+    std::vector<Callbacks::ModifierCallback> modifierCallbacks{std::ref(roomShaker)};
+    std::vector<Callbacks::ReaderCallback> readerCallbacks;
+    if (corridorCrossing.has_value()) {
+        readerCallbacks.push_back(std::ref(corridorCrossing.value()));
+    }
+    if (options_.outputDirectory.has_value() && kRecordTrajectory) {
+        trajectoryRecorder.emplace(
+            model, options_.outputDirectory.value() / (filenamePrefix + "trajectory.bin"), kTrajectoryQuantizationStep);
+        readerCallbacks.push_back(std::ref(trajectoryRecorder.value()));
+    } else if (options_.outputDirectory.has_value()) {
+        svgDumper.emplace(model, options_.outputDirectory.value(), filenamePrefix + "iter");
+        readerCallbacks.push_back(std::ref(svgDumper.value()));
+    }
 
     // Create and run a analytical solver
+    AnalyticalSolver::SolverOptions options{
+        .muFactor = parameters.muFactor, .cancellationToken = cancellationToken, .workspace = workspace};
+    if (parameters.normalizeCoordinates) {
+        options.scaling = makeCoordinatesNormalization(model);
+    }
     AnalyticalSolver::AnalyticalSolver solver(
-        model.getObjectCount(), model.getVariablesCount(), model.getVariablesBounds(), std::move(costFunctions),
-        std::move(penaltyFunctions), std::move(modifierCallbacks), std::move(readerCallbacks));
-    solver.solve();
-    Model::Positions solution = solver.retrieveSolution();
-    model.setPositions(solution);
-    model.dumpToSVG(kPathToSVG / "result_run_0.svg");
+        model.getObjectCount(), model.getVariablesCount(), model.getVariablesBounds(), std::move(costFunctions), {},
+        std::move(fusedTerms), std::move(modifierCallbacks), std::move(readerCallbacks), options);
+    // Checkpoints live in the output directory, so they are used only if it's set. They are only restored for the same
+    // configuration and portfolio member.
+    const bool useCheckpoint = kUseSolverCheckpoint && options_.outputDirectory.has_value();
+    const std::filesystem::path checkpointPath =
+        useCheckpoint ? options_.outputDirectory.value() / (filenamePrefix + "solver_checkpoint.bin") : "";
+    const uint64_t checkpointHash = Hash::Hasher().add(configurationHash).add(filenamePrefix).digest();
+    std::optional<AnalyticalSolver::SolveResult> restoredResult;
+    bool wasInterrupted = false;
+    if (useCheckpoint && std::filesystem::exists(checkpointPath)) {
+        restoredResult = solver.loadCheckpoint(checkpointPath, checkpointHash);
+    }
+    if (restoredResult.has_value() && restoredResult.value() != AnalyticalSolver::SolveResult::Interrupted) {
+        // The first solve was done before, only reruns are left
+        std::cerr << "DungeonGenerator: solver state restored from " << checkpointPath << "\n";
+    } else {
+        if (restoredResult.has_value()) {
+            std::cerr << "DungeonGenerator: resuming the interrupted solve from " << checkpointPath << "\n";
+        }
+        solver.setDeadline(getRunDeadline());
+        wasInterrupted = (solver.solve() == AnalyticalSolver::SolveResult::Interrupted);
+        // Interrupted solves are saved too, the next launch continues them
+        if (useCheckpoint) {
+            solver.saveCheckpoint(checkpointPath, checkpointHash);
+        }
+    }
+    if (statistics != nullptr) {
+        *statistics = solver.getStatistics();
+    }
+    model.setPositionsFromVars(solver.getSolutionData());
+    dumpToSVG(model, filenamePrefix + "result_run_0.svg");
+
+    // Cancelled members of a portfolio return right away: their result is going to be thrown away
+    auto isCancelled = [cancellationToken]() {
+        return cancellationToken != nullptr && cancellationToken->isCancelled();
+    };
 
     // Rerun the solver. Reuse inner state.
-    for (size_t runId = 1; runId <= kSolverRerunCount; ++runId) {
+    for (size_t runId = 1; runId <= kSolverRerunCount && !isCancelled(); ++runId) {
+        solver.setDeadline(getRunDeadline());
         solver.rerunSolver();
-        solution = solver.retrieveSolution();
-        model.setPositions(solution);
+        wasInterrupted |= (solver.getLastSolveResult() == AnalyticalSolver::SolveResult::Interrupted);
+        model.setPositionsFromVars(solver.getSolutionData());
 
-        const std::string fileName = "result_run_" + std::to_string(runId);
-        model.dumpToSVG(kPathToSVG / (fileName + ".svg"));
+        const std::string fileName = filenamePrefix + "result_run_" + std::to_string(runId);
+        dumpToSVG(model, fileName + ".svg");
     }
 
+    // Fix leftover defects locally instead of rerunning the whole solver
+    if (kEnableLocalRepair && !isCancelled()) {
+        SolutionRepairer repairer(parameters);
+        const std::optional<AnalyticalSolver::Clock::time_point> repairDeadline = getRunDeadline();
+        if (!repairer.repair(model, cancellationToken, repairDeadline)) {
+            std::cerr << "(!) DungeonGenerator::runSolver: failed to repair all defects\n";
+        }
+        wasInterrupted |= (repairDeadline.has_value() && AnalyticalSolver::Clock::now() >= repairDeadline.value());
+        dumpToSVG(model, filenamePrefix + "result_repaired.svg");
+    }
+
+    // Reruns and repair that were skipped or stopped by the cancellation count too
+    if (interrupted != nullptr) {
+        *interrupted = wasInterrupted || isCancelled();
+    }
     return std::move(model);
 }
 
+Model::Model DungeonGenerator::runSolverPortfolio(const GenerationConfig& config, bool& interrupted) const
+{
+    // PETSc is already initialized by petscScope_, as required for solvers on worker threads
+    Memory::Arena modelArena(&workMemory_);
+    const Model::Model initialModel = generateModel(config, modelArena.resource());
+
+    const uint64_t configurationHash = hashConfiguration(config);
+    AnalyticalSolver::CancellationToken cancellationToken;
+    std::mutex bestResultMutex;
+    std::optional<Model::Model> bestModel;
+    std::optional<LayoutScore> bestScore;
+    bool bestInterrupted = false;
+
+    auto runMember = [&](size_t memberId) {
+        const SolverParameters parameters = getPortfolioParameters(config.solverParameters, memberId);
+        const std::string filenamePrefix = "portfolio_" + std::to_string(memberId) + "_";
+        try {
+            // Each member needs its own copy of the model: callbacks keep references to it. Arenas aren't
+            // thread-safe, so each member gets its own one.
+            Memory::Arena arena(&workMemory_);
+            bool memberInterrupted = false;
+            Model::Model model = runSolver(
+                Model::Model(initialModel, arena.resource()), parameters, configurationHash, arena.resource(),
+                filenamePrefix, &cancellationToken, nullptr, nullptr, &memberInterrupted);
+            const LayoutScore score = scoreLayout(model);
+            std::cerr << "DungeonGenerator: portfolio member " << memberId << " finished with "
+                      << score.defectsCount << " defects, corridor length " << score.corridorLength << "\n";
+
+            std::lock_guard lock(bestResultMutex);
+            if (!bestScore.has_value() || score < bestScore.value()) {
+                bestScore = score;
+                bestInterrupted = memberInterrupted;
+                // Result must outlive member's arena
+                bestModel.emplace(model, std::pmr::get_default_resource());
+            }
+            if (score.defectsCount <= kPortfolioAcceptableDefects) {
+                cancellationToken.cancel();
+            }
+            logArenaStats(arena, "portfolio member " + std::to_string(memberId));
+        } catch (std::exception& error) {
+            std::cerr << "(!) DungeonGenerator: portfolio member " << memberId << " failed: " << error.what() << "\n";
+        }
+    };
+
+    std::vector<std::thread> members;
+    members.reserve(kPortfolioSize);
+    for (size_t memberId = 0; memberId < kPortfolioSize; ++memberId) {
+        members.emplace_back(runMember, memberId);
+    }
+    for (std::thread& member : members) {
+        member.join();
+    }
+
+    if (!bestModel.has_value()) {
+        throw std::runtime_error("DungeonGenerator: all portfolio members failed");
+    }
+    // Results of the other members are thrown away, whether they were cancelled or not
+    interrupted = bestInterrupted;
+    return std::move(bestModel.value());
+}
+
+void DungeonGenerator::dumpToSVG(const Model::Model& model, const std::string& filename) const
+{
+    if (options_.outputDirectory.has_value()) {
+        model.dumpToSVG(options_.outputDirectory.value() / filename);
+    }
+}
+
 }  // namespace DungeonGeneration
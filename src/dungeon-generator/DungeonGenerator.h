@@ -1,19 +1,81 @@
 #pragma once
 
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+#include <AnalyticalSolver.h>
+#include <CancellationToken.h>
 #include <model/Model.h>
+#include <utils/Memory.h>
+
+#include "Defs.h"
 
 namespace DungeonGeneration {
 
-// Main generator class that is responsible for whole generation flow
+class ResultCache;
+
+/// Main generator class that is responsible for whole generation flow. Keeps PETSc initialized and work memory
+/// allocated between calls, so create it once and reuse it for many dungeons. Generation methods may be called from
+/// several threads at once.
 class DungeonGenerator {
 public:
-    DungeonGenerator() = default;
+    explicit DungeonGenerator(GeneratorOptions options = {});
+    ~DungeonGenerator();
+
+    DungeonGenerator(const DungeonGenerator&) = delete;
+    DungeonGenerator& operator=(const DungeonGenerator&) = delete;
+
+    /// Config of Settings.h
+    static GenerationConfig getDefaultConfig();
+    /// Options of the standalone executable: debug output and the result cache (if enabled in Settings.h) go to
+    /// `outputDirectory`
+    static GeneratorOptions getDefaultOptions(const std::filesystem::path& outputDirectory);
 
     Model::Model generateDungeon() const;
+    /// Statistics of the main solve are written to `statistics` if it's not null (zeros if the result came from the
+    /// cache or a portfolio was used). Solver buffers are taken from `workspace` if it's not null, it's not used by
+    /// portfolio members.
+    Model::Model generateDungeon(
+        const GenerationConfig& config, AnalyticalSolver::SolveStatistics* statistics = nullptr,
+        AnalyticalSolver::SolverWorkspace* workspace = nullptr) const;
+    /// Same as generateDungeon, the model is returned in the format of model/Serialization.h
+    std::vector<uint8_t> generateSerialized(const GenerationConfig& config) const;
 
 private:
-    Model::Model generateModel() const;
-    Model::Model runSolver(Model::Model&& model) const;
+    /// Model tables and solver temporaries are allocated in `resource`, the returned model keeps using it
+    Model::Model generateModel(const GenerationConfig& config, std::pmr::memory_resource* resource) const;
+    /// `configurationHash` identifies the configuration the model was generated for, solver checkpoints of other
+    /// configurations are ignored. `interrupted` is set if it's not null and any solver run or the repair was cut
+    /// short by the cancellation or the time limit, i.e. the result depends on timing.
+    Model::Model runSolver(
+        Model::Model&& model, const SolverParameters& parameters, uint64_t configurationHash,
+        std::pmr::memory_resource* resource, const std::string& filenamePrefix = "",
+        const AnalyticalSolver::CancellationToken* cancellationToken = nullptr,
+        AnalyticalSolver::SolveStatistics* statistics = nullptr, AnalyticalSolver::SolverWorkspace* workspace = nullptr,
+        bool* interrupted = nullptr) const;
+
+    /// Solve the same model with several differently parametrized solvers in parallel and pick the best result.
+    /// Remaining runs are cancelled as soon as one of them finds a good enough layout. `interrupted` is set if the
+    /// picked run was interrupted.
+    Model::Model runSolverPortfolio(const GenerationConfig& config, bool& interrupted) const;
+
+    /// Serve the result from the cache if enabled, otherwise `generate` it and cache it. `generate` sets its argument
+    /// if the result was interrupted, such results aren't cached.
+    Model::Model generateCached(
+        const GenerationConfig& config, const std::function<Model::Model(bool& interrupted)>& generate) const;
+
+    void dumpToSVG(const Model::Model& model, const std::string& filename) const;
+
+    const GeneratorOptions options_;
+    const AnalyticalSolver::PETScScope petscScope_;
+    // Arenas of generation jobs take their blocks from here, so the blocks are reused by the following jobs
+    mutable Memory::BlockCache workMemory_;
+    std::unique_ptr<ResultCache> resultCache_;
 };
 
 }  // namespace DungeonGeneration
@@ -1,5 +1,6 @@
 #include "GraphGenerator.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include "Settings.h"
@@ -44,6 +45,11 @@ bool isTree(const GraphGenerator::Graph& graph)
 }
 }  // namespace
 
+GraphGenerator::GraphGenerator(std::pmr::memory_resource* resource, uint64_t seed)
+      : resource_(resource),
+        rng_(Random::RNG(seed).split(Random::Streams::kGraphGeneration))
+{}
+
 GraphGenerator::Graph GraphGenerator::generateTree(size_t vertexCount)
 {
     switch (kTreeGenerationStrategy) {
@@ -53,7 +59,7 @@ GraphGenerator::Graph GraphGenerator::generateTree(size_t vertexCount)
             return generateTreeChildCountStrategy(vertexCount);
         default:
             assert(false && "Unknown tree generation strategy");
-            return Graph();
+            return Graph(resource_);
     }
 }
 
@@ -62,7 +68,8 @@ GraphGenerator::Graph GraphGenerator::generateConnectedGraph(size_t vertexCount,
     Graph graph = generateTree(vertexCount);
 
     // TODO: be careful if vertex count will be too high
-    std::vector<std::vector<bool>> adjacencyMatrix(vertexCount, std::vector<bool>(vertexCount));
+    std::pmr::vector<std::pmr::vector<bool>> adjacencyMatrix(
+        vertexCount, std::pmr::vector<bool>(vertexCount, false, resource_), resource_);
     for (size_t v = 0; v < vertexCount; ++v) {
         adjacencyMatrix[v][v] = true;
         for (const size_t u : graph[v]) {
@@ -91,7 +98,7 @@ GraphGenerator::Graph GraphGenerator::generateConnectedGraph(size_t vertexCount,
 
 GraphGenerator::Graph GraphGenerator::generateTreePredecessorStrategy(size_t vertexCount)
 {
-    std::vector<std::vector<size_t>> graph(vertexCount);
+    Graph graph(vertexCount, resource_);
     for (size_t v = 1; v < vertexCount; ++v) {
         const size_t u = Random::uniformDiscrete(v - 1, rng_);
         graph[v].push_back(u);
@@ -107,7 +114,7 @@ GraphGenerator::Graph GraphGenerator::generateTreeChildCountStrategy(size_t vert
     //       implement neighbors count distribution
     constexpr size_t maxNeighborsCount = 4;
 
-    std::vector<std::vector<size_t>> graph(vertexCount);
+    Graph graph(vertexCount, resource_);
     if (vertexCount == 1) {
         // Just to be safe
         return graph;
@@ -120,7 +127,9 @@ GraphGenerator::Graph GraphGenerator::generateTreeChildCountStrategy(size_t vert
 
         size_t maxChildrenCount = maxNeighborsCount - 1;
         if (v == 0) {
-            maxChildrenCount = (kEnableHubRoom ? kHubNeighborsCount : maxNeighborsCount);
+            const size_t hubNeighborsCount =
+                std::min(kMaxHubNeighborsCount, static_cast<size_t>(vertexCount * kHubNeighborsRatio));
+            maxChildrenCount = (kEnableHubRoom ? hubNeighborsCount : maxNeighborsCount);
         }
         maxChildrenCount = std::min(maxChildrenCount, vertexCount - disconnectedVertex);
         assert(disconnectedVertex + maxChildrenCount <= vertexCount && "Too many children nodes");
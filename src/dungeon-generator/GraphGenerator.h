@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory_resource>
+
 #include <model/Model.h>
 #include <utils/Random.h>
 
@@ -8,9 +10,11 @@ namespace DungeonGeneration {
 // A class for generating underlying graphs in model
 class GraphGenerator {
 public:
-    using Graph = std::vector<std::vector<size_t>>;
+    using Graph = std::pmr::vector<std::pmr::vector<size_t>>;
 
-    GraphGenerator() = default;
+    /// Graphs and temporaries are allocated in `resource`. Randomness comes from the graph generation stream of `seed`.
+    explicit GraphGenerator(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(), uint64_t seed = Random::kGlobalSeed);
 
     Graph generateTree(size_t vertexCount);
     Graph generateConnectedGraph(size_t vertexCount, size_t additionalEdges);
@@ -19,7 +23,8 @@ private:
     Graph generateTreePredecessorStrategy(size_t vertexCount);
     Graph generateTreeChildCountStrategy(size_t vertexCount);
 
-    Random::RNG rng_ = Random::RNG(Random::kGlobalSeed);  // random number generator
+    std::pmr::memory_resource* resource_;
+    Random::RNG rng_;  // random number generator
 };
 
 }  // namespace DungeonGeneration
@@ -8,6 +8,8 @@
 namespace DungeonGeneration {
 
 namespace {
+constexpr size_t kFourDoorsCount = 4;
+
 /*
 Create a room with doors placed this way
     2
@@ -15,27 +17,52 @@ Create a room with doors placed this way
 1─┤   ├─3
   └─┬─┘
     0
+Doors are appended to `doors`, so door `side` of the room has index `roomId * 4 + side` if all rooms are created this
+way in order.
 */
 Model::Room createRoomFourFixedDoors(
-    size_t roomId, double width, double height, Model::Position centerPosition = {0, 0})
+    size_t roomId, double width, double height, Model::Doors& doors, Model::Position centerPosition = {0, 0})
 {
     using namespace Model;
 
     const double doorDx = width * 0.4;
     const double doorDy = height * 0.4;
 
-    std::vector<Door> doors{
-        Door::createFixedDoor(roomId, Position{.x = 0.0, .y = -doorDy}),
-        Door::createFixedDoor(roomId, Position{.x = -doorDx, .y = 0.0}),
-        Door::createFixedDoor(roomId, Position{.x = 0.0, .y = doorDy}),
-        Door::createFixedDoor(roomId, Position{.x = doorDx, .y = 0.0}),
-    };
+    doors.push_back(Door::createFixedDoor(roomId, Position{.x = 0.0, .y = -doorDy}));
+    doors.push_back(Door::createFixedDoor(roomId, Position{.x = -doorDx, .y = 0.0}));
+    doors.push_back(Door::createFixedDoor(roomId, Position{.x = 0.0, .y = doorDy}));
+    doors.push_back(Door::createFixedDoor(roomId, Position{.x = doorDx, .y = 0.0}));
 
-    return Room(roomId, width, height, std::move(doors), centerPosition);
+    return Room(roomId, width, height, centerPosition);
+}
+
+size_t getFourDoorsDoorId(size_t roomId, size_t side)
+{
+    assert(side < kFourDoorsCount && "Invalid door side");
+    return roomId * kFourDoorsCount + side;
+}
+
+size_t getAdditionalEdgesCount(size_t roomCount)
+{
+    return static_cast<size_t>(roomCount * kAdditionalEdgesRatio);
 }
 
 }  // namespace
 
+ModelGenerator::ModelGenerator(std::pmr::memory_resource* resource, uint64_t seed)
+      : ModelGenerator(RoomCatalog(kRegularRoomTypes), RoomCatalog(kHubRoomTypes), resource, seed)
+{}
+
+ModelGenerator::ModelGenerator(
+    RoomCatalog regularRooms, RoomCatalog hubRooms, std::pmr::memory_resource* resource, uint64_t seed)
+      : regularRooms_(std::move(regularRooms)),
+        hubRooms_(std::move(hubRooms)),
+        resource_(resource),
+        seed_(seed),
+        rng_(Random::RNG(seed).split(Random::Streams::kModelGeneration)),
+        roomsRng_(Random::RNG(seed).split(Random::Streams::kRoomSizes))
+{}
+
 /*
 Generates dungeon with this structure with fixed grid side (example's for gidSide = 2):
 ┌───┐ ┌───┐
@@ -65,34 +92,36 @@ Model::Model ModelGenerator::generateGrid(size_t gridSide) const
 
     // 1. Create rooms and doors
     const size_t roomCount = gridSide * gridSide;
-    Model::Rooms rooms;
+    Model::Rooms rooms(resource_);
+    Model::Doors doors(resource_);
     rooms.reserve(roomCount);
+    doors.reserve(roomCount * kFourDoorsCount);
     for (size_t row = 0; row < gridSide; ++row) {
         for (size_t col = 0; col < gridSide; ++col) {
             const size_t roomId = getRoomId(row, col);
             const Model::Position centerPosition{
                 .x = col * (roomWidth + roomDistX), .y = (gridSide - row - 1) * (roomHeight + roomDistY)};
-            rooms.emplace_back(createRoomFourFixedDoors(roomId, roomWidth, roomHeight, centerPosition));
+            rooms.emplace_back(createRoomFourFixedDoors(roomId, roomWidth, roomHeight, doors, centerPosition));
         }
     }
 
     // 2. Add corridors
-    std::vector<Model::Corridor> corridors;
+    Model::Corridors corridors(resource_);
     corridors.reserve(roomCount);
     for (size_t row = 0; row < gridSide; ++row) {
         for (size_t col = 0; col < gridSide; ++col) {
             size_t curRoom = getRoomId(row, col);
             if (row < gridSide - 1) {
                 size_t roomDown = getRoomId(row + 1, col);
-                corridors.push_back({rooms[curRoom].doorsMutable()[0], rooms[roomDown].doorsMutable()[2]});
+                corridors.push_back({getFourDoorsDoorId(curRoom, 0), getFourDoorsDoorId(roomDown, 2)});
             }
             if (col < gridSide - 1) {
                 size_t roomRight = getRoomId(row, col + 1);
-                corridors.push_back({rooms[curRoom].doorsMutable()[3], rooms[roomRight].doorsMutable()[1]});
+                corridors.push_back({getFourDoorsDoorId(curRoom, 3), getFourDoorsDoorId(roomRight, 1)});
             }
         }
     }
-    return Model::Model{std::move(rooms), std::move(corridors)};
+    return Model::Model{std::move(rooms), std::move(doors), std::move(corridors)};
 }
 
 /// Generates a dungeon with doors in the center of the rooms.
@@ -100,27 +129,28 @@ Model::Model ModelGenerator::generateModelCenterDoors(size_t roomCount)
 {
     assert(roomCount > 0);
 
-    // 1. Create rooms and doors
-    Model::Rooms rooms(roomCount);
+    // 1. Create rooms and doors. Each room has a single door with the same index.
+    Model::Rooms rooms(roomCount, resource_);
+    Model::Doors doors(roomCount, resource_);
     for (size_t roomId = 0; roomId < roomCount; ++roomId) {
         const auto [roomWidth, roomHeight] = generateRoom(roomId);
-        std::vector<Model::Door> doors{Model::Door::createFixedDoor(roomId, Model::Position{.x = 0.0, .y = 0.0})};
-        rooms[roomId] = Model::Room(roomId, roomWidth, roomHeight, std::move(doors));
+        rooms[roomId] = Model::Room(roomId, roomWidth, roomHeight);
+        doors[roomId] = Model::Door::createFixedDoor(roomId, Model::Position{.x = 0.0, .y = 0.0});
     }
 
     // 2. Generate graph
-    GraphGenerator graphGenerator;
-    GraphGenerator::Graph graph = graphGenerator.generateConnectedGraph(roomCount, kAdditionalEdges);
+    GraphGenerator graphGenerator(resource_, seed_);
+    GraphGenerator::Graph graph = graphGenerator.generateConnectedGraph(roomCount, getAdditionalEdgesCount(roomCount));
 
     // 3. Add corridors
-    std::vector<Model::Corridor> corridors;
+    Model::Corridors corridors(resource_);
     corridors.reserve(roomCount - 1);
     for (size_t v = 0; v < roomCount; ++v) {
         for (const size_t u : graph[v]) {
-            corridors.push_back({rooms[v].doorsMutable()[0], rooms[u].doorsMutable()[0]});
+            corridors.push_back({v, u});
         }
     }
-    return Model::Model{std::move(rooms), std::move(corridors)};
+    return Model::Model{std::move(rooms), std::move(doors), std::move(corridors)};
 }
 
 /// Generates a dungeon with random tree structure with four fixed doors on each room's side.
@@ -128,15 +158,17 @@ Model::Model ModelGenerator::generateModelCenterDoors(size_t roomCount)
 Model::Model ModelGenerator::generateTreeFixedDoors(size_t roomCount)
 {
     assert(roomCount > 0);
-    Model::Rooms rooms;
+    Model::Rooms rooms(resource_);
+    Model::Doors doors(resource_);
     rooms.reserve(roomCount);
+    doors.reserve(roomCount * kFourDoorsCount);
     for (size_t roomId = 0; roomId < roomCount; ++roomId) {
         const auto [roomWidth, roomHeight] = generateRoom(roomId);
-        rooms.emplace_back(createRoomFourFixedDoors(roomId, roomWidth, roomHeight));
+        rooms.emplace_back(createRoomFourFixedDoors(roomId, roomWidth, roomHeight, doors));
     }
 
     // Algorithm: choose random room with id < roomId and connect them East-West or North-South
-    std::vector<Model::Corridor> corridors;
+    Model::Corridors corridors(resource_);
     std::vector<std::array<bool, 4>> availableDoors(roomCount, {true, true, true, true});
     for (size_t roomId = 1; roomId < roomCount; ++roomId) {
         bool connectionAdded = false;
@@ -158,13 +190,13 @@ Model::Model ModelGenerator::generateTreeFixedDoors(size_t roomCount)
             }
             size_t side = possibleConnections[Random::uniformDiscrete(possibleConnections.size() - 1, rng_)];
             size_t otherSide = (side + 2) % 4;
-            corridors.push_back({rooms[roomId].doorsMutable()[side], rooms[otherRoom].doorsMutable()[otherSide]});
+            corridors.push_back({getFourDoorsDoorId(roomId, side), getFourDoorsDoorId(otherRoom, otherSide)});
             availableDoors[roomId][side] = false;
             availableDoors[otherRoom][otherSide] = false;
             connectionAdded = true;
         }
     }
-    return Model::Model{std::move(rooms), std::move(corridors)};
+    return Model::Model{std::move(rooms), std::move(doors), std::move(corridors)};
 }
 
 /// Generates a dungeon with movable doors. Each edge just adds a pair of movable doors.
@@ -173,25 +205,20 @@ Model::Model ModelGenerator::generateModelMovableDoors(size_t roomCount)
     assert(roomCount > 0);
 
     // 1. Create rooms and doors
-    Model::Rooms rooms(roomCount);
+    Model::Rooms rooms(roomCount, resource_);
     for (size_t roomId = 0; roomId < roomCount; ++roomId) {
         const auto [roomWidth, roomHeight] = generateRoom(roomId);
-        rooms[roomId] = Model::Room(roomId, roomWidth, roomHeight, {});
+        rooms[roomId] = Model::Room(roomId, roomWidth, roomHeight);
     }
 
     // 2. Generate graph
-    GraphGenerator graphGenerator;
-    GraphGenerator::Graph graph = graphGenerator.generateConnectedGraph(roomCount, kAdditionalEdges);
+    GraphGenerator graphGenerator(resource_, seed_);
+    GraphGenerator::Graph graph = graphGenerator.generateConnectedGraph(roomCount, getAdditionalEdgesCount(roomCount));
 
     //  3. Add corridors: for each corridor we create a pair of movable rooms
-    // (!) We must be very careful with door references in Corridors
-    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
-        const size_t doorCount = graph[roomId].size();
-        rooms[roomId].doorsMutable().reserve(doorCount);
-    }
-
-    std::vector<Model::Corridor> corridors;
-    size_t freeDoorId = roomCount;
+    Model::Doors doors(resource_);
+    Model::Corridors corridors(resource_);
+    size_t freeDoorId = roomCount;  // Variables object id
     corridors.reserve(roomCount - 1);
     for (size_t room1 = 0; room1 < roomCount; ++room1) {
         for (size_t room2 : graph[room1]) {
@@ -199,37 +226,24 @@ Model::Model ModelGenerator::generateModelMovableDoors(size_t roomCount)
             if (room1 >= room2) {
                 continue;
             }
-            std::vector<Model::Door>& doors1 = rooms[room1].doorsMutable();
-            std::vector<Model::Door>& doors2 = rooms[room2].doorsMutable();
-            doors1.push_back(Model::Door::createMovableDoor(room1, freeDoorId++));
-            doors2.push_back(Model::Door::createMovableDoor(room2, freeDoorId++));
-            corridors.push_back({doors1.back(), doors2.back()});
+            doors.push_back(Model::Door::createMovableDoor(room1, freeDoorId++));
+            doors.push_back(Model::Door::createMovableDoor(room2, freeDoorId++));
+            corridors.push_back({doors.size() - 2, doors.size() - 1});
         }
     }
-    return Model::Model{std::move(rooms), std::move(corridors)};
+    return Model::Model{std::move(rooms), std::move(doors), std::move(corridors)};
 }
 
 RoomDimensions ModelGenerator::generateRoom(size_t roomId)
 {
     if (kUniformRooms) {
-        return kRegularRoomTypes[0].dimensions;
+        return regularRooms_.getType(0).dimensions;
     }
+    Random::RNG roomRng = roomsRng_.split(roomId);
     if (roomId == 0 && kEnableHubRoom) {
-        return generateRoomFromDistribution(kHubRoomTypes);
-    }
-    return generateRoomFromDistribution(kRegularRoomTypes);
-}
-
-RoomDimensions ModelGenerator::generateRoomFromDistribution(const std::vector<RoomType>& roomTypes)
-{
-    // TODO: be careful about weights copying. For now it's fine because we don't have a lot of room types.
-    const size_t n = roomTypes.size();
-    std::vector<double> weights(n);
-    for (size_t i = 0; i < n; ++i) {
-        weights[i] = roomTypes[i].distributionWeight;
+        return hubRooms_.sample(roomRng);
     }
-    const size_t generatedRoom = Random::fromDistribution(weights, rng_);
-    return roomTypes[generatedRoom].dimensions;
+    return regularRooms_.sample(roomRng);
 }
 
 }  // namespace DungeonGeneration
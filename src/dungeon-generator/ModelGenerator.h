@@ -1,16 +1,26 @@
 #pragma once
 
+#include <memory_resource>
+
 #include <model/Model.h>
 #include <utils/Random.h>
 
 #include "Defs.h"
+#include "RoomCatalog.h"
 
 namespace DungeonGeneration {
 
 // A class for generating model, i.e. rooms and connections between them.
 class ModelGenerator {
 public:
-    ModelGenerator() = default;
+    /// Model tables are allocated in `resource`. Everything random is derived from `seed`: each subsystem and each
+    /// room size has its own stream, so the same seed gives the same dungeon on every platform.
+    /// Room types are taken from the settings.
+    explicit ModelGenerator(
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(), uint64_t seed = Random::kGlobalSeed);
+    ModelGenerator(
+        RoomCatalog regularRooms, RoomCatalog hubRooms,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource(), uint64_t seed = Random::kGlobalSeed);
 
     // Generation functions with predefined structure.
     Model::Model generateGrid(size_t gridSide) const;
@@ -20,9 +30,13 @@ public:
 
 private:
     RoomDimensions generateRoom(size_t roomId);
-    RoomDimensions generateRoomFromDistribution(const std::vector<RoomType>& roomTypes);
 
-    Random::RNG rng_ = Random::RNG(Random::kGlobalSeed);  // random number generator
+    RoomCatalog regularRooms_;
+    RoomCatalog hubRooms_;
+    std::pmr::memory_resource* resource_;
+    uint64_t seed_;
+    Random::RNG rng_;       // random number generator
+    Random::RNG roomsRng_;  // split by room id, so room sizes don't depend on the generation order
 };
 
 }  // namespace DungeonGeneration
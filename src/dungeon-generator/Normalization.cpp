@@ -0,0 +1,43 @@
+#include "Normalization.h"
+
+namespace DungeonGeneration {
+
+namespace {
+
+double getRoomSize(const Model::Room& room)
+{
+    return (room.width() + room.height()) / 2;
+}
+
+}  // namespace
+
+AnalyticalSolver::Scaling makeCoordinatesNormalization(const Model::Model& model)
+{
+    const Model::Rooms& rooms = model.rooms();
+    if (rooms.empty()) {
+        return {};
+    }
+    double roomSizeSum = 0.0;
+    for (const Model::Room& room : rooms) {
+        roomSizeSum += getRoomSize(room);
+    }
+    const double averageRoomSize = roomSizeSum / rooms.size();
+
+    AnalyticalSolver::Scaling scaling{.cost = 1.0 / (averageRoomSize * averageRoomSize)};
+    scaling.variables.assign(model.getVariablesCount(), averageRoomSize);
+    for (const Model::Room& room : rooms) {
+        const auto [xId, yId] = room.getVariablesIds();
+        scaling.variables[xId] = room.width();
+        scaling.variables[yId] = room.height();
+    }
+    // Movable doors are bounded around the room center, bounds are mapped to [-1, 1]
+    const Model::VariablesBounds bounds = model.getVariablesBounds();
+    for (size_t varId = 0; varId < bounds.size(); ++varId) {
+        if (bounds[varId].has_value() && bounds[varId]->upperBound > bounds[varId]->lowerBound) {
+            scaling.variables[varId] = (bounds[varId]->upperBound - bounds[varId]->lowerBound) / 2;
+        }
+    }
+    return scaling;
+}
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <AnalyticalSolver.h>
+#include <model/Model.h>
+
+namespace DungeonGeneration {
+
+/// Diagonal preconditioning of the layout problem. Every variable is measured in its own units: room coordinates in the
+/// room's width and height, door offsets in the half-width of their bounds, so one solver step moves a small room and a
+/// large room by a similar fraction of their sizes. Cost is only brought to magnitude one by the average room size.
+/// Constraints are not scaled.
+AnalyticalSolver::Scaling makeCoordinatesNormalization(const Model::Model& model);
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,160 @@
+#include "ResultCache.h"
+
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace DungeonGeneration {
+
+namespace {
+
+// Entry format: header followed by (x, y) of every object as raw doubles
+constexpr uint32_t kEntryMagic = 0x43524744;  // "DGRC"
+constexpr uint32_t kEntryVersion = 1;
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t objectCnt;
+};
+
+static_assert(sizeof(Model::Position) == 2 * sizeof(double), "Positions are stored as raw doubles");
+
+}  // namespace
+
+ResultCache::ResultCache(std::optional<std::filesystem::path> directory, size_t memoryCapacity)
+      : directory_(std::move(directory)),
+        memoryCapacity_(memoryCapacity)
+{
+    if (!directory_.has_value()) {
+        return;
+    }
+    std::error_code errorCode;
+    std::filesystem::create_directories(directory_.value(), errorCode);
+    if (errorCode) {
+        std::cerr << "(!) ResultCache: failed to create " << directory_.value() << ": " << errorCode.message() << "\n";
+    }
+}
+
+std::optional<Model::Model> ResultCache::find(uint64_t key, const std::function<Model::Model()>& generateModel)
+{
+    {
+        std::lock_guard lock(mutex_);
+        const auto indexIt = lruIndex_.find(key);
+        if (indexIt != lruIndex_.end()) {
+            lruEntries_.splice(lruEntries_.begin(), lruEntries_, indexIt->second);
+            return indexIt->second->second;
+        }
+    }
+
+    // Disk lookup and regeneration don't need the lock
+    std::optional<Model::Positions> positions = loadPositions(key);
+    if (!positions.has_value()) {
+        return std::nullopt;
+    }
+    Model::Model model = generateModel();
+    if (positions->size() != model.getObjectCount()) {
+        std::cerr << "(!) ResultCache::find: entry " << getEntryPath(key) << " has " << positions->size()
+                  << " objects, model has " << model.getObjectCount() << "\n";
+        return std::nullopt;
+    }
+    model.setPositions(positions.value());
+
+    std::lock_guard lock(mutex_);
+    insertInMemory(key, model);
+    return model;
+}
+
+void ResultCache::insert(uint64_t key, const Model::Model& model)
+{
+    if (directory_.has_value() && !storePositions(key, model.getPositions())) {
+        std::cerr << "(!) ResultCache::insert: failed to write " << getEntryPath(key) << "\n";
+    }
+    std::lock_guard lock(mutex_);
+    insertInMemory(key, model);
+}
+
+std::filesystem::path ResultCache::getEntryPath(uint64_t key) const
+{
+    assert(directory_.has_value() && "ResultCache::getEntryPath: cache is memory-only");
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory_.value() / name;
+}
+
+std::optional<Model::Positions> ResultCache::loadPositions(uint64_t key) const
+{
+    if (!directory_.has_value()) {
+        return std::nullopt;
+    }
+    const std::filesystem::path entryPath = getEntryPath(key);
+    std::ifstream ifstream(entryPath, std::ios::binary);
+    if (!ifstream) {
+        return std::nullopt;  // Plain miss
+    }
+
+    EntryHeader header;
+    ifstream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!ifstream || header.magic != kEntryMagic || header.version != kEntryVersion || header.key != key) {
+        std::cerr << "(!) ResultCache::loadPositions: " << entryPath << " is not a valid entry\n";
+        return std::nullopt;
+    }
+    // Size is checked before allocating: object count of a corrupted entry can be anything
+    std::error_code errorCode;
+    const uintmax_t fileSize = std::filesystem::file_size(entryPath, errorCode);
+    if (errorCode || fileSize != sizeof(header) + header.objectCnt * sizeof(Model::Position)) {
+        std::cerr << "(!) ResultCache::loadPositions: " << entryPath << " has unexpected size\n";
+        return std::nullopt;
+    }
+    Model::Positions positions(header.objectCnt);
+    ifstream.read(reinterpret_cast<char*>(positions.data()), positions.size() * sizeof(Model::Position));
+    if (!ifstream) {
+        std::cerr << "(!) ResultCache::loadPositions: failed to read " << entryPath << "\n";
+        return std::nullopt;
+    }
+    return positions;
+}
+
+bool ResultCache::storePositions(uint64_t key, const Model::Positions& positions) const
+{
+    // Written into a temporary file first, so that readers never see a partial entry
+    const std::filesystem::path entryPath = getEntryPath(key);
+    std::filesystem::path temporaryPath = entryPath;
+    temporaryPath += ".tmp";
+    {
+        std::ofstream ofstream(temporaryPath, std::ios::binary);
+        const EntryHeader header{
+            .magic = kEntryMagic, .version = kEntryVersion, .key = key, .objectCnt = positions.size()};
+        ofstream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofstream.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(Model::Position));
+        if (!ofstream) {
+            return false;
+        }
+    }
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryPath, entryPath, errorCode);
+    return !errorCode;
+}
+
+void ResultCache::insertInMemory(uint64_t key, const Model::Model& model)
+{
+    if (memoryCapacity_ == 0) {
+        return;
+    }
+    const auto indexIt = lruIndex_.find(key);
+    if (indexIt != lruIndex_.end()) {
+        lruEntries_.erase(indexIt->second);
+        lruIndex_.erase(indexIt);
+    }
+    // Plain copy: cached models must not depend on arenas of the jobs that produced them
+    lruEntries_.emplace_front(key, Model::Model(model, std::pmr::get_default_resource()));
+    lruIndex_.emplace(key, lruEntries_.begin());
+    if (lruEntries_.size() > memoryCapacity_) {
+        lruIndex_.erase(lruEntries_.back().first);
+        lruEntries_.pop_back();
+    }
+}
+
+}  // namespace DungeonGeneration
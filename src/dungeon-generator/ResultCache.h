@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <model/Model.h>
+
+namespace DungeonGeneration {
+
+/// Solved layouts addressed by the hash of the full generation configuration. Recently used models are kept in memory,
+/// all of them are stored on disk if a directory is given. Only positions are stored on disk: the unsolved model is
+/// cheap to regenerate from the same configuration, unlike the solution. Thread-safe.
+class ResultCache {
+public:
+    /// At most `memoryCapacity` models are kept in memory
+    ResultCache(std::optional<std::filesystem::path> directory, size_t memoryCapacity);
+
+    /// On a disk hit the model is rebuilt by `generateModel` and stored positions are applied, if their count matches
+    /// the model. Corrupted or mismatched entries are treated as misses.
+    std::optional<Model::Model> find(uint64_t key, const std::function<Model::Model()>& generateModel);
+    void insert(uint64_t key, const Model::Model& model);
+
+private:
+    std::filesystem::path getEntryPath(uint64_t key) const;
+    std::optional<Model::Positions> loadPositions(uint64_t key) const;
+    bool storePositions(uint64_t key, const Model::Positions& positions) const;
+    /// mutex_ must be held
+    void insertInMemory(uint64_t key, const Model::Model& model);
+
+    std::optional<std::filesystem::path> directory_;
+    size_t memoryCapacity_;
+
+    std::mutex mutex_;
+    std::list<std::pair<uint64_t, Model::Model>> lruEntries_;  // The most recently used first
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Model::Model>>::iterator> lruIndex_;
+};
+
+}  // namespace DungeonGeneration
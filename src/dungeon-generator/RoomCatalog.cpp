@@ -0,0 +1,89 @@
+#include "RoomCatalog.h"
+
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace DungeonGeneration {
+
+namespace {
+
+std::vector<double> getWeights(const std::vector<RoomType>& roomTypes)
+{
+    std::vector<double> weights;
+    weights.reserve(roomTypes.size());
+    for (const RoomType& roomType : roomTypes) {
+        weights.push_back(roomType.distributionWeight);
+    }
+    return weights;
+}
+
+}  // namespace
+
+RoomCatalog::RoomCatalog(std::vector<RoomType> roomTypes)
+      : roomTypes_(std::move(roomTypes)),
+        aliasTable_(getWeights(roomTypes_))
+{}
+
+std::optional<RoomCatalog> RoomCatalog::loadFromFile(const std::filesystem::path& path)
+{
+    std::ifstream ifstream(path);
+    if (!ifstream) {
+        std::cerr << "(!) RoomCatalog::loadFromFile: failed to open " << path << "\n";
+        return std::nullopt;
+    }
+
+    std::vector<RoomType> roomTypes;
+    std::string line;
+    for (size_t lineId = 1; std::getline(ifstream, line); ++lineId) {
+        std::string firstToken;
+        if (!(std::istringstream(line) >> firstToken) || firstToken[0] == '#') {
+            continue;
+        }
+        std::istringstream lineStream(line);
+        RoomType roomType;
+        std::string rest;
+        if (!(lineStream >> roomType.dimensions.width >> roomType.dimensions.height >> roomType.distributionWeight) ||
+            (lineStream >> rest)) {
+            std::cerr << "(!) RoomCatalog::loadFromFile: " << path << ":" << lineId
+                      << ": expected \"width height weight\"\n";
+            return std::nullopt;
+        }
+        if (roomType.dimensions.width <= 0 || roomType.dimensions.height <= 0 || roomType.distributionWeight < 0) {
+            std::cerr << "(!) RoomCatalog::loadFromFile: " << path << ":" << lineId
+                      << ": sizes must be positive and weight non-negative\n";
+            return std::nullopt;
+        }
+        roomTypes.push_back(roomType);
+    }
+
+    double weightsSum = 0.0;
+    for (const RoomType& roomType : roomTypes) {
+        weightsSum += roomType.distributionWeight;
+    }
+    if (weightsSum <= 0) {
+        std::cerr << "(!) RoomCatalog::loadFromFile: " << path << " has no room types with positive weight\n";
+        return std::nullopt;
+    }
+    return RoomCatalog(std::move(roomTypes));
+}
+
+RoomDimensions RoomCatalog::sample(Random::RNG& rng) const
+{
+    return roomTypes_[aliasTable_.sample(rng)].dimensions;
+}
+
+const RoomType& RoomCatalog::getType(size_t typeId) const
+{
+    assert(typeId < roomTypes_.size() && "RoomCatalog::getType: invalid type id");
+    return roomTypes_[typeId];
+}
+
+size_t RoomCatalog::size() const
+{
+    return roomTypes_.size();
+}
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <utils/Random.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+
+/// Room types compiled into an alias table once, so that sampling a room is O(1) and doesn't allocate regardless of
+/// the catalog size.
+class RoomCatalog {
+public:
+    explicit RoomCatalog(std::vector<RoomType> roomTypes);
+
+    /// Text format: one room type per line as "width height weight". Empty lines and lines starting with '#' are
+    /// skipped. Returns nothing if the file can't be read or has no valid room types.
+    static std::optional<RoomCatalog> loadFromFile(const std::filesystem::path& path);
+
+    RoomDimensions sample(Random::RNG& rng) const;
+    const RoomType& getType(size_t typeId) const;
+    size_t size() const;
+
+private:
+    std::vector<RoomType> roomTypes_;
+    Random::AliasTable aliasTable_;
+};
+
+}  // namespace DungeonGeneration
@@ -1,16 +1,26 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <filesystem>
+#include <optional>
 #include <vector>
 
+#include <AnalyticalSolver.h>
+#include <callbacks/Defs.h>
+#include <utils/Random.h>
+
 #include "Defs.h"
 
 namespace DungeonGeneration {
 
+/// User seed: every random stream (model, graph, room sizes, shaking) is derived from it
+constexpr uint64_t kSeed = Random::kGlobalSeed;
+
 // Model generation settings
 constexpr DungeonType kDungeonType = DungeonType::MovableDoors;
 constexpr size_t kRoomCount = 100;
-static constexpr size_t kAdditionalEdges = kRoomCount * 0.1;  /// Edge count to add to the tree
+constexpr double kAdditionalEdgesRatio = 0.1;  // Edges added to the tree per room
 const std::vector<RoomType> kRegularRoomTypes = {
     {{20, 20},    1},
     {{30, 30},  0.5},
@@ -18,16 +28,38 @@ const std::vector<RoomType> kRegularRoomTypes = {
     {{40, 20},  0.3},
     {{40, 40}, 0.25}
 };
+/// If set, regular room types are loaded from this file instead (see RoomCatalog::loadFromFile for the format)
+const std::optional<std::filesystem::path> kRoomCatalogPath = std::nullopt;
 
 // Solver rerun
 constexpr size_t kSolverRerunCount = 0;
+/// Save solver state after the first solve and restore it on the next launch of the same configuration. A finished
+/// solve is skipped (handy for rerun experiments), an interrupted one is continued.
+constexpr bool kUseSolverCheckpoint = false;
+
+// Solver iterations are recorded into a single trajectory file (see callbacks/Trajectory.h, replay it with
+// trajectory_replay) instead of an SVG per iteration. Only when the output directory is set.
+constexpr bool kRecordTrajectory = true;
+constexpr double kTrajectoryQuantizationStep = 1.0 / 64;
+
+// Wall-clock limit for each solver run: the first solve, every rerun and the local repair pass. On timeout the best
+// iterate found so far is used as a result.
+constexpr std::optional<std::chrono::milliseconds> kSolverTimeLimit = std::nullopt;
+
+// Local repair of the final solution
+constexpr bool kEnableLocalRepair = true;
+constexpr size_t kRepairMaxAttempts = 3;
+constexpr size_t kRepairNeighborhoodDepth = 1;  // How many corridors away from defects rooms are allowed to move
+constexpr double kRepairOverlapMargin = 1.0;    // Gap in average room sides below which rooms are kept apart
+constexpr double kRepairInitialPenalty = 1.0;   // ALMM penalty of the first repair iteration
 
 // Hub
 static constexpr bool kEnableHubRoom = true;
 const std::vector<RoomType> kHubRoomTypes{
     {{60, 60}, 1}
 };
-static constexpr size_t kHubNeighborsCount = std::min<size_t>(10, kRoomCount * 0.1);
+constexpr size_t kMaxHubNeighborsCount = 10;
+constexpr double kHubNeighborsRatio = 0.1;  // Hub neighbors per room, up to kMaxHubNeighborsCount
 
 // Callback settings
 constexpr bool kEnablePushForce = true;
@@ -36,8 +68,51 @@ constexpr double kPushForceRange = 5.0;
 
 constexpr double kRoomBloating = 1.5;
 
+/// Corridors crossing each other or passing through rooms are penalized, see callbacks/CorridorCrossing.h. Off by
+/// default: the scale and margin below aren't tuned yet, and the term changes the cost between ALMM iterations as its
+/// candidate pairs are rebuilt, so the costs that updateBestIterate compares aren't of the same function.
+constexpr bool kEnableCorridorCrossing = false;
+constexpr double kCorridorCrossingScale = 1000.0;  // Cost of two corridors bisecting each other
+constexpr double kCorridorCrossingMargin = 10.0;   // Movement expected during an ALMM iteration, in model units
+
+/// Mixed precision evaluates push force and room overlaps in float, the final solution may differ in the last digits.
+/// It's slower than double on push_force_benchmark (500 rooms, AVX2): loading and converting double coordinates costs
+/// more than the wider lanes save.
+constexpr Callbacks::Precision kCallbacksPrecision = Callbacks::Precision::Double;
+
+/// Diagonal preconditioning of variables, see Normalization.h. Off until
+/// solver_iterations_benchmark shows fewer iterations with it.
+constexpr bool kNormalizeCoordinates = false;
+
+const SolverParameters kDefaultSolverParameters{
+    .seed = kSeed,
+    .muFactor = AnalyticalSolver::kDefaultMuFactor,
+    .pushForceScale = kPushForceScale,
+    .pushForceRange = kPushForceRange,
+    .roomBloating = kRoomBloating,
+    .normalizeCoordinates = kNormalizeCoordinates,
+};
+
+// Portfolio solving: several solvers with perturbed parameters run in parallel, the first good result cancels the rest
+constexpr bool kEnablePortfolio = false;
+constexpr size_t kPortfolioSize = 4;
+constexpr size_t kPortfolioAcceptableDefects = 0;  // Results with at most this many defects are good enough
+
+// Result cache: solved layouts are reused for identical configurations (all settings above and solver parameters).
+/// The key doesn't cover the code, so bump the version after changing generation or solving.
+constexpr bool kEnableResultCache = false;
+constexpr size_t kResultCacheMemoryCapacity = 16;  // Models kept in memory, the rest are loaded from disk
+constexpr uint64_t kResultCacheVersion = 1;
+
+// Work memory: freed arena blocks are kept for the following generation jobs, up to this many bytes
+constexpr size_t kWorkMemoryCacheCapacity = size_t(256) << 20;
+
+// Chunked world generation, see WorldGenerator
+constexpr size_t kWorldChunkRoomCount = 50;
+constexpr size_t kWorldFrontierRoomCount = 5;
+
 // Misc. (more of a test settings)
-static constexpr bool kUniformRooms = false;  /// If enabled, only generates the first room type
+static constexpr bool kUniformRooms = false;  // If enabled, only generates the first room type
 constexpr TreeGenerationStrategy kTreeGenerationStrategy = TreeGenerationStrategy::RandomChildCount;
 
 }  // namespace DungeonGeneration
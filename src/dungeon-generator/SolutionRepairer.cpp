@@ -0,0 +1,229 @@
+#include "SolutionRepairer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <utility>
+
+#include <AnalyticalSolver.h>
+#include <callbacks/CorridorCrossing.h>
+#include <callbacks/CorridorLength.h>
+#include <callbacks/PushForce.h>
+#include <callbacks/RoomOverlap.h>
+#include <utils/GridIndex.h>
+
+#include "Normalization.h"
+#include "Settings.h"
+
+namespace DungeonGeneration {
+
+namespace {
+
+/// Pairs of rooms that need overlap constraints during repair: at least one of the rooms is active, and their gap is
+/// below kRepairOverlapMargin average room sides. Rooms further apart can't reach each other in a local repair.
+std::vector<std::pair<size_t, size_t>> findRoomPairsToSeparate(
+    const Model::Model& model, const std::vector<bool>& activeRooms)
+{
+    const Model::Rooms& rooms = model.rooms();
+    double roomSideSum = 0.0;
+    for (const Model::Room& room : rooms) {
+        roomSideSum += (room.width() + room.height()) / 2;
+    }
+    const double averageRoomSide = rooms.empty() ? 1.0 : roomSideSum / static_cast<double>(rooms.size());
+    const double halfMargin = kRepairOverlapMargin * averageRoomSide / 2;
+
+    constexpr double kInfinity = std::numeric_limits<double>::infinity();
+    std::vector<Spatial::Box> boxes;
+    boxes.reserve(rooms.size());
+    Spatial::Box bounds{.minX = kInfinity, .minY = kInfinity, .maxX = -kInfinity, .maxY = -kInfinity};
+    for (const Model::Room& room : rooms) {
+        const Model::Position lbPos = room.getLBPosition();
+        boxes.push_back(Spatial::Box{
+            .minX = lbPos.x - halfMargin,
+            .minY = lbPos.y - halfMargin,
+            .maxX = lbPos.x + room.width() + halfMargin,
+            .maxY = lbPos.y + room.height() + halfMargin});
+        bounds.minX = std::min(bounds.minX, boxes.back().minX);
+        bounds.minY = std::min(bounds.minY, boxes.back().minY);
+        bounds.maxX = std::max(bounds.maxX, boxes.back().maxX);
+        bounds.maxY = std::max(bounds.maxY, boxes.back().maxY);
+    }
+
+    std::vector<std::pair<size_t, size_t>> pairs;
+    if (rooms.empty()) {
+        return pairs;
+    }
+    Spatial::GridIndex index(bounds, averageRoomSide + 2 * halfMargin);
+    for (size_t roomId = 0; roomId < rooms.size(); ++roomId) {
+        index.insert(roomId, boxes[roomId]);
+    }
+    std::vector<size_t> found;
+    for (size_t roomId = 0; roomId < rooms.size(); ++roomId) {
+        if (!activeRooms[roomId]) {
+            continue;
+        }
+        index.query(boxes[roomId], found);
+        for (const size_t otherRoomId : found) {
+            // Pairs of two active rooms are found twice, the one with the smaller id first is taken
+            if (otherRoomId != roomId && (!activeRooms[otherRoomId] || otherRoomId > roomId)) {
+                pairs.emplace_back(std::min(roomId, otherRoomId), std::max(roomId, otherRoomId));
+            }
+        }
+    }
+    return pairs;
+}
+
+/// Solver variables of the current model positions
+std::vector<double> getVariablesValues(const Model::Model& model, const Model::Positions& positions)
+{
+    std::vector<double> x(model.getVariablesCount());
+    for (size_t objId = 0; objId < positions.size(); ++objId) {
+        const auto [xId, yId] = Model::VarUtils::getVariablesIds(objId);
+        x[xId] = positions[objId].x;
+        x[yId] = positions[objId].y;
+    }
+    return x;
+}
+
+}  // namespace
+
+SolutionRepairer::SolutionRepairer(const SolverParameters& parameters)
+      : parameters_(parameters)
+{}
+
+bool SolutionRepairer::repair(
+    Model::Model& model, const AnalyticalSolver::CancellationToken* cancellationToken,
+    std::optional<AnalyticalSolver::Clock::time_point> deadline) const
+{
+    for (size_t attempt = 0; attempt < kRepairMaxAttempts; ++attempt) {
+        if ((cancellationToken != nullptr && cancellationToken->isCancelled()) ||
+            (deadline.has_value() && AnalyticalSolver::Clock::now() >= deadline.value())) {
+            break;
+        }
+        const Model::Validation::Defects defects = Model::Validation::findDefects(model);
+        std::cerr << "SolutionRepairer: attempt " << attempt << ", overlapping rooms: "
+                  << defects.overlappingRooms.size() << ", crossing corridors: " << defects.crossingCorridors.size()
+                  << "\n";
+        if (defects.empty()) {
+            return true;
+        }
+        reoptimize(model, findRoomsToRepair(model, defects), defects.count(), cancellationToken, deadline);
+    }
+    return Model::Validation::findDefects(model).empty();
+}
+
+std::vector<bool> SolutionRepairer::findRoomsToRepair(
+    const Model::Model& model, const Model::Validation::Defects& defects) const
+{
+    const Model::Rooms& rooms = model.rooms();
+    const Model::Corridors& corridors = model.corridors();
+    std::vector<bool> activeRooms(rooms.size(), false);
+    for (const auto [roomId1, roomId2] : defects.overlappingRooms) {
+        activeRooms[roomId1] = true;
+        activeRooms[roomId2] = true;
+    }
+    for (const auto [corridorId1, corridorId2] : defects.crossingCorridors) {
+        for (const size_t corridorId : {corridorId1, corridorId2}) {
+            const auto [roomId1, roomId2] = model.getCorridorRooms(corridors[corridorId]);
+            activeRooms[roomId1] = true;
+            activeRooms[roomId2] = true;
+        }
+    }
+
+    // Expand the neighborhood along corridors so that defective rooms can drag their neighbors along
+    for (size_t depth = 0; depth < kRepairNeighborhoodDepth; ++depth) {
+        std::vector<bool> expandedRooms = activeRooms;
+        for (const Model::Corridor& corridor : corridors) {
+            const auto [roomId1, roomId2] = model.getCorridorRooms(corridor);
+            if (activeRooms[roomId1] || activeRooms[roomId2]) {
+                expandedRooms[roomId1] = true;
+                expandedRooms[roomId2] = true;
+            }
+        }
+        activeRooms = std::move(expandedRooms);
+    }
+    return activeRooms;
+}
+
+void SolutionRepairer::reoptimize(
+    Model::Model& model, const std::vector<bool>& activeRooms, size_t defectsCount,
+    const AnalyticalSolver::CancellationToken* cancellationToken,
+    std::optional<AnalyticalSolver::Clock::time_point> deadline) const
+{
+    const Model::Rooms& rooms = model.rooms();
+    const Model::Positions positions = model.getPositions();
+
+    // Pin every variable that doesn't belong to an active room (or to its doors) to its current value
+    Model::VariablesBounds variablesBounds = model.getVariablesBounds();
+    auto pinObject = [&variablesBounds, &positions](size_t objId) {
+        const auto [xId, yId] = Model::VarUtils::getVariablesIds(objId);
+        variablesBounds[xId] = Model::Interval{.lowerBound = positions[objId].x, .upperBound = positions[objId].x};
+        variablesBounds[yId] = Model::Interval{.lowerBound = positions[objId].y, .upperBound = positions[objId].y};
+    };
+    for (const Model::Room& room : rooms) {
+        if (!activeRooms[room.id()]) {
+            pinObject(room.id());
+        }
+    }
+    for (const Model::Door& door : model.doors()) {
+        if (door.isMovable() && !activeRooms[door.parentRoomId()]) {
+            pinObject(door.varObjectId());
+        }
+    }
+
+    // Only terms that involve at least one active room are left. Corridor crossings are penalized under the same
+    // setting as in the main solve: refreshing their candidates changes the cost between ALMM iterations, and repair
+    // is the path where the best iterate is restored after a deadline or cancellation.
+    std::vector<Callbacks::FGEval> costFunctions{Callbacks::CorridorLength(model, activeRooms)};
+    if (kEnablePushForce) {
+        costFunctions.push_back(Callbacks::PushForce(
+            model, parameters_.pushForceScale, parameters_.pushForceRange, activeRooms, kCallbacksPrecision));
+    }
+    std::optional<Callbacks::CorridorCrossing> corridorCrossing;
+    std::vector<Callbacks::ReaderCallback> readerCallbacks;
+    if (kEnableCorridorCrossing) {
+        corridorCrossing.emplace(model, kCorridorCrossingScale, kCorridorCrossingMargin);
+        corridorCrossing->updateCandidates(getVariablesValues(model, positions).data());
+        costFunctions.push_back(std::cref(corridorCrossing.value()));
+        readerCallbacks.push_back(std::ref(corridorCrossing.value()));
+    }
+
+    std::vector<Callbacks::CEqFGEval> penaltyFunctions;
+    const std::vector<std::pair<size_t, size_t>> roomPairs = findRoomPairsToSeparate(model, activeRooms);
+    for (const auto& [roomId1, roomId2] : roomPairs) {
+        penaltyFunctions.push_back(
+            Callbacks::RoomOverlap(rooms[roomId1], rooms[roomId2], parameters_.roomBloating, kCallbacksPrecision));
+    }
+
+    // The layout is nearly feasible, so overlaps are penalized from the first iteration
+    AnalyticalSolver::SolverOptions options{
+        .muFactor = parameters_.muFactor,
+        .initialMu = kRepairInitialPenalty,
+        .cancellationToken = cancellationToken,
+        .deadline = deadline};
+    if (parameters_.normalizeCoordinates) {
+        options.scaling = makeCoordinatesNormalization(model);
+    }
+    AnalyticalSolver::AnalyticalSolver solver(
+        model.getObjectCount(), model.getVariablesCount(), std::move(variablesBounds), std::move(costFunctions),
+        std::move(penaltyFunctions), {}, {}, std::move(readerCallbacks), options);
+    if (!solver.setInitialSolution(positions)) {
+        std::cerr << "(!) SolutionRepairer::reoptimize: failed to set initial solution\n";
+        return;
+    }
+    solver.solve();
+    model.setPositionsFromVars(solver.getSolutionData());
+
+    // Re-solve may also make things worse, e.g. push a room into a neighbour that wasn't a candidate
+    const size_t newDefectsCount = Model::Validation::findDefects(model).count();
+    if (newDefectsCount > defectsCount) {
+        std::cerr << "SolutionRepairer: re-solve increased defects from " << defectsCount << " to " << newDefectsCount
+                  << ", reverted\n";
+        model.setPositions(positions);
+    }
+}
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <optional>
+
+#include <AnalyticalSolver.h>
+#include <CancellationToken.h>
+#include <model/Model.h>
+#include <model/Validation.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+
+// Fixes residual defects of the solved model (overlapping rooms, crossing corridors) without a full re-solve.
+// Only a small neighborhood of defective rooms is re-optimized, everything else stays fixed. Crossings are only
+// penalized during the re-solve if kEnableCorridorCrossing is set.
+class SolutionRepairer {
+public:
+    explicit SolutionRepairer(const SolverParameters& parameters);
+
+    /// Returns whether all defects were fixed. Stops early once `cancellationToken` is cancelled or `deadline` passes;
+    /// the remaining time is shared by all repair attempts.
+    bool repair(
+        Model::Model& model, const AnalyticalSolver::CancellationToken* cancellationToken = nullptr,
+        std::optional<AnalyticalSolver::Clock::time_point> deadline = std::nullopt) const;
+
+private:
+    /// Marks rooms that are allowed to move during repair
+    std::vector<bool> findRoomsToRepair(const Model::Model& model, const Model::Validation::Defects& defects) const;
+    /// Re-solves the active rooms. The new layout is kept only if it has at most `defectsCount` defects.
+    void reoptimize(
+        Model::Model& model, const std::vector<bool>& activeRooms, size_t defectsCount,
+        const AnalyticalSolver::CancellationToken* cancellationToken,
+        std::optional<AnalyticalSolver::Clock::time_point> deadline) const;
+
+    SolverParameters parameters_;
+};
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,110 @@
+#include "WorkerPool.h"
+
+#include <iostream>
+
+#include "DungeonGenerator.h"
+#include "Settings.h"
+
+namespace DungeonGeneration {
+
+namespace {
+
+/// Upper bound of the solver dimensions for a dungeon of `roomCount` rooms: every corridor has two movable doors, and
+/// every pair of rooms has an overlap constraint.
+AnalyticalSolver::SolverWorkspace createWorkspace(size_t roomCount)
+{
+    const size_t corridorCount = roomCount + static_cast<size_t>(roomCount * kAdditionalEdgesRatio);
+    const size_t objectCount = roomCount + 2 * corridorCount;
+    const size_t roomPairsCount = (roomCount > 0 ? roomCount * (roomCount - 1) / 2 : 0);
+    return AnalyticalSolver::SolverWorkspace(2 * objectCount, roomPairsCount);
+}
+
+}  // namespace
+
+WorkerPool::WorkerPool(const DungeonGenerator& generator, size_t workerCount, size_t roomCapacity)
+      : generator_(generator)
+{
+    workers_.reserve(workerCount);
+    for (size_t workerId = 0; workerId < workerCount; ++workerId) {
+        workers_.emplace_back(&WorkerPool::runWorker, this, roomCapacity);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    jobAdded_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+std::future<GenerationResult> WorkerPool::submit(const GenerationConfig& config)
+{
+    Job job{.config = config, .promise = {}, .submitTimestamp = Clock::now()};
+    std::future<GenerationResult> result = job.promise.get_future();
+    {
+        std::lock_guard lock(mutex_);
+        jobs_.push_back(std::move(job));
+    }
+    jobAdded_.notify_one();
+    return result;
+}
+
+std::optional<std::future<GenerationResult>> WorkerPool::trySubmit(const GenerationConfig& config, size_t maxQueueSize)
+{
+    Job job{.config = config, .promise = {}, .submitTimestamp = Clock::now()};
+    std::future<GenerationResult> result = job.promise.get_future();
+    {
+        std::lock_guard lock(mutex_);
+        if (jobs_.size() >= maxQueueSize) {
+            return std::nullopt;
+        }
+        jobs_.push_back(std::move(job));
+    }
+    jobAdded_.notify_one();
+    return result;
+}
+
+size_t WorkerPool::getQueueSize() const
+{
+    std::lock_guard lock(mutex_);
+    return jobs_.size();
+}
+
+size_t WorkerPool::getWorkerCount() const
+{
+    return workers_.size();
+}
+
+void WorkerPool::runWorker(size_t roomCapacity)
+{
+    AnalyticalSolver::SolverWorkspace workspace = createWorkspace(roomCapacity);
+    while (true) {
+        std::unique_lock lock(mutex_);
+        jobAdded_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+            return;  // Stopping and nothing is left
+        }
+        Job job = std::move(jobs_.front());
+        jobs_.pop_front();
+        lock.unlock();
+
+        const Clock::time_point startTimestamp = Clock::now();
+        try {
+            GenerationResult result;
+            result.model = generator_.generateDungeon(job.config, &result.statistics, &workspace);
+            result.queueSeconds = std::chrono::duration<double>(startTimestamp - job.submitTimestamp).count();
+            result.generationSeconds = std::chrono::duration<double>(Clock::now() - startTimestamp).count();
+            job.promise.set_value(std::move(result));
+        } catch (...) {
+            std::cerr << "(!) WorkerPool::runWorker: generation failed\n";
+            job.promise.set_exception(std::current_exception());
+        }
+    }
+}
+
+}  // namespace DungeonGeneration
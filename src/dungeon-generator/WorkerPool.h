@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <AnalyticalSolver.h>
+#include <model/Model.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+
+class DungeonGenerator;
+
+struct GenerationResult {
+    Model::Model model;
+    AnalyticalSolver::SolveStatistics statistics;
+    double queueSeconds = 0.0;       // From submission until a worker picked the job up
+    double generationSeconds = 0.0;  // Model generation and solving
+};
+
+/// Fixed set of threads that generate dungeons from a shared queue. Each worker keeps its own solver workspace, sized
+/// for `roomCapacity` rooms up front, so consecutive dungeons don't allocate solver buffers. PETSc is initialized
+/// once by the generator, which must outlive the pool. Solvers run concurrently only if PETSc is thread-safe, see
+/// AnalyticalSolver::isPETScThreadSafe.
+class WorkerPool {
+public:
+    WorkerPool(const DungeonGenerator& generator, size_t workerCount, size_t roomCapacity);
+    /// Jobs that are already queued are finished first
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    std::future<GenerationResult> submit(const GenerationConfig& config);
+    /// Same as submit, but the job is rejected if `maxQueueSize` jobs are already waiting
+    std::optional<std::future<GenerationResult>> trySubmit(const GenerationConfig& config, size_t maxQueueSize);
+    /// Jobs that no worker has picked up yet
+    size_t getQueueSize() const;
+    size_t getWorkerCount() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Job {
+        GenerationConfig config;
+        std::promise<GenerationResult> promise;
+        Clock::time_point submitTimestamp;
+    };
+
+    void runWorker(size_t roomCapacity);
+
+    const DungeonGenerator& generator_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable jobAdded_;
+    std::deque<Job> jobs_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> workers_;  // Declared last: workers use everything above
+};
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,215 @@
+#include "WorldGenerator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+#include <callbacks/CorridorLength.h>
+#include <callbacks/RoomPairTerms.h>
+#include <model/Validation.h>
+
+#include "ModelGenerator.h"
+#include "Normalization.h"
+#include "Settings.h"
+
+namespace DungeonGeneration {
+
+namespace {
+
+double getRightEdge(const Model::Room& room)
+{
+    return room.getCenterPosition().x + room.width() / 2;
+}
+
+}  // namespace
+
+WorldGenerator::WorldGenerator(const WorldConfig& config)
+      : config_(config),
+        workMemory_(std::pmr::new_delete_resource(), kWorkMemoryCacheCapacity)
+{
+    assert(config_.chunkRoomCount > 0 && "Chunks must have rooms");
+}
+
+WorldConfig WorldGenerator::getDefaultConfig()
+{
+    return WorldConfig{
+        .seed = kSeed,
+        .chunkRoomCount = kWorldChunkRoomCount,
+        .frontierRoomCount = kWorldFrontierRoomCount,
+        .solverParameters = kDefaultSolverParameters};
+}
+
+WorldChunk WorldGenerator::generateNextChunk()
+{
+    const size_t chunkId = nextChunkId_++;
+    Random::RNG rng = Random::RNG(config_.seed).split(Random::Streams::kWorldChunks).split(chunkId);
+
+    Memory::Arena arena(&workMemory_);
+    Model::Model model = buildChunkModel(rng, arena.resource());
+    solveChunk(model, rng, arena.resource());
+
+    const size_t pinnedRoomCount = frontier_.size();
+    std::vector<uint64_t> globalRoomIds(model.rooms().size());
+    for (size_t roomId = 0; roomId < pinnedRoomCount; ++roomId) {
+        globalRoomIds[roomId] = frontier_[roomId].globalId;
+    }
+    std::iota(globalRoomIds.begin() + pinnedRoomCount, globalRoomIds.end(), nextGlobalRoomId_);
+    nextGlobalRoomId_ += model.rooms().size() - pinnedRoomCount;
+    advanceFrontier(model, globalRoomIds);
+
+    // Chunk must outlive the arena
+    return WorldChunk{
+        .chunkId = chunkId,
+        .model = Model::Model(model, std::pmr::get_default_resource()),
+        .pinnedRoomCount = pinnedRoomCount,
+        .globalRoomIds = std::move(globalRoomIds)};
+}
+
+void WorldGenerator::stream(const std::function<bool(WorldChunk&&)>& consumer)
+{
+    while (consumer(generateNextChunk())) {}
+}
+
+Model::Model WorldGenerator::buildChunkModel(Random::RNG& rng, std::pmr::memory_resource* resource) const
+{
+    ModelGenerator modelGenerator(resource, rng());
+    const Model::Model region = modelGenerator.generateModelMovableDoors(config_.chunkRoomCount);
+    const size_t pinnedRoomCount = frontier_.size();
+    const size_t newRoomCount = region.rooms().size();
+
+    // Every object id of the region is shifted by the pinned rooms
+    Model::Rooms rooms(resource);
+    rooms.reserve(pinnedRoomCount + newRoomCount);
+    for (size_t roomId = 0; roomId < pinnedRoomCount; ++roomId) {
+        const FrontierRoom& frontierRoom = frontier_[roomId];
+        rooms.emplace_back(roomId, frontierRoom.width, frontierRoom.height, frontierRoom.center);
+    }
+    for (const Model::Room& room : region.rooms()) {
+        rooms.emplace_back(pinnedRoomCount + room.id(), room.width(), room.height());
+    }
+    Model::Doors doors(resource);
+    doors.reserve(region.doors().size() + 2 * pinnedRoomCount);
+    for (const Model::Door& door : region.doors()) {
+        const size_t parentRoomId = pinnedRoomCount + door.parentRoomId();
+        doors.push_back(
+            door.isMovable() ? Model::Door::createMovableDoor(parentRoomId, pinnedRoomCount + door.varObjectId())
+                             : Model::Door::createFixedDoor(parentRoomId, door.shift()));
+    }
+    Model::Corridors corridors(region.corridors(), resource);
+
+    // Each frontier room is connected to a random new room
+    size_t nextObjectId = pinnedRoomCount + region.getObjectCount();
+    for (size_t roomId = 0; roomId < pinnedRoomCount; ++roomId) {
+        const size_t newRoomId = pinnedRoomCount + Random::uniformDiscrete(newRoomCount - 1, rng);
+        doors.push_back(Model::Door::createMovableDoor(roomId, nextObjectId++));
+        doors.push_back(Model::Door::createMovableDoor(newRoomId, nextObjectId++));
+        corridors.push_back(Model::Corridor{.door1Id = doors.size() - 2, .door2Id = doors.size() - 1});
+    }
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+void WorldGenerator::solveChunk(Model::Model& model, Random::RNG& rng, std::pmr::memory_resource* resource) const
+{
+    const Model::Rooms& rooms = model.rooms();
+    const size_t pinnedRoomCount = frontier_.size();
+    std::vector<bool> activeRooms(rooms.size(), true);
+    std::fill_n(activeRooms.begin(), pinnedRoomCount, false);
+
+    // New rooms start scattered over a square twice as wide as their total area, next to the frontier
+    double newRoomsArea = 0.0;
+    for (size_t roomId = pinnedRoomCount; roomId < rooms.size(); ++roomId) {
+        newRoomsArea += rooms[roomId].width() * rooms[roomId].height();
+    }
+    const double spread = 2.0 * std::sqrt(newRoomsArea);
+    double originY = 0.0;
+    for (const FrontierRoom& frontierRoom : frontier_) {
+        originY += frontierRoom.center.y / frontier_.size();
+    }
+
+    // Pinned rooms keep their positions, new rooms can't cross the wall: they don't overlap anything emitted before
+    Model::VariablesBounds variablesBounds = model.getVariablesBounds();
+    Model::Positions initialPositions(model.getObjectCount(), Model::Position{.x = 0.0, .y = 0.0});
+    for (const Model::Room& room : rooms) {
+        const auto [xId, yId] = room.getVariablesIds();
+        if (!activeRooms[room.id()]) {
+            const Model::Position center = room.getCenterPosition();
+            variablesBounds[xId] = Model::Interval{.lowerBound = center.x, .upperBound = center.x};
+            variablesBounds[yId] = Model::Interval{.lowerBound = center.y, .upperBound = center.y};
+            initialPositions[room.id()] = center;
+            continue;
+        }
+        const double minX = wallX_.value_or(-spread / 2) + room.width() / 2;
+        if (wallX_.has_value()) {
+            variablesBounds[xId] =
+                Model::Interval{.lowerBound = minX, .upperBound = std::numeric_limits<double>::infinity()};
+        }
+        initialPositions[room.id()] = Model::Position{
+            .x = minX + Random::uniformRangeContinuous(0.0, spread, rng),
+            .y = originY + Random::uniformRangeContinuous(-spread / 2, spread / 2, rng)};
+    }
+
+    // Callback objects must outlive the solver
+    const SolverParameters& parameters = config_.solverParameters;
+    const Callbacks::CorridorLength corridorLength(model, activeRooms, resource);
+    std::vector<Callbacks::FGEval> costFunctions{std::cref(corridorLength)};
+    // Pinned rooms lie behind the wall, so only pairs of new rooms can overlap
+    const size_t newRoomCount = rooms.size() - pinnedRoomCount;
+    std::vector<std::pair<size_t, size_t>> roomPairs;
+    roomPairs.reserve(newRoomCount * (newRoomCount - 1) / 2);
+    for (size_t i = pinnedRoomCount; i < rooms.size(); ++i) {
+        for (size_t j = i + 1; j < rooms.size(); ++j) {
+            roomPairs.emplace_back(i, j);
+        }
+    }
+    const Callbacks::RoomPairTerms roomPairTerms(
+        model, roomPairs, parameters.roomBloating, kEnablePushForce ? parameters.pushForceScale : 0.0,
+        parameters.pushForceRange, activeRooms, kCallbacksPrecision, resource);
+    std::vector<AnalyticalSolver::FusedTerms> fusedTerms{
+        {.evaluate = std::cref(roomPairTerms), .constraintCount = roomPairTerms.getConstraintCount()}};
+
+    AnalyticalSolver::SolverOptions options{.muFactor = parameters.muFactor};
+    if (parameters.normalizeCoordinates) {
+        options.scaling = makeCoordinatesNormalization(model);
+    }
+    AnalyticalSolver::AnalyticalSolver solver(
+        model.getObjectCount(), model.getVariablesCount(), std::move(variablesBounds), std::move(costFunctions), {},
+        std::move(fusedTerms), {}, {}, options);
+    if (!solver.setInitialSolution(initialPositions)) {
+        std::cerr << "(!) WorldGenerator::solveChunk: failed to set initial solution\n";
+    }
+    solver.solve();
+    model.setPositionsFromVars(solver.getSolutionData());
+    std::cerr << "WorldGenerator: chunk solved with " << Model::Validation::findDefects(model).count() << " defects\n";
+}
+
+void WorldGenerator::advanceFrontier(const Model::Model& model, const std::vector<uint64_t>& globalRoomIds)
+{
+    const Model::Rooms& rooms = model.rooms();
+    const size_t pinnedRoomCount = frontier_.size();
+    std::vector<size_t> newRoomIds(rooms.size() - pinnedRoomCount);
+    std::iota(newRoomIds.begin(), newRoomIds.end(), pinnedRoomCount);
+    const size_t frontierSize = std::min(config_.frontierRoomCount, newRoomIds.size());
+    std::partial_sort(
+        newRoomIds.begin(), newRoomIds.begin() + frontierSize, newRoomIds.end(), [&rooms](size_t id1, size_t id2) {
+            return getRightEdge(rooms[id1]) > getRightEdge(rooms[id2]);
+        });
+
+    for (const size_t roomId : newRoomIds) {
+        const double rightEdge = getRightEdge(rooms[roomId]);
+        wallX_ = (wallX_.has_value() ? std::max(wallX_.value(), rightEdge) : rightEdge);
+    }
+    frontier_.clear();
+    for (size_t i = 0; i < frontierSize; ++i) {
+        const Model::Room& room = rooms[newRoomIds[i]];
+        frontier_.push_back(FrontierRoom{
+            .globalId = globalRoomIds[room.id()],
+            .width = room.width(),
+            .height = room.height(),
+            .center = room.getCenterPosition()});
+    }
+}
+
+}  // namespace DungeonGeneration
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+#include <AnalyticalSolver.h>
+#include <model/Model.h>
+#include <utils/Memory.h>
+#include <utils/Random.h>
+
+#include "Defs.h"
+
+namespace DungeonGeneration {
+
+/// Solved chunk of an open world. The first `pinnedRoomCount` rooms belong to the previous chunk: they were emitted
+/// with it and are repeated here only as ends of the corridors that connect the chunks.
+struct WorldChunk {
+    size_t chunkId;
+    Model::Model model;
+    size_t pinnedRoomCount;
+    std::vector<uint64_t> globalRoomIds;  /// World-wide id of every room of `model`, for stitching chunks together
+};
+
+/// Generates an unbounded world as a stream of chunks along the x axis. The graph of each chunk is generated from its
+/// own random stream only when the chunk is requested, and the chunk is solved with the frontier rooms of the previous
+/// chunk pinned. New rooms are kept to the right of everything emitted before, so only the frontier has to be
+/// remembered: memory doesn't grow with the world size.
+class WorldGenerator {
+public:
+    explicit WorldGenerator(const WorldConfig& config);
+
+    /// Config of Settings.h
+    static WorldConfig getDefaultConfig();
+
+    WorldChunk generateNextChunk();
+    /// Emit chunks until `consumer` returns false
+    void stream(const std::function<bool(WorldChunk&&)>& consumer);
+
+private:
+    struct FrontierRoom {
+        uint64_t globalId;
+        double width;
+        double height;
+        Model::Position center;
+    };
+
+    /// Pinned frontier rooms, then rooms of the new region, then its doors, then doors of the connecting corridors
+    Model::Model buildChunkModel(Random::RNG& rng, std::pmr::memory_resource* resource) const;
+    void solveChunk(Model::Model& model, Random::RNG& rng, std::pmr::memory_resource* resource) const;
+    /// Remember the new rooms that are the furthest along the x axis
+    void advanceFrontier(const Model::Model& model, const std::vector<uint64_t>& globalRoomIds);
+
+    const WorldConfig config_;
+    const AnalyticalSolver::PETScScope petscScope_;
+    Memory::BlockCache workMemory_;  // Arenas of consecutive chunks reuse the same blocks
+
+    size_t nextChunkId_ = 0;
+    uint64_t nextGlobalRoomId_ = 0;
+    std::optional<double> wallX_;  // Right edge of everything emitted so far, new rooms lie to the right of it
+    std::vector<FrontierRoom> frontier_;
+};
+
+}  // namespace DungeonGeneration
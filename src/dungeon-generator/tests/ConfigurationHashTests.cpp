@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <ConfigurationHash.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+const GenerationConfig kConfig{
+    .dungeonType = DungeonType::MovableDoors,
+    .roomCount = 100,
+    .seed = 1,
+    .solverParameters = kDefaultSolverParameters,
+    .usePortfolio = true,
+};
+
+using SettingsChange = std::pair<std::string, std::function<void(LayoutSettings&)>>;
+using ConfigChange = std::pair<std::string, std::function<void(GenerationConfig&)>>;
+
+}  // namespace
+
+TEST(ConfigurationHashTests, SameConfigurationTest)
+{
+    EXPECT_EQ(hashConfiguration(kConfig), hashConfiguration(kConfig));
+    EXPECT_EQ(hashConfiguration(kConfig), hashConfiguration(kConfig, LayoutSettings{}));
+}
+
+TEST(ConfigurationHashTests, ConfigChangesKeyTest)
+{
+    const std::vector<ConfigChange> changes{
+        {"dungeonType", [](GenerationConfig& config) { config.dungeonType = DungeonType::Grid; }},
+        {"roomCount", [](GenerationConfig& config) { config.roomCount += 1; }},
+        {"seed", [](GenerationConfig& config) { config.seed += 1; }},
+        {"solverParameters.seed", [](GenerationConfig& config) { config.solverParameters.seed += 1; }},
+        {"muFactor", [](GenerationConfig& config) { config.solverParameters.muFactor *= 2; }},
+        {"pushForceScale", [](GenerationConfig& config) { config.solverParameters.pushForceScale *= 2; }},
+        {"pushForceRange", [](GenerationConfig& config) { config.solverParameters.pushForceRange *= 2; }},
+        {"roomBloating", [](GenerationConfig& config) { config.solverParameters.roomBloating *= 2; }},
+        {"normalizeCoordinates",
+         [](GenerationConfig& config) {
+             config.solverParameters.normalizeCoordinates = !config.solverParameters.normalizeCoordinates;
+         }},
+        {"usePortfolio", [](GenerationConfig& config) { config.usePortfolio = !config.usePortfolio; }},
+    };
+    const uint64_t key = hashConfiguration(kConfig);
+    for (const auto& [name, change] : changes) {
+        GenerationConfig config = kConfig;
+        change(config);
+        EXPECT_NE(hashConfiguration(config), key) << name << " doesn't change the key";
+    }
+}
+
+TEST(ConfigurationHashTests, SettingsChangeKeyTest)
+{
+    // Every field of LayoutSettings
+    const std::vector<SettingsChange> changes{
+        {"additionalEdgesRatio", [](LayoutSettings& settings) { settings.additionalEdgesRatio *= 2; }},
+        {"treeGenerationStrategy",
+         [](LayoutSettings& settings) {
+             settings.treeGenerationStrategy =
+                 settings.treeGenerationStrategy == TreeGenerationStrategy::RandomChildCount
+                     ? TreeGenerationStrategy::RandomPredecessors
+                     : TreeGenerationStrategy::RandomChildCount;
+         }},
+        {"uniformRooms", [](LayoutSettings& settings) { settings.uniformRooms = !settings.uniformRooms; }},
+        {"regularRoomTypes",
+         [](LayoutSettings& settings) { settings.regularRoomTypes.front().dimensions.width += 1; }},
+        {"roomCatalogPath", [](LayoutSettings& settings) { settings.roomCatalogPath = "missing_catalog.txt"; }},
+        {"enableHubRoom", [](LayoutSettings& settings) { settings.enableHubRoom = !settings.enableHubRoom; }},
+        {"hubRoomTypes", [](LayoutSettings& settings) { settings.hubRoomTypes.front().distributionWeight += 1; }},
+        {"maxHubNeighborsCount", [](LayoutSettings& settings) { settings.maxHubNeighborsCount += 1; }},
+        {"hubNeighborsRatio", [](LayoutSettings& settings) { settings.hubNeighborsRatio *= 2; }},
+        {"enablePushForce", [](LayoutSettings& settings) { settings.enablePushForce = !settings.enablePushForce; }},
+        {"callbacksPrecision",
+         [](LayoutSettings& settings) {
+             settings.callbacksPrecision = settings.callbacksPrecision == Callbacks::Precision::Double
+                                               ? Callbacks::Precision::Mixed
+                                               : Callbacks::Precision::Double;
+         }},
+        {"solverRerunCount", [](LayoutSettings& settings) { settings.solverRerunCount += 1; }},
+        {"enableCorridorCrossing",
+         [](LayoutSettings& settings) { settings.enableCorridorCrossing = !settings.enableCorridorCrossing; }},
+        {"corridorCrossingScale", [](LayoutSettings& settings) { settings.corridorCrossingScale *= 2; }},
+        {"corridorCrossingMargin", [](LayoutSettings& settings) { settings.corridorCrossingMargin *= 2; }},
+        {"solverTimeLimit",
+         [](LayoutSettings& settings) {
+             settings.solverTimeLimit = settings.solverTimeLimit.has_value()
+                                            ? std::nullopt
+                                            : std::optional<std::chrono::milliseconds>(std::chrono::milliseconds(0));
+         }},
+        {"useSolverCheckpoint",
+         [](LayoutSettings& settings) { settings.useSolverCheckpoint = !settings.useSolverCheckpoint; }},
+        {"enableLocalRepair",
+         [](LayoutSettings& settings) { settings.enableLocalRepair = !settings.enableLocalRepair; }},
+        {"repairMaxAttempts", [](LayoutSettings& settings) { settings.repairMaxAttempts += 1; }},
+        {"repairNeighborhoodDepth", [](LayoutSettings& settings) { settings.repairNeighborhoodDepth += 1; }},
+        {"repairOverlapMargin", [](LayoutSettings& settings) { settings.repairOverlapMargin *= 2; }},
+        {"repairInitialPenalty", [](LayoutSettings& settings) { settings.repairInitialPenalty *= 2; }},
+        {"portfolioSize", [](LayoutSettings& settings) { settings.portfolioSize += 1; }},
+        {"portfolioAcceptableDefects", [](LayoutSettings& settings) { settings.portfolioAcceptableDefects += 1; }},
+    };
+    const uint64_t key = hashConfiguration(kConfig);
+    for (const auto& [name, change] : changes) {
+        LayoutSettings settings;
+        change(settings);
+        EXPECT_NE(hashConfiguration(kConfig, settings), key) << name << " doesn't change the key";
+    }
+}
+
+TEST(ConfigurationHashTests, PortfolioSettingsIgnoredWithoutPortfolioTest)
+{
+    GenerationConfig config = kConfig;
+    config.usePortfolio = false;
+    LayoutSettings settings;
+    settings.portfolioSize += 1;
+    settings.portfolioAcceptableDefects += 1;
+    EXPECT_EQ(hashConfiguration(config, settings), hashConfiguration(config));
+}
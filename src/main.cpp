@@ -1,7 +1,7 @@
 #include <filesystem>
 
 #include <DungeonGenerator.h>
-#include <utils/CLArguments.h>
+#include <model/CorridorRouter.h>
 
 using namespace DungeonGeneration;
 
@@ -14,9 +14,11 @@ static std::filesystem::path kPathToSVG
 
 int main(int argc, char** argv)
 {
-    CLUtils::provideCLArgumentsHandler().setArguments(argc, argv);
-    DungeonGenerator dungeonGenerator;
+    // Initializes PETSc with command line options, the generator reuses this initialization
+    AnalyticalSolver::PETScScope petscScope(argc, argv);
+    DungeonGenerator dungeonGenerator(DungeonGenerator::getDefaultOptions(kPathToSVG));
     Model::Model model = dungeonGenerator.generateDungeon();
-    model.dumpToSVG(kPathToSVG / "result.svg");
+    // Corridors are drawn as orthogonal routes around rooms, the ones that can't be routed as straight lines
+    model.dumpToSVG(kPathToSVG / "result.svg", Model::CorridorRouter(model).routeAll());
     return 0;
 }
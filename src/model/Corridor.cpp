@@ -5,8 +5,26 @@
 namespace DungeonGeneration {
 namespace Model {
 
-void Corridor::dumpToSVG(svgw::writer& svgWriter, const Model::Rooms& rooms) const
+void Corridor::dumpToSVG(
+    svgw::writer& svgWriter, const Rooms& rooms, const Doors& doors, const CorridorRoute& route) const
 {
+    if (!route.empty()) {
+        for (size_t pointId = 1; pointId < route.size(); ++pointId) {
+            const Position& pos1 = route[pointId - 1];
+            const Position& pos2 = route[pointId];
+            svgWriter.line(
+                pos1.x, -pos1.y, pos2.x, -pos2.y,
+                {
+                    {"stroke-width", kSVGWidth},
+                    {      "stroke",    "blue"}
+            });
+        }
+        return;
+    }
+
+    assert(door1Id < doors.size() && door2Id < doors.size() && "Corridor::dumpToSVG: invalid door id");
+    const Door& door1 = doors[door1Id];
+    const Door& door2 = doors[door2Id];
     const size_t roomId1 = door1.parentRoomId();
     const size_t roomId2 = door2.parentRoomId();
 
@@ -15,13 +33,11 @@ void Corridor::dumpToSVG(svgw::writer& svgWriter, const Model::Rooms& rooms) con
     Position centerPos1 = door1.getCenterPosition(rooms[roomId1]);
     Position centerPos = door2.getCenterPosition(rooms[roomId2]);
 
-    // TODO: remove hardcode
-    constexpr double corridorWidth = 0.5;
     svgWriter.line(
         centerPos1.x, -centerPos1.y, centerPos.x, -centerPos.y,
         {
-            {"stroke-width", corridorWidth},
-            {      "stroke",        "blue"}
+            {"stroke-width", kSVGWidth},
+            {      "stroke",    "blue"}
     });
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <vector>
 
 #include <svgwrite/writer.hpp>
@@ -10,13 +11,22 @@
 namespace DungeonGeneration {
 namespace Model {
 
+/// Polyline from door 1 to door 2, see CorridorRouter
+using CorridorRoute = std::vector<Position>;
+using CorridorRoutes = std::vector<CorridorRoute>;
+
+/// Connection between two doors. Doors are referenced by their indexes in the model's door table.
 struct Corridor {
-    Door& door1;
-    Door& door2;
+    static constexpr double kSVGWidth = 0.5;
+
+    size_t door1Id;
+    size_t door2Id;
 
-    void dumpToSVG(svgw::writer& svgWriter, const Model::Rooms& rooms) const;
+    /// Drawn along `route` if it's not empty, otherwise as a straight line between the doors
+    void dumpToSVG(
+        svgw::writer& svgWriter, const Rooms& rooms, const Doors& doors, const CorridorRoute& route = {}) const;
 };
-using Corridors = std::vector<Corridor>;
+using Corridors = std::pmr::vector<Corridor>;
 
 }  // namespace Model
 }  // namespace DungeonGeneration
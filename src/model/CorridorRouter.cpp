@@ -0,0 +1,586 @@
+#include "CorridorRouter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <queue>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace DungeonGeneration {
+namespace Model {
+
+namespace {
+
+constexpr double kInfinity = std::numeric_limits<double>::infinity();
+constexpr double kBoundsPadding = 1.0;  // Free space around the layout for outer routes, in average room sides
+constexpr size_t kRayStepCells = 4;     // Rays look for rooms in chunks of this many index cells, doubling them
+
+enum Direction : size_t {
+    kPlusX = 0,
+    kPlusY = 1,
+    kMinusX = 2,
+    kMinusY = 3,
+};
+
+/// Visible part of a horizontal (vertical) line: `fixed` is its y (x), the part spans [min, max] in x (y)
+struct Segment {
+    double fixed;
+    double min;
+    double max;
+};
+
+bool isHorizontal(size_t direction)
+{
+    return direction == kPlusX || direction == kMinusX;
+}
+
+bool isStrictlyInside(Position point, const Spatial::Box& box)
+{
+    return box.minX < point.x && point.x < box.maxX && box.minY < point.y && point.y < box.maxY;
+}
+
+std::vector<Spatial::Box> getInflatedRoomBoxes(const Rooms& rooms, double clearance)
+{
+    std::vector<Spatial::Box> boxes;
+    boxes.reserve(rooms.size());
+    for (const Room& room : rooms) {
+        assert(room.isPositionSet() && "CorridorRouter: room positions must be set");
+        const Position lbPos = room.getLBPosition();
+        boxes.push_back(Spatial::Box{
+            .minX = lbPos.x - clearance,
+            .minY = lbPos.y - clearance,
+            .maxX = lbPos.x + room.width() + clearance,
+            .maxY = lbPos.y + room.height() + clearance});
+    }
+    return boxes;
+}
+
+double getAverageRoomSide(const Rooms& rooms)
+{
+    double sum = 0.0;
+    for (const Room& room : rooms) {
+        sum += (room.width() + room.height()) / 2;
+    }
+    return rooms.empty() ? 1.0 : sum / static_cast<double>(rooms.size());
+}
+
+Spatial::Box getBounds(const std::vector<Spatial::Box>& boxes, double padding)
+{
+    Spatial::Box bounds{.minX = kInfinity, .minY = kInfinity, .maxX = -kInfinity, .maxY = -kInfinity};
+    for (const Spatial::Box& box : boxes) {
+        bounds.minX = std::min(bounds.minX, box.minX);
+        bounds.minY = std::min(bounds.minY, box.minY);
+        bounds.maxX = std::max(bounds.maxX, box.maxX);
+        bounds.maxY = std::max(bounds.maxY, box.maxY);
+    }
+    if (boxes.empty()) {
+        bounds = Spatial::Box{.minX = 0.0, .minY = 0.0, .maxX = 0.0, .maxY = 0.0};
+    }
+    bounds.minX -= padding;
+    bounds.minY -= padding;
+    bounds.maxX += padding;
+    bounds.maxY += padding;
+    return bounds;
+}
+
+/// Drops points that repeat or lie in the middle of a straight part
+void simplifyRoute(CorridorRoute& route)
+{
+    CorridorRoute result;
+    result.reserve(route.size());
+    for (const Position& point : route) {
+        if (!result.empty() && result.back().x == point.x && result.back().y == point.y) {
+            continue;
+        }
+        if (result.size() >= 2) {
+            const Position& a = result[result.size() - 2];
+            const Position& b = result.back();
+            if ((a.x == b.x && b.x == point.x) || (a.y == b.y && b.y == point.y)) {
+                result.back() = point;
+                continue;
+            }
+        }
+        result.push_back(point);
+    }
+    route = std::move(result);
+}
+
+/// Sorts segments by (fixed, min) and merges overlapping segments of the same line
+void mergeSegments(std::vector<Segment>& segments)
+{
+    std::sort(segments.begin(), segments.end(), [](const Segment& a, const Segment& b) {
+        return std::tie(a.fixed, a.min) < std::tie(b.fixed, b.min);
+    });
+    size_t mergedCount = 0;
+    for (size_t segmentId = 0; segmentId < segments.size(); ++segmentId) {
+        const Segment& segment = segments[segmentId];
+        if (mergedCount > 0 && segments[mergedCount - 1].fixed == segment.fixed &&
+            segment.min <= segments[mergedCount - 1].max) {
+            segments[mergedCount - 1].max = std::max(segments[mergedCount - 1].max, segment.max);
+        } else {
+            segments[mergedCount++] = segment;
+        }
+    }
+    segments.resize(mergedCount);
+}
+
+/// Merged segment of the line `fixed` that contains `position`
+uint32_t findSegment(const std::vector<Segment>& segments, double fixed, double position)
+{
+    const auto it = std::upper_bound(
+        segments.begin(), segments.end(), std::make_pair(fixed, position),
+        [](const std::pair<double, double>& value, const Segment& segment) {
+            return value < std::make_pair(segment.fixed, segment.min);
+        });
+    assert(it != segments.begin() && "CorridorRouter: segment of a point is missing");
+    assert(std::prev(it)->fixed == fixed && std::prev(it)->max >= position && "CorridorRouter: invalid segment");
+    return static_cast<uint32_t>(std::prev(it) - segments.begin());
+}
+
+/*
+For each point, the nearest lines crossing the point's own line on both sides, within `ranges[pointId]` (the visible
+part of the point's line). Coordinates are relative to the point's line: points are given as (along, across), and
+`lines` are perpendicular to it: `fixed` is along, [min, max] is across. The sweep goes across, keeping the lines that
+span the current position ordered by their `fixed`. `onFound(pointId, lineId)` is called for every found line.
+*/
+template <typename Callback>
+void findNearestLines(
+    const std::vector<Position>& points, const std::vector<Segment>& ranges, const std::vector<Segment>& lines,
+    Callback&& onFound)
+{
+    enum EventKind { kLineStarts, kPoint, kLineEnds };  // Lines are closed, so they start before and end after points
+    struct Event {
+        double across;
+        EventKind kind;
+        uint32_t id;
+    };
+    std::vector<Event> events;
+    events.reserve(points.size() + 2 * lines.size());
+    for (uint32_t lineId = 0; lineId < lines.size(); ++lineId) {
+        events.push_back(Event{lines[lineId].min, kLineStarts, lineId});
+        events.push_back(Event{lines[lineId].max, kLineEnds, lineId});
+    }
+    for (uint32_t pointId = 0; pointId < points.size(); ++pointId) {
+        events.push_back(Event{points[pointId].y, kPoint, pointId});
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return std::tie(a.across, a.kind) < std::tie(b.across, b.kind);
+    });
+
+    using ActiveLines = std::multimap<double, uint32_t>;
+    ActiveLines activeLines;
+    std::vector<ActiveLines::iterator> activeIterators(lines.size());
+    for (const Event& event : events) {
+        switch (event.kind) {
+            case kLineStarts:
+                activeIterators[event.id] = activeLines.emplace(lines[event.id].fixed, event.id);
+                break;
+            case kLineEnds:
+                activeLines.erase(activeIterators[event.id]);
+                break;
+            case kPoint: {
+                const double along = points[event.id].x;
+                const Segment& range = ranges[event.id];
+                const auto after = activeLines.upper_bound(along);
+                if (after != activeLines.end() && after->first <= range.max) {
+                    onFound(event.id, after->second);
+                }
+                const auto notBefore = activeLines.lower_bound(along);
+                if (notBefore != activeLines.begin() && std::prev(notBefore)->first >= range.min) {
+                    onFound(event.id, std::prev(notBefore)->second);
+                }
+                break;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+CorridorRouter::CorridorRouter(const Model& model, const RoutingOptions& options)
+      : model_(model),
+        options_(options),
+        roomBoxes_(getInflatedRoomBoxes(model.rooms(), 0.0)),
+        obstacles_(getInflatedRoomBoxes(model.rooms(), options.clearance)),
+        cellSize_(getAverageRoomSide(model.rooms()) + 2 * options.clearance),
+        bounds_(getBounds(obstacles_, kBoundsPadding * cellSize_)),
+        obstacleIndex_(bounds_, cellSize_)
+{
+    assert(options.clearance >= 0 && options.bendPenalty >= 0 && "CorridorRouter: invalid options");
+    for (size_t roomId = 0; roomId < obstacles_.size(); ++roomId) {
+        obstacleIndex_.insert(roomId, obstacles_[roomId]);
+    }
+
+    // Lines go through corners of the rooms and exits of the doors. Corners covered by other rooms are unreachable.
+    std::vector<Position> points;
+    points.reserve(4 * obstacles_.size() + 2 * model.corridors().size());
+    std::vector<size_t> found;
+    for (const Spatial::Box& box : obstacles_) {
+        for (const Position corner :
+             {Position{box.minX, box.minY}, Position{box.maxX, box.minY}, Position{box.minX, box.maxY},
+              Position{box.maxX, box.maxY}}) {
+            obstacleIndex_.query(Spatial::Box{corner.x, corner.y, corner.x, corner.y}, found);
+            const bool isCovered = std::any_of(found.begin(), found.end(), [&](size_t roomId) {
+                return isStrictlyInside(corner, obstacles_[roomId]);
+            });
+            if (!isCovered) {
+                points.push_back(corner);
+            }
+        }
+    }
+    const size_t firstExitId = points.size();
+    corridorEnds_.reserve(model.corridors().size());
+    for (const Corridor& corridor : model.corridors()) {
+        corridorEnds_.push_back({getCorridorEnd(corridor.door1Id), getCorridorEnd(corridor.door2Id)});
+        points.push_back(corridorEnds_.back()[0].exit);
+        points.push_back(corridorEnds_.back()[1].exit);
+    }
+
+    const std::vector<uint32_t> pointVertices = buildGraph(points);
+    for (size_t corridorId = 0; corridorId < corridorEnds_.size(); ++corridorId) {
+        corridorEnds_[corridorId][0].exitVertex = pointVertices[firstExitId + 2 * corridorId];
+        corridorEnds_[corridorId][1].exitVertex = pointVertices[firstExitId + 2 * corridorId + 1];
+    }
+}
+
+CorridorRoutes CorridorRouter::routeAll() const
+{
+    const size_t corridorCount = model_.corridors().size();
+    CorridorRoutes routes(corridorCount);
+
+    size_t threadCount = options_.threadCount;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, std::max<size_t>(corridorCount, 1));
+
+    std::atomic<size_t> nextCorridor = 0;
+    auto runWorker = [&]() {
+        SearchBuffers buffers;
+        for (size_t corridorId = nextCorridor++; corridorId < corridorCount; corridorId = nextCorridor++) {
+            routes[corridorId] = route(corridorId, buffers);
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (size_t workerId = 1; workerId < threadCount; ++workerId) {
+        workers.emplace_back(runWorker);
+    }
+    runWorker();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    return routes;
+}
+
+CorridorRoute CorridorRouter::route(size_t corridorId) const
+{
+    SearchBuffers buffers;
+    return route(corridorId, buffers);
+}
+
+size_t CorridorRouter::getVertexCount() const
+{
+    return vertices_.size();
+}
+
+CorridorRouter::CorridorEnd CorridorRouter::getCorridorEnd(size_t doorId) const
+{
+    const Door& door = model_.doors()[doorId];
+    const Room& room = model_.rooms()[door.parentRoomId()];
+    const Spatial::Box& box = obstacles_[door.parentRoomId()];
+    CorridorEnd end;
+    end.door = door.getCenterPosition(room);
+
+    // Leave through the closest side. The exit stops short of a room that is closer than the clearance, otherwise
+    // the route would start inside it.
+    const std::array<double, kDirectionCount> distances{
+        box.maxX - end.door.x, box.maxY - end.door.y, end.door.x - box.minX, end.door.y - box.minY};
+    const size_t exitDirection = std::min_element(distances.begin(), distances.end()) - distances.begin();
+    std::vector<size_t> found;
+    const double stop = castRay(end.door, exitDirection, found);
+    end.exit = end.door;
+    end.exitVertex = kNoVertex;
+    switch (exitDirection) {
+        case kPlusX:
+            end.exit.x = std::min(box.maxX, stop);
+            break;
+        case kPlusY:
+            end.exit.y = std::min(box.maxY, stop);
+            break;
+        case kMinusX:
+            end.exit.x = std::max(box.minX, stop);
+            break;
+        default:
+            end.exit.y = std::max(box.minY, stop);
+            break;
+    }
+    return end;
+}
+
+double CorridorRouter::castRay(Position origin, size_t direction, std::vector<size_t>& found) const
+{
+    /*
+    A ray is blocked by a room it enters: the room is ahead of the origin and the ray passes strictly between its sides.
+    So rays slide along room borders. Rays from points inside an inflated room (door exits of rooms closer than two
+    clearances) leave the inflated box but are still blocked by the room itself. Rooms are searched in growing chunks
+    along the ray, the first chunk with a blocking room has the closest one.
+    */
+    const bool horizontal = isHorizontal(direction);
+    const bool positive = (direction == kPlusX || direction == kPlusY);
+    const double start = horizontal ? origin.x : origin.y;
+    const double across = horizontal ? origin.y : origin.x;
+    const double limit =
+        horizontal ? (positive ? bounds_.maxX : bounds_.minX) : (positive ? bounds_.maxY : bounds_.minY);
+    double reach = kRayStepCells * cellSize_;
+
+    double chunkStart = start;
+    while (true) {
+        const double chunkEnd = positive ? std::min(start + reach, limit) : std::max(start - reach, limit);
+        const double chunkMin = std::min(chunkStart, chunkEnd);
+        const double chunkMax = std::max(chunkStart, chunkEnd);
+        const Spatial::Box chunk = horizontal ? Spatial::Box{chunkMin, across, chunkMax, across}
+                                              : Spatial::Box{across, chunkMin, across, chunkMax};
+        obstacleIndex_.query(chunk, found);
+        double stop = chunkEnd;
+        for (const size_t roomId : found) {
+            const Spatial::Box& box =
+                isStrictlyInside(origin, obstacles_[roomId]) ? roomBoxes_[roomId] : obstacles_[roomId];
+            const double boxMin = horizontal ? box.minX : box.minY;
+            const double boxMax = horizontal ? box.maxX : box.maxY;
+            const double acrossMin = horizontal ? box.minY : box.minX;
+            const double acrossMax = horizontal ? box.maxY : box.maxX;
+            if (across <= acrossMin || across >= acrossMax) {
+                continue;
+            }
+            if (positive && boxMin >= start) {
+                stop = std::min(stop, boxMin);
+            } else if (!positive && boxMax <= start) {
+                stop = std::max(stop, boxMax);
+            }
+        }
+        if (stop != chunkEnd || chunkEnd == limit) {
+            return stop;
+        }
+        chunkStart = chunkEnd;
+        reach *= 2;
+    }
+}
+
+bool CorridorRouter::isVisible(Position a, Position b, std::vector<size_t>& found) const
+{
+    assert((a.x == b.x || a.y == b.y) && "CorridorRouter: segment must be axis-aligned");
+    const Spatial::Box segmentBox{
+        std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)};
+    obstacleIndex_.query(segmentBox, found);
+    return std::none_of(found.begin(), found.end(), [&](size_t roomId) {
+        const bool isEndInside =
+            isStrictlyInside(a, obstacles_[roomId]) || isStrictlyInside(b, obstacles_[roomId]);
+        const Spatial::Box& box = isEndInside ? roomBoxes_[roomId] : obstacles_[roomId];
+        if (a.y == b.y) {
+            return box.minY < a.y && a.y < box.maxY && box.minX < segmentBox.maxX && segmentBox.minX < box.maxX;
+        }
+        return box.minX < a.x && a.x < box.maxX && box.minY < segmentBox.maxY && segmentBox.minY < box.maxY;
+    });
+}
+
+std::vector<uint32_t> CorridorRouter::buildGraph(const std::vector<Position>& points)
+{
+    // Visible parts of the lines through the points. Points of one line that see each other share a part.
+    std::vector<Segment> horizontalSegments;
+    std::vector<Segment> verticalSegments;
+    horizontalSegments.reserve(points.size());
+    verticalSegments.reserve(points.size());
+    std::vector<size_t> found;
+    for (const Position& point : points) {
+        horizontalSegments.push_back(
+            Segment{point.y, castRay(point, kMinusX, found), castRay(point, kPlusX, found)});
+        verticalSegments.push_back(
+            Segment{point.x, castRay(point, kMinusY, found), castRay(point, kPlusY, found)});
+    }
+    mergeSegments(horizontalSegments);
+    mergeSegments(verticalSegments);
+
+    std::vector<Segment> pointHorizontals(points.size());
+    std::vector<Segment> pointVerticals(points.size());
+    std::vector<uint32_t> pointHorizontalIds(points.size());
+    std::vector<uint32_t> pointVerticalIds(points.size());
+    for (size_t pointId = 0; pointId < points.size(); ++pointId) {
+        const Position& point = points[pointId];
+        pointHorizontalIds[pointId] = findSegment(horizontalSegments, point.y, point.x);
+        pointVerticalIds[pointId] = findSegment(verticalSegments, point.x, point.y);
+        pointHorizontals[pointId] = horizontalSegments[pointHorizontalIds[pointId]];
+        pointVerticals[pointId] = verticalSegments[pointVerticalIds[pointId]];
+    }
+
+    // A vertex is a crossing of a horizontal and a vertical segment
+    std::unordered_map<uint64_t, uint32_t> vertexIds;
+    std::vector<std::pair<uint32_t, uint32_t>> vertexSegments;  // Horizontal, vertical
+    vertexIds.reserve(5 * points.size());
+    vertexSegments.reserve(5 * points.size());
+    vertices_.clear();
+    vertices_.reserve(5 * points.size());
+    auto addVertex = [&](uint32_t horizontalId, uint32_t verticalId) {
+        const uint64_t key = (static_cast<uint64_t>(horizontalId) << 32) | verticalId;
+        const auto [it, isInserted] = vertexIds.try_emplace(key, static_cast<uint32_t>(vertices_.size()));
+        if (isInserted) {
+            vertices_.push_back(Position{verticalSegments[verticalId].fixed, horizontalSegments[horizontalId].fixed});
+            vertexSegments.emplace_back(horizontalId, verticalId);
+        }
+        return it->second;
+    };
+    std::vector<uint32_t> pointVertices(points.size());
+    for (size_t pointId = 0; pointId < points.size(); ++pointId) {
+        pointVertices[pointId] = addVertex(pointHorizontalIds[pointId], pointVerticalIds[pointId]);
+    }
+
+    // Crossings with the nearest vertical lines to the left and to the right of the points
+    findNearestLines(points, pointHorizontals, verticalSegments, [&](uint32_t pointId, uint32_t verticalId) {
+        addVertex(pointHorizontalIds[pointId], verticalId);
+    });
+    // Same for horizontal lines below and above: swap the axes
+    std::vector<Position> swappedPoints(points.size());
+    std::transform(points.begin(), points.end(), swappedPoints.begin(), [](const Position& point) {
+        return Position{point.y, point.x};
+    });
+    findNearestLines(swappedPoints, pointVerticals, horizontalSegments, [&](uint32_t pointId, uint32_t horizontalId) {
+        addVertex(horizontalId, pointVerticalIds[pointId]);
+    });
+
+    // Consecutive vertices of a segment are connected
+    std::vector<std::vector<uint32_t>> horizontalVertices(horizontalSegments.size());
+    std::vector<std::vector<uint32_t>> verticalVertices(verticalSegments.size());
+    for (uint32_t vertexId = 0; vertexId < vertices_.size(); ++vertexId) {
+        horizontalVertices[vertexSegments[vertexId].first].push_back(vertexId);
+        verticalVertices[vertexSegments[vertexId].second].push_back(vertexId);
+    }
+    neighbors_.assign(vertices_.size(), {kNoVertex, kNoVertex, kNoVertex, kNoVertex});
+    for (std::vector<uint32_t>& segmentVertices : horizontalVertices) {
+        std::sort(segmentVertices.begin(), segmentVertices.end(), [&](uint32_t a, uint32_t b) {
+            return vertices_[a].x < vertices_[b].x;
+        });
+        for (size_t i = 1; i < segmentVertices.size(); ++i) {
+            neighbors_[segmentVertices[i - 1]][kPlusX] = segmentVertices[i];
+            neighbors_[segmentVertices[i]][kMinusX] = segmentVertices[i - 1];
+        }
+    }
+    for (std::vector<uint32_t>& segmentVertices : verticalVertices) {
+        std::sort(segmentVertices.begin(), segmentVertices.end(), [&](uint32_t a, uint32_t b) {
+            return vertices_[a].y < vertices_[b].y;
+        });
+        for (size_t i = 1; i < segmentVertices.size(); ++i) {
+            neighbors_[segmentVertices[i - 1]][kPlusY] = segmentVertices[i];
+            neighbors_[segmentVertices[i]][kMinusY] = segmentVertices[i - 1];
+        }
+    }
+    return pointVertices;
+}
+
+CorridorRoute CorridorRouter::route(size_t corridorId, SearchBuffers& buffers) const
+{
+    const auto& [end1, end2] = corridorEnds_[corridorId];
+    const size_t stateCount = vertices_.size() * kDirectionCount;
+    if (buffers.stamps.size() != stateCount) {
+        buffers.costs.resize(stateCount);
+        buffers.parents.resize(stateCount);
+        buffers.stamps.assign(stateCount, 0);
+        buffers.stamp = 0;
+    }
+    if (++buffers.stamp == 0) {
+        std::fill(buffers.stamps.begin(), buffers.stamps.end(), 0);
+        buffers.stamp = 1;
+    }
+    const uint32_t stamp = buffers.stamp;
+
+    const Position goal = vertices_[end2.exitVertex];
+    auto getDistance = [](Position a, Position b) { return std::abs(a.x - b.x) + std::abs(a.y - b.y); };
+    using QueueEntry = std::pair<double, uint32_t>;  // Cost + heuristic, state
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+    // Any first move is straight
+    for (uint32_t direction = 0; direction < kDirectionCount; ++direction) {
+        const uint32_t state = end1.exitVertex * kDirectionCount + direction;
+        buffers.costs[state] = 0.0;
+        buffers.parents[state] = kNoVertex;
+        buffers.stamps[state] = stamp;
+        queue.emplace(getDistance(vertices_[end1.exitVertex], goal), state);
+    }
+
+    uint32_t goalState = kNoVertex;
+    while (!queue.empty()) {
+        const auto [priority, state] = queue.top();
+        queue.pop();
+        const uint32_t vertexId = state / kDirectionCount;
+        const size_t direction = state % kDirectionCount;
+        const double cost = buffers.costs[state];
+        if (priority > cost + getDistance(vertices_[vertexId], goal)) {
+            continue;  // Outdated entry
+        }
+        if (vertexId == end2.exitVertex) {
+            goalState = state;
+            break;
+        }
+        for (size_t nextDirection = 0; nextDirection < kDirectionCount; ++nextDirection) {
+            const uint32_t neighborId = neighbors_[vertexId][nextDirection];
+            if (neighborId == kNoVertex || nextDirection == (direction + 2) % kDirectionCount) {
+                continue;
+            }
+            const double nextCost = cost + getDistance(vertices_[vertexId], vertices_[neighborId]) +
+                                    (nextDirection != direction ? options_.bendPenalty : 0.0);
+            const uint32_t nextState = neighborId * kDirectionCount + nextDirection;
+            if (buffers.stamps[nextState] != stamp || nextCost < buffers.costs[nextState]) {
+                buffers.costs[nextState] = nextCost;
+                buffers.parents[nextState] = state;
+                buffers.stamps[nextState] = stamp;
+                queue.emplace(nextCost + getDistance(vertices_[neighborId], goal), nextState);
+            }
+        }
+    }
+    if (goalState == kNoVertex) {
+        return {};
+    }
+
+    CorridorRoute route{end2.door, end2.exit};
+    for (uint32_t state = goalState; state != kNoVertex; state = buffers.parents[state]) {
+        route.push_back(vertices_[state / kDirectionCount]);
+    }
+    route.push_back(end1.exit);
+    route.push_back(end1.door);
+    std::reverse(route.begin(), route.end());
+    simplifyRoute(route);
+    straightenRoute(route);
+    return route;
+}
+
+void CorridorRouter::straightenRoute(CorridorRoute& route) const
+{
+    // Parts between the doors and the exits go through the rooms of the corridor, they are kept as they are. After
+    // simplification segments alternate between horizontal and vertical, so any four points a-b-c-d are a zigzag or
+    // a U-turn; a-corner-d is never longer.
+    std::vector<size_t> found;
+    bool isChanged = true;
+    while (isChanged) {
+        isChanged = false;
+        for (size_t i = 1; i + 5 <= route.size() && !isChanged; ++i) {
+            const Position a = route[i];
+            const Position d = route[i + 3];
+            for (const Position corner : {Position{a.x, d.y}, Position{d.x, a.y}}) {
+                if (isVisible(a, corner, found) && isVisible(corner, d, found)) {
+                    route.erase(route.begin() + i + 1, route.begin() + i + 3);
+                    route.insert(route.begin() + i + 1, corner);
+                    simplifyRoute(route);
+                    isChanged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+}  // namespace Model
+}  // namespace DungeonGeneration
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <utils/GridIndex.h>
+
+#include "Model.h"
+
+namespace DungeonGeneration {
+namespace Model {
+
+struct RoutingOptions {
+    double clearance = 1.0;     // Routes keep this distance from rooms, except at their doors
+    double bendPenalty = 10.0;  // Cost of a bend in length units: higher values give fewer, longer segments
+    size_t threadCount = 0;     // 0 is the number of hardware threads
+};
+
+/// Routes corridors of a solved model as axis-aligned polylines around rooms. A route leaves its door perpendicular to
+/// the room side and then follows a sparse orthogonal visibility graph. Interesting points are corners of the rooms
+/// (inflated by the clearance) and door exits; horizontal and vertical lines through them are cut where they enter a
+/// room. The full graph would have a vertex at every crossing of these lines, which is quadratic in long aligned gaps
+/// between rooms. Here each point is only connected to the nearest crossing lines on its four sides, so there are at
+/// most five vertices per point and four edges per vertex. Staircases that this sparsity leads to are straightened
+/// after the search. The graph is built once; every corridor is a separate A* search over it (length plus bend
+/// penalties, Manhattan heuristic), and searches run in parallel.
+class CorridorRouter {
+public:
+    /// Model must be solved and outlive the router
+    CorridorRouter(const Model& model, const RoutingOptions& options = {});
+
+    /// Routes of all corridors, indexed like the model's corridors
+    CorridorRoutes routeAll() const;
+    /// Route from door 1 to door 2 of the corridor. Empty if the corridor can't get around rooms.
+    CorridorRoute route(size_t corridorId) const;
+
+    size_t getVertexCount() const;
+
+private:
+    static constexpr uint32_t kNoVertex = UINT32_MAX;
+    static constexpr size_t kDirectionCount = 4;  // +x, +y, -x, -y
+
+    /// Corridor end: the door and the exit point on the inflated room border, or on the side of a room closer than that
+    struct CorridorEnd {
+        Position door;
+        Position exit;
+        uint32_t exitVertex;
+    };
+
+    /// A* buffers of size vertexCount * kDirectionCount, reused by a thread between searches. States are (vertex,
+    /// direction of the last move), the stamp tells which search a state was reached in.
+    struct SearchBuffers {
+        std::vector<double> costs;
+        std::vector<uint32_t> parents;
+        std::vector<uint32_t> stamps;
+        uint32_t stamp = 0;
+    };
+
+    CorridorEnd getCorridorEnd(size_t doorId) const;
+    /// Where a ray from `origin` stops: the coordinate along `direction` of the first room it enters, or the border.
+    /// Rooms are inflated by the clearance, except for the ones whose inflated boxes contain the origin.
+    double castRay(Position origin, size_t direction, std::vector<size_t>& found) const;
+    /// Axis-aligned segment from `a` to `b` doesn't enter any room, inflated as in castRay from either end
+    bool isVisible(Position a, Position b, std::vector<size_t>& found) const;
+    /// Returns vertices of the points
+    std::vector<uint32_t> buildGraph(const std::vector<Position>& points);
+    CorridorRoute route(size_t corridorId, SearchBuffers& buffers) const;
+    /// Replaces zigzags (two parallel segments joined by a third one) by a single bend where it's visible
+    void straightenRoute(CorridorRoute& route) const;
+
+    const Model& model_;
+    const RoutingOptions options_;
+    const std::vector<Spatial::Box> roomBoxes_;
+    const std::vector<Spatial::Box> obstacles_;  // Inflated room boxes
+    const double cellSize_;                      // Average inflated room side
+    const Spatial::Box bounds_;                  // Rays stop here
+    Spatial::GridIndex obstacleIndex_;
+    std::vector<std::array<CorridorEnd, 2>> corridorEnds_;
+
+    // Graph
+    std::vector<Position> vertices_;
+    std::vector<std::array<uint32_t, kDirectionCount>> neighbors_;  // By direction, kNoVertex if there is no edge
+};
+
+}  // namespace Model
+}  // namespace DungeonGeneration
@@ -35,6 +35,12 @@ size_t Door::varObjectId() const
     return varObjId_.value();
 }
 
+Position Door::shift() const
+{
+    assert(shift_.has_value() && "Door::shift: shift must be set");
+    return shift_.value();
+}
+
 Position Door::getCenterPositionFromVars(const double* x) const
 {
     assert(x && "Null variables array");
@@ -87,15 +93,11 @@ void Door::dumpToSVG(svgw::writer& svgWriter, const Model::Room& parentRoom) con
     assert(parentRoom.id() == parentRoomId_ && "Corridor::dumpToSVG: incorrect parent room is passed");
     assert(isPositionSet(parentRoom) && "Corridor::dumpToSVG: door position must be set");
 
-    // TODO: remove hard code
-    constexpr double width = 2.5;
-    constexpr double height = 2.5;
-
     const auto [roomX, roomY] = parentRoom.getCenterPosition();
     const auto [doorDx, doorDy] = shift_.value();
-    const double lbPosX = roomX + doorDx - width / 2;
-    const double lbPosY = roomY + doorDy - height / 2;
-    svgWriter.write(SVGUtils::generateSVGRectangle(lbPosX, lbPosY, width, height, "red"));
+    const double lbPosX = roomX + doorDx - kSVGSize / 2;
+    const double lbPosY = roomY + doorDy - kSVGSize / 2;
+    svgWriter.write(SVGUtils::generateSVGRectangle(lbPosX, lbPosY, kSVGSize, kSVGSize, "red"));
 }
 
 }  // namespace Model
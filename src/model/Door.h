@@ -1,6 +1,8 @@
 #pragma once
 
+#include <memory_resource>
 #include <optional>
+#include <vector>
 
 #include <svgwrite/writer.hpp>
 
@@ -14,6 +16,8 @@ class Room;
 
 class Door : public ObjectMaybeWithVars {
 public:
+    static constexpr double kSVGSize = 2.5;  // Doors are drawn as squares of this side
+
     Door() = default;
     static Door createMovableDoor(size_t parentRoomId, size_t doorId);
     static Door createFixedDoor(size_t parentRoomId, Position shift);
@@ -21,6 +25,7 @@ public:
     size_t parentRoomId() const;
     size_t varObjectId() const;
 
+    Position shift() const;
     Position getCenterPositionFromVars(const double* x) const;
     Position getCenterPosition(const Model::Room& parentRoom) const;
 
@@ -36,5 +41,7 @@ private:
     std::optional<Position> shift_;  // Shift with regard to parent room's center
 };
 
+using Doors = std::pmr::vector<Door>;
+
 }  // namespace Model
 }  // namespace DungeonGeneration
@@ -8,9 +8,26 @@
 namespace DungeonGeneration {
 namespace Model {
 
-Model::Model(Rooms&& rooms, Corridors&& corridors)
+Model::Model(Rooms&& rooms, Doors&& doors, Corridors&& corridors)
       : rooms_(std::move(rooms)),
+        doors_(std::move(doors)),
         corridors_(std::move(corridors))
+{
+    for (size_t roomId = 0; roomId < rooms_.size(); ++roomId) {
+        assert(rooms_[roomId].id() == roomId && "Model: room id must match its index");
+    }
+    for ([[maybe_unused]] const Door& door : doors_) {
+        assert(door.parentRoomId() < rooms_.size() && "Model: door has an invalid parent room id");
+    }
+    for ([[maybe_unused]] const Corridor& corridor : corridors_) {
+        assert(corridor.door1Id < doors_.size() && corridor.door2Id < doors_.size() && "Model: invalid corridor");
+    }
+}
+
+Model::Model(const Model& other, std::pmr::memory_resource* resource)
+      : rooms_(other.rooms_, resource),
+        doors_(other.doors_, resource),
+        corridors_(other.corridors_, resource)
 {}
 
 const Rooms& Model::rooms() const
@@ -18,11 +35,21 @@ const Rooms& Model::rooms() const
     return rooms_;
 }
 
+const Doors& Model::doors() const
+{
+    return doors_;
+}
+
 const Corridors& Model::corridors() const
 {
     return corridors_;
 }
 
+std::pair<size_t, size_t> Model::getCorridorRooms(const Corridor& corridor) const
+{
+    return {doors_[corridor.door1Id].parentRoomId(), doors_[corridor.door2Id].parentRoomId()};
+}
+
 Room Model::getRoom(size_t id) const
 {
     return rooms_[id];
@@ -31,10 +58,8 @@ Room Model::getRoom(size_t id) const
 size_t Model::getObjectCount() const
 {
     size_t objectCount = rooms_.size();
-    for (const Room& room : rooms_) {
-        for (const Door& door : room.doors()) {
-            objectCount += door.isMovable();
-        }
+    for (const Door& door : doors_) {
+        objectCount += door.isMovable();
     }
     return objectCount;
 }
@@ -53,23 +78,39 @@ VariablesBounds Model::getVariablesBounds() const
         const auto [roomXId, roomYId] = room.getVariablesIds();
         result[roomXId] = std::nullopt;
         result[roomYId] = std::nullopt;
-        for (const Door& door : room.doors()) {
-            if (!door.isMovable()) {
-                continue;
-            }
-
-            // Movable doors can't go beyond rooms' bounds
-            const auto [doorXId, doorYId] = door.getVariablesIds();
-            const double fraction = 0.3;
-            const double xBound = fraction * room.width();
-            const double yBound = fraction * room.height();
-            result[doorXId] = Interval{.lowerBound = -xBound, .upperBound = xBound};
-            result[doorYId] = Interval{.lowerBound = -yBound, .upperBound = yBound};
+    }
+    for (const Door& door : doors_) {
+        if (!door.isMovable()) {
+            continue;
         }
+
+        // Movable doors can't go beyond rooms' bounds
+        const Room& room = rooms_[door.parentRoomId()];
+        const auto [doorXId, doorYId] = door.getVariablesIds();
+        const double fraction = 0.3;
+        const double xBound = fraction * room.width();
+        const double yBound = fraction * room.height();
+        result[doorXId] = Interval{.lowerBound = -xBound, .upperBound = xBound};
+        result[doorYId] = Interval{.lowerBound = -yBound, .upperBound = yBound};
     }
     return result;
 }
 
+Positions Model::getPositions() const
+{
+    Positions positions(getObjectCount());
+    for (const Room& room : rooms_) {
+        assert(room.isPositionSet() && "Model::getPositions: room position must be set");
+        positions[room.id()] = room.getCenterPosition();
+    }
+    for (const Door& door : doors_) {
+        if (door.isMovable()) {
+            positions[door.varObjectId()] = door.shift();
+        }
+    }
+    return positions;
+}
+
 void Model::setPositions(const Positions& positions)
 {
     assert(positions.size() == getObjectCount() && "Model::setPositions: invalid positions count");
@@ -77,21 +118,43 @@ void Model::setPositions(const Positions& positions)
         const size_t roomId = room.id();
         assert(roomId < positions.size() && "Model::setPositions: invalid room id");
         room.setCenterPosition(positions[roomId]);
-        for (Door& door : room.doorsMutable()) {
-            if (!door.isMovable()) {
-                continue;
-            }
-            const size_t doorId = door.varObjectId();
-            assert(doorId < positions.size() && "Model::setPositions: invalid door id");
-            door.setShift(positions[doorId]);
+    }
+    for (Door& door : doors_) {
+        if (!door.isMovable()) {
+            continue;
+        }
+        const size_t doorId = door.varObjectId();
+        assert(doorId < positions.size() && "Model::setPositions: invalid door id");
+        door.setShift(positions[doorId]);
+    }
+}
+
+void Model::setPositionsFromVars(const double* x)
+{
+    assert(x && "Model::setPositionsFromVars: null variables array");
+    for (Room& room : rooms_) {
+        const auto [varX, varY] = room.getVariablesVal(x);
+        room.setCenterPosition(Position{.x = varX, .y = varY});
+    }
+    for (Door& door : doors_) {
+        if (door.isMovable()) {
+            const auto [varX, varY] = door.getVariablesVal(x);
+            door.setShift(Position{.x = varX, .y = varY});
         }
     }
 }
 
-void Model::dumpToSVG(const std::filesystem::path& outputPath) const
+void Model::dumpToSVG(const std::filesystem::path& outputPath, const CorridorRoutes& routes) const
 {
     std::ofstream ofstream{outputPath};
-    svgw::writer svgWriter(ofstream);
+    dumpToSVG(ofstream, routes);
+}
+
+void Model::dumpToSVG(std::ostream& ostream, const CorridorRoutes& routes) const
+{
+    assert((routes.empty() || routes.size() == corridors_.size()) && "Model::dumpToSVG: invalid routes count");
+
+    svgw::writer svgWriter(ostream);
 
     const auto [x1, y1, x2, y2] = calculateViewBox();
     const double width = x2 - x1;
@@ -107,8 +170,13 @@ void Model::dumpToSVG(const std::filesystem::path& outputPath) const
         room.dumpToSVG(svgWriter);
         svgWriter.write("\n");
     }
-    for (const Corridor& corridor : corridors_) {
-        corridor.dumpToSVG(svgWriter, rooms_);
+    for (const Door& door : doors_) {
+        door.dumpToSVG(svgWriter, rooms_[door.parentRoomId()]);
+    }
+    svgWriter.write("\n");
+    for (size_t corridorId = 0; corridorId < corridors_.size(); ++corridorId) {
+        corridors_[corridorId].dumpToSVG(
+            svgWriter, rooms_, doors_, routes.empty() ? CorridorRoute{} : routes[corridorId]);
         svgWriter.write("\n");
     }
 
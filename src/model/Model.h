@@ -1,45 +1,59 @@
 #pragma once
 
 #include <filesystem>
+#include <ostream>
 
 #include <AnalyticalSolver.h>
 
 #include "Corridor.h"
+#include "Door.h"
 #include "Room.h"
 
 namespace DungeonGeneration {
 namespace Model {
 
+/// Model is stored as flat tables of rooms, doors and corridors. Doors refer to rooms and corridors refer to doors by
+/// index, so models are safe to copy and resize. Tables use the memory resource they were created with; a plain copy
+/// always uses the default resource, so it may outlive the arena the original was built in.
 class Model {
 public:
     Model() = default;
-    Model(Rooms&& rooms, Corridors&& corridors);
-
-    // Movable
+    Model(Rooms&& rooms, Doors&& doors, Corridors&& corridors);
+    Model(const Model& other) = default;
     Model(Model&& other) = default;
-    Model& operator=(Model&& other) = default;
+    /// Copies `other` into `resource`
+    Model(const Model& other, std::pmr::memory_resource* resource);
 
-    // Non-copyable
-    Model(const Model& other) = delete;
-    Model& operator=(const Model& other) = delete;
+    Model& operator=(const Model& other) = default;
+    Model& operator=(Model&& other) = default;
 
     const Rooms& rooms() const;
+    const Doors& doors() const;
     const Corridors& corridors() const;
 
+    /// Parent rooms of corridor's doors
+    std::pair<size_t, size_t> getCorridorRooms(const Corridor& corridor) const;
+
     Room getRoom(size_t id) const;
     size_t getObjectCount() const;
     size_t getVariablesCount() const;
     VariablesBounds getVariablesBounds() const;
+    Positions getPositions() const;
 
     void setPositions(const Positions& roomPositions);
+    /// Same as setPositions, but reads positions directly from solver's variables
+    void setPositionsFromVars(const double* x);
 
     // Very rough SVG dumper. It maybe will be removed in favor of SFML.
-    void dumpToSVG(const std::filesystem::path& outputPath) const;
+    /// Corridors are drawn along `routes` if they are given (indexed like corridors), otherwise as straight lines
+    void dumpToSVG(const std::filesystem::path& outputPath, const CorridorRoutes& routes = {}) const;
+    void dumpToSVG(std::ostream& ostream, const CorridorRoutes& routes = {}) const;
 
 private:
     std::array<double, 4> calculateViewBox() const;
 
     Rooms rooms_;
+    Doors doors_;
     Corridors corridors_;
 };
 
@@ -7,18 +7,14 @@
 namespace DungeonGeneration {
 namespace Model {
 
-Room::Room(size_t id, double width, double height, std::vector<Door>&& doors, std::optional<Position> centerPosition)
+Room::Room(size_t id, double width, double height, std::optional<Position> centerPosition)
       : ObjectWithVars(id),
         width_(width),
         height_(height),
-        doors_(std::move(doors)),
         centerPosition_(centerPosition)
 {
     assert(width_ > 0.0 && "Bad room width");
     assert(height_ > 0.0 && "Bad room height");
-    for (const Door& door : doors_) {
-        assert(door.parentRoomId() == varObjId_ && "Door has an incorrect parent room id");
-    }
 }
 
 size_t Room::id() const
@@ -26,16 +22,6 @@ size_t Room::id() const
     return varObjId_;
 }
 
-const std::vector<Door>& Room::doors() const
-{
-    return doors_;
-}
-
-std::vector<Door>& Room::doorsMutable()
-{
-    return doors_;
-}
-
 double Room::width() const
 {
     return width_;
@@ -77,10 +63,6 @@ void Room::dumpToSVG(svgw::writer& svgWriter) const
 
     const std::string text = "room " + std::to_string(varObjId_);
     svgWriter.write(SVGUtils::generateSVGRectangle(lbPos.x, lbPos.y, width_, height_, "yellow", text));
-
-    for (const Door& door : doors_) {
-        door.dumpToSVG(svgWriter, *this);
-    }
 }
 
 }  // namespace Model
@@ -1,29 +1,24 @@
 #pragma once
 
+#include <memory_resource>
 #include <optional>
 #include <vector>
 
 #include <svgwrite/writer.hpp>
 
 #include "Defs.h"
-#include "Door.h"
 #include "Variables.h"
 
 namespace DungeonGeneration {
 namespace Model {
 
-struct Door;
-
+/// Doors are stored separately in the model's door table, so room is a plain value that is cheap to copy.
 class Room : public ObjectWithVars {
 public:
     Room() = default;
-    Room(
-        size_t id, double width, double height, std::vector<Door>&& doors,
-        std::optional<Position> centerPosition = std::nullopt);
+    Room(size_t id, double width, double height, std::optional<Position> centerPosition = std::nullopt);
 
     size_t id() const;
-    const std::vector<Door>& doors() const;
-    std::vector<Door>& doorsMutable();
     double width() const;
     double height() const;
 
@@ -39,11 +34,10 @@ public:
 private:
     double width_;
     double height_;
-    std::vector<Door> doors_;
     std::optional<Position> centerPosition_;
 };
 
-using Rooms = std::vector<Room>;
+using Rooms = std::pmr::vector<Room>;
 
 }  // namespace Model
 }  // namespace DungeonGeneration
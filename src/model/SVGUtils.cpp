@@ -20,6 +20,16 @@ std::string generateSVGRectangle(
     return sstream.str();
 }
 
+std::string generateSVGFilledRectangle(
+    double x, double y, double width, double height, const std::string& color, double opacity)
+{
+    y = -y - height;  // invert Y axis
+    std::stringstream sstream;
+    sstream << "<rect x=\"" << x << "\" y=\"" << y << "\" width=\"" << width << "\" height=\"" << height << "\" fill=\""
+            << color << "\" fill-opacity=\"" << opacity << "\"/>";
+    return sstream.str();
+}
+
 }  // namespace SVGUtils
 }  // namespace Model
 }  // namespace DungeonGeneration
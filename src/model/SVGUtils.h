@@ -10,6 +10,9 @@ namespace SVGUtils {
 /// This is needed because text is not supported in the library used to dump SVG.
 std::string generateSVGRectangle(
     double x, double y, double width, double height, const std::string& color, const std::string& text = "");
+/// Rectangle without a border, `opacity` is in [0, 1]
+std::string generateSVGFilledRectangle(
+    double x, double y, double width, double height, const std::string& color, double opacity);
 
 }  // namespace SVGUtils
 }  // namespace Model
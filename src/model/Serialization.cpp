@@ -0,0 +1,212 @@
+#include "Serialization.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace DungeonGeneration {
+namespace Model {
+namespace Serialization {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x444D4744;  // "DGMD"
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kFixedDoorMarker = std::numeric_limits<uint64_t>::max();
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t roomCnt;
+    uint64_t doorCnt;
+    uint64_t corridorCnt;
+};
+
+struct RoomRecord {
+    double width;
+    double height;
+    double x;
+    double y;
+};
+
+struct DoorRecord {
+    uint64_t parentRoomId;
+    uint64_t varObjectId;  // kFixedDoorMarker for fixed doors
+    double shiftX;
+    double shiftY;
+};
+
+struct CorridorRecord {
+    uint64_t door1Id;
+    uint64_t door2Id;
+};
+
+template <typename Record>
+void append(std::vector<uint8_t>& buffer, const Record& record)
+{
+    const size_t offset = buffer.size();
+    buffer.resize(offset + sizeof(Record));
+    std::memcpy(buffer.data() + offset, &record, sizeof(Record));
+}
+
+/// Sequential reader that never reads past the end
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size)
+          : data_(data),
+            left_(size)
+    {}
+
+    template <typename Record>
+    [[nodiscard]] bool read(Record& record)
+    {
+        if (left_ < sizeof(Record)) {
+            return false;
+        }
+        std::memcpy(&record, data_, sizeof(Record));
+        data_ += sizeof(Record);
+        left_ -= sizeof(Record);
+        return true;
+    }
+
+    size_t left() const
+    {
+        return left_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t left_;
+};
+
+}  // namespace
+
+std::vector<uint8_t> serialize(const Model& model)
+{
+    const Rooms& rooms = model.rooms();
+    const Doors& doors = model.doors();
+    const Corridors& corridors = model.corridors();
+
+    std::vector<uint8_t> buffer;
+    buffer.reserve(
+        sizeof(Header) + rooms.size() * sizeof(RoomRecord) + doors.size() * sizeof(DoorRecord) +
+        corridors.size() * sizeof(CorridorRecord));
+    append(
+        buffer, Header{
+                    .magic = kMagic,
+                    .version = kVersion,
+                    .roomCnt = rooms.size(),
+                    .doorCnt = doors.size(),
+                    .corridorCnt = corridors.size()});
+    for (const Room& room : rooms) {
+        assert(room.isPositionSet() && "Serialization::serialize: room position must be set");
+        const Position center = room.getCenterPosition();
+        append(buffer, RoomRecord{.width = room.width(), .height = room.height(), .x = center.x, .y = center.y});
+    }
+    for (const Door& door : doors) {
+        assert(door.isPositionSet(rooms[door.parentRoomId()]) && "Serialization::serialize: door position must be set");
+        const Position shift = door.shift();
+        append(
+            buffer, DoorRecord{
+                        .parentRoomId = door.parentRoomId(),
+                        .varObjectId = door.isMovable() ? door.varObjectId() : kFixedDoorMarker,
+                        .shiftX = shift.x,
+                        .shiftY = shift.y});
+    }
+    for (const Corridor& corridor : corridors) {
+        append(buffer, CorridorRecord{.door1Id = corridor.door1Id, .door2Id = corridor.door2Id});
+    }
+    return buffer;
+}
+
+std::optional<Model> deserialize(const uint8_t* data, size_t size, std::pmr::memory_resource* resource)
+{
+    Reader reader(data, size);
+    Header header;
+    if (!reader.read(header) || header.magic != kMagic || header.version != kVersion) {
+        std::cerr << "(!) Serialization::deserialize: invalid header\n";
+        return std::nullopt;
+    }
+    // Counts are checked before allocating: they can be anything in a corrupted buffer
+    const size_t left = reader.left();
+    if (header.roomCnt > left / sizeof(RoomRecord) || header.doorCnt > left / sizeof(DoorRecord) ||
+        header.corridorCnt > left / sizeof(CorridorRecord) ||
+        left != header.roomCnt * sizeof(RoomRecord) + header.doorCnt * sizeof(DoorRecord) +
+                    header.corridorCnt * sizeof(CorridorRecord)) {
+        std::cerr << "(!) Serialization::deserialize: unexpected size\n";
+        return std::nullopt;
+    }
+
+    Rooms rooms(resource);
+    rooms.reserve(header.roomCnt);
+    for (size_t roomId = 0; roomId < header.roomCnt; ++roomId) {
+        RoomRecord record;
+        if (!reader.read(record)) {
+            std::cerr << "(!) Serialization::deserialize: room " << roomId << " is truncated\n";
+            return std::nullopt;
+        }
+        rooms.emplace_back(roomId, record.width, record.height, Position{.x = record.x, .y = record.y});
+    }
+
+    // Movable doors must take the object ids right after the rooms, each exactly once
+    const size_t roomCnt = header.roomCnt;
+    std::vector<bool> objectIdTaken(header.doorCnt, false);
+    size_t movableDoorCnt = 0;
+    Doors doors(resource);
+    doors.reserve(header.doorCnt);
+    for (size_t doorId = 0; doorId < header.doorCnt; ++doorId) {
+        DoorRecord record;
+        if (!reader.read(record)) {
+            std::cerr << "(!) Serialization::deserialize: door " << doorId << " is truncated\n";
+            return std::nullopt;
+        }
+        if (record.parentRoomId >= roomCnt) {
+            std::cerr << "(!) Serialization::deserialize: door " << doorId << " has invalid parent room\n";
+            return std::nullopt;
+        }
+        const Position shift{.x = record.shiftX, .y = record.shiftY};
+        if (record.varObjectId == kFixedDoorMarker) {
+            doors.push_back(Door::createFixedDoor(record.parentRoomId, shift));
+            continue;
+        }
+        if (record.varObjectId < roomCnt || record.varObjectId - roomCnt >= header.doorCnt ||
+            objectIdTaken[record.varObjectId - roomCnt]) {
+            std::cerr << "(!) Serialization::deserialize: door " << doorId << " has invalid object id\n";
+            return std::nullopt;
+        }
+        objectIdTaken[record.varObjectId - roomCnt] = true;
+        ++movableDoorCnt;
+        Door door = Door::createMovableDoor(record.parentRoomId, record.varObjectId);
+        door.setShift(shift);
+        doors.push_back(door);
+    }
+    // Ids are unique, so they are contiguous iff all of them are below the object count
+    if (std::find(objectIdTaken.begin(), objectIdTaken.begin() + movableDoorCnt, false) !=
+        objectIdTaken.begin() + movableDoorCnt) {
+        std::cerr << "(!) Serialization::deserialize: object ids of movable doors aren't contiguous\n";
+        return std::nullopt;
+    }
+
+    Corridors corridors(resource);
+    corridors.reserve(header.corridorCnt);
+    for (size_t corridorId = 0; corridorId < header.corridorCnt; ++corridorId) {
+        CorridorRecord record;
+        if (!reader.read(record)) {
+            std::cerr << "(!) Serialization::deserialize: corridor " << corridorId << " is truncated\n";
+            return std::nullopt;
+        }
+        if (record.door1Id >= header.doorCnt || record.door2Id >= header.doorCnt) {
+            std::cerr << "(!) Serialization::deserialize: corridor " << corridorId << " has invalid door id\n";
+            return std::nullopt;
+        }
+        corridors.push_back(Corridor{.door1Id = record.door1Id, .door2Id = record.door2Id});
+    }
+
+    return Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+}  // namespace Serialization
+}  // namespace Model
+}  // namespace DungeonGeneration
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Model.h"
+
+namespace DungeonGeneration {
+namespace Model {
+
+/// Binary format of a solved model for handing it over to other processes or languages: header followed by the room,
+/// door and corridor tables. Numbers are stored in native byte order.
+namespace Serialization {
+
+/// All positions must be set
+std::vector<uint8_t> serialize(const Model& model);
+/// Returns nullopt if `data` isn't a valid serialized model. Tables are allocated in `resource`.
+std::optional<Model> deserialize(
+    const uint8_t* data, size_t size, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+}  // namespace Serialization
+}  // namespace Model
+}  // namespace DungeonGeneration
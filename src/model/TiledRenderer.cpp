@@ -0,0 +1,369 @@
+#include "TiledRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <svgwrite/writer.hpp>
+
+#include "SVGUtils.h"
+
+namespace DungeonGeneration {
+namespace Model {
+
+namespace {
+
+constexpr double kWorldPadding = 0.02;  // Relative to the layout size
+constexpr double kIndexCellRooms = 2.0;  // Index cell side in average room sides
+
+Spatial::Box getRoomBox(const Room& room)
+{
+    const Position lbPos = room.getLBPosition();
+    return Spatial::Box{
+        .minX = lbPos.x, .minY = lbPos.y, .maxX = lbPos.x + room.width(), .maxY = lbPos.y + room.height()};
+}
+
+Spatial::Box getCorridorBox(const Model& model, const Corridor& corridor)
+{
+    const Door& door1 = model.doors()[corridor.door1Id];
+    const Door& door2 = model.doors()[corridor.door2Id];
+    const Position pos1 = door1.getCenterPosition(model.rooms()[door1.parentRoomId()]);
+    const Position pos2 = door2.getCenterPosition(model.rooms()[door2.parentRoomId()]);
+    return Spatial::Box{.minX = std::min(pos1.x, pos2.x),
+                        .minY = std::min(pos1.y, pos2.y),
+                        .maxX = std::max(pos1.x, pos2.x),
+                        .maxY = std::max(pos1.y, pos2.y)};
+}
+
+/// Square around all rooms with a small padding
+Spatial::Box calculateWorldBox(const Model& model)
+{
+    if (model.rooms().empty()) {
+        return Spatial::Box{.minX = 0.0, .minY = 0.0, .maxX = 1.0, .maxY = 1.0};
+    }
+    Spatial::Box result = getRoomBox(model.rooms().front());
+    for (const Room& room : model.rooms()) {
+        const Spatial::Box roomBox = getRoomBox(room);
+        result.minX = std::min(result.minX, roomBox.minX);
+        result.minY = std::min(result.minY, roomBox.minY);
+        result.maxX = std::max(result.maxX, roomBox.maxX);
+        result.maxY = std::max(result.maxY, roomBox.maxY);
+    }
+    const double side = std::max(result.maxX - result.minX, result.maxY - result.minY) * (1.0 + 2 * kWorldPadding);
+    const double centerX = (result.minX + result.maxX) / 2;
+    const double centerY = (result.minY + result.maxY) / 2;
+    return Spatial::Box{
+        .minX = centerX - side / 2, .minY = centerY - side / 2, .maxX = centerX + side / 2, .maxY = centerY + side / 2};
+}
+
+double calculateAverageRoomSide(const Model& model)
+{
+    if (model.rooms().empty()) {
+        return 1.0;
+    }
+    double sidesSum = 0.0;
+    for (const Room& room : model.rooms()) {
+        sidesSum += std::sqrt(room.width() * room.height());
+    }
+    return sidesSum / model.rooms().size();
+}
+
+double getIntersectionArea(const Spatial::Box& box1, const Spatial::Box& box2)
+{
+    const double width = std::min(box1.maxX, box2.maxX) - std::max(box1.minX, box2.minX);
+    const double height = std::min(box1.maxY, box2.maxY) - std::max(box1.minY, box2.minY);
+    return (width > 0 && height > 0 ? width * height : 0.0);
+}
+
+}  // namespace
+
+TiledRenderer::TiledRenderer(const Model& model, const TilingOptions& options)
+      : model_(model),
+        options_(options),
+        worldBox_(calculateWorldBox(model)),
+        roomIndex_(worldBox_, kIndexCellRooms * calculateAverageRoomSide(model)),
+        corridorIndex_(worldBox_, kIndexCellRooms * calculateAverageRoomSide(model))
+{
+    assert(options_.tileSize > 0 && options_.aggregationCellPixels > 0 && "TiledRenderer: invalid options");
+
+    for (const Room& room : model_.rooms()) {
+        assert(room.isPositionSet() && "TiledRenderer: rooms must have a position");
+        roomIndex_.insert(room.id(), getRoomBox(room));
+    }
+    for (size_t corridorId = 0; corridorId < model_.corridors().size(); ++corridorId) {
+        corridorIndex_.insert(corridorId, getCorridorBox(model_, model_.corridors()[corridorId]));
+    }
+
+    // Doors grouped by parent room
+    roomDoorOffsets_.assign(model_.rooms().size() + 1, 0);
+    for (const Door& door : model_.doors()) {
+        ++roomDoorOffsets_[door.parentRoomId() + 1];
+    }
+    for (size_t roomId = 0; roomId < model_.rooms().size(); ++roomId) {
+        roomDoorOffsets_[roomId + 1] += roomDoorOffsets_[roomId];
+    }
+    roomDoors_.resize(model_.doors().size());
+    std::vector<size_t> nextDoor(roomDoorOffsets_.begin(), roomDoorOffsets_.end() - 1);
+    for (size_t doorId = 0; doorId < model_.doors().size(); ++doorId) {
+        roomDoors_[nextDoor[model_.doors()[doorId].parentRoomId()]++] = doorId;
+    }
+
+    if (!options_.maxZoom.has_value()) {
+        // Zoom 0 shows the whole world in a single tile, each level doubles the scale
+        const double worldSide = worldBox_.maxX - worldBox_.minX;
+        const double scale = kDefaultRoomPixels * worldSide / (options_.tileSize * calculateAverageRoomSide(model_));
+        const double zoom = std::ceil(std::log2(std::max(scale, 1.0)));
+        options_.maxZoom = static_cast<size_t>(std::min(zoom, static_cast<double>(kMaxZoom)));
+    }
+    options_.maxZoom = std::min(options_.maxZoom.value(), kMaxZoom);
+}
+
+size_t TiledRenderer::getMaxZoom() const
+{
+    return options_.maxZoom.value();
+}
+
+size_t TiledRenderer::render(const std::filesystem::path& outputDirectory) const
+{
+    const std::vector<TileId> tiles = collectTiles();
+
+    // Directories are created upfront, so that workers only write files
+    std::error_code errorCode;
+    for (size_t tileId = 0; tileId < tiles.size(); ++tileId) {
+        const TileId& tile = tiles[tileId];
+        if (tileId > 0 && tiles[tileId - 1].zoom == tile.zoom && tiles[tileId - 1].x == tile.x) {
+            continue;
+        }
+        std::filesystem::create_directories(
+            outputDirectory / std::to_string(tile.zoom) / std::to_string(tile.x), errorCode);
+        if (errorCode) {
+            std::cerr << "(!) TiledRenderer::render: can't create tile directories: " << errorCode.message() << "\n";
+            return 0;
+        }
+    }
+
+    size_t threadCount = options_.threadCount;
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, std::max<size_t>(tiles.size(), 1));
+
+    std::atomic<size_t> nextTile = 0;
+    std::atomic<size_t> writtenCount = 0;
+    auto runWorker = [&]() {
+        for (size_t tileId = nextTile++; tileId < tiles.size(); tileId = nextTile++) {
+            const TileId& tile = tiles[tileId];
+            const std::filesystem::path tilePath = outputDirectory / std::to_string(tile.zoom) /
+                                                   std::to_string(tile.x) / (std::to_string(tile.y) + ".svg");
+            std::ofstream ofstream(tilePath);
+            renderTile(tile.zoom, tile.x, tile.y, ofstream);
+            if (!ofstream) {
+                std::cerr << "(!) TiledRenderer::render: can't write " << tilePath << "\n";
+                continue;
+            }
+            ++writtenCount;
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(threadCount - 1);
+    for (size_t workerId = 1; workerId < threadCount; ++workerId) {
+        workers.emplace_back(runWorker);
+    }
+    runWorker();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    writeMetadata(outputDirectory);
+    return writtenCount;
+}
+
+void TiledRenderer::renderTile(size_t zoom, size_t tileX, size_t tileY, std::ostream& ostream) const
+{
+    const Spatial::Box tileBox = getTileBox(zoom, tileX, tileY);
+    const double tileSide = tileBox.maxX - tileBox.minX;
+    const double pixelsPerUnit = getPixelsPerUnit(zoom);
+    const bool showDoors = Door::kSVGSize * pixelsPerUnit >= options_.minDoorPixels;
+
+    svgw::writer svgWriter(ostream);
+    const std::string tileSize = std::to_string(options_.tileSize);
+    const std::string viewBox =
+        (std::stringstream() << tileBox.minX << ' ' << -tileBox.maxY << ' ' << tileSide << ' ' << tileSide).str();
+    svgWriter.start_svg(
+        tileSize, tileSize,
+        {
+            {"viewBox", viewBox}
+    });
+    svgWriter.write("\n");
+
+    // Doors stick out of their rooms, so rooms just outside of the tile are needed too
+    const double doorMargin = Door::kSVGSize / 2;
+    const Spatial::Box roomQueryBox{.minX = tileBox.minX - doorMargin,
+                                    .minY = tileBox.minY - doorMargin,
+                                    .maxX = tileBox.maxX + doorMargin,
+                                    .maxY = tileBox.maxY + doorMargin};
+    std::vector<size_t> roomIds;
+    roomIndex_.query(roomQueryBox, roomIds);
+
+    // Small rooms are summed up into a grid of density cells: opacity of a cell is the share of its area covered
+    const size_t cellCount = std::max<size_t>(1, options_.tileSize / options_.aggregationCellPixels);
+    const double cellSide = tileSide / cellCount;
+    std::vector<double> coveredArea(cellCount * cellCount, 0.0);
+    bool hasSmallRooms = false;
+    for (const size_t roomId : roomIds) {
+        if (isRoomDetailed(roomId, pixelsPerUnit)) {
+            continue;
+        }
+        const Spatial::Box roomBox = getRoomBox(model_.rooms()[roomId]);
+        if (!roomBox.intersects(tileBox)) {
+            continue;
+        }
+        hasSmallRooms = true;
+        auto toCell = [cellSide, cellCount](double coordinate, double origin) {
+            const double cell = std::floor((coordinate - origin) / cellSide);
+            return static_cast<size_t>(std::clamp(cell, 0.0, static_cast<double>(cellCount - 1)));
+        };
+        const size_t cellX1 = toCell(roomBox.minX, tileBox.minX);
+        const size_t cellX2 = toCell(roomBox.maxX, tileBox.minX);
+        const size_t cellY1 = toCell(roomBox.minY, tileBox.minY);
+        const size_t cellY2 = toCell(roomBox.maxY, tileBox.minY);
+        for (size_t cellY = cellY1; cellY <= cellY2; ++cellY) {
+            for (size_t cellX = cellX1; cellX <= cellX2; ++cellX) {
+                const double cellMinX = tileBox.minX + cellX * cellSide;
+                const double cellMinY = tileBox.minY + cellY * cellSide;
+                const Spatial::Box cellBox{
+                    .minX = cellMinX, .minY = cellMinY, .maxX = cellMinX + cellSide, .maxY = cellMinY + cellSide};
+                coveredArea[cellY * cellCount + cellX] += getIntersectionArea(roomBox, cellBox);
+            }
+        }
+    }
+    if (hasSmallRooms) {
+        const double cellArea = cellSide * cellSide;
+        for (size_t cellY = 0; cellY < cellCount; ++cellY) {
+            for (size_t cellX = 0; cellX < cellCount; ++cellX) {
+                const double area = coveredArea[cellY * cellCount + cellX];
+                if (area <= 0) {
+                    continue;
+                }
+                svgWriter.write(SVGUtils::generateSVGFilledRectangle(
+                    tileBox.minX + cellX * cellSide, tileBox.minY + cellY * cellSide, cellSide, cellSide, "olive",
+                    std::min(area / cellArea, 1.0)));
+            }
+        }
+        svgWriter.write("\n");
+    }
+
+    for (const size_t roomId : roomIds) {
+        if (isRoomDetailed(roomId, pixelsPerUnit)) {
+            model_.rooms()[roomId].dumpToSVG(svgWriter);
+            svgWriter.write("\n");
+        }
+    }
+    if (showDoors) {
+        for (const size_t roomId : roomIds) {
+            if (!isRoomDetailed(roomId, pixelsPerUnit)) {
+                continue;
+            }
+            const Room& room = model_.rooms()[roomId];
+            for (size_t i = roomDoorOffsets_[roomId]; i < roomDoorOffsets_[roomId + 1]; ++i) {
+                model_.doors()[roomDoors_[i]].dumpToSVG(svgWriter, room);
+            }
+        }
+        svgWriter.write("\n");
+    }
+
+    std::vector<size_t> corridorIds;
+    corridorIndex_.query(tileBox, corridorIds);
+    for (const size_t corridorId : corridorIds) {
+        const Corridor& corridor = model_.corridors()[corridorId];
+        const auto [roomId1, roomId2] = model_.getCorridorRooms(corridor);
+        if (isRoomDetailed(roomId1, pixelsPerUnit) && isRoomDetailed(roomId2, pixelsPerUnit)) {
+            corridor.dumpToSVG(svgWriter, model_.rooms(), model_.doors());
+            svgWriter.write("\n");
+        }
+    }
+
+    svgWriter.end_svg();
+}
+
+Spatial::Box TiledRenderer::getTileBox(size_t zoom, size_t tileX, size_t tileY) const
+{
+    const double tileSide = (worldBox_.maxX - worldBox_.minX) / static_cast<double>(size_t(1) << zoom);
+    const double maxY = worldBox_.maxY - tileY * tileSide;
+    const double minX = worldBox_.minX + tileX * tileSide;
+    return Spatial::Box{.minX = minX, .minY = maxY - tileSide, .maxX = minX + tileSide, .maxY = maxY};
+}
+
+double TiledRenderer::getPixelsPerUnit(size_t zoom) const
+{
+    return static_cast<double>(options_.tileSize << zoom) / (worldBox_.maxX - worldBox_.minX);
+}
+
+bool TiledRenderer::isRoomDetailed(size_t roomId, double pixelsPerUnit) const
+{
+    const Room& room = model_.rooms()[roomId];
+    return std::min(room.width(), room.height()) * pixelsPerUnit >= options_.minRoomPixels;
+}
+
+std::vector<TiledRenderer::TileId> TiledRenderer::collectTiles() const
+{
+    std::vector<Spatial::Box> boxes;
+    boxes.reserve(model_.rooms().size() + model_.corridors().size());
+    for (const Room& room : model_.rooms()) {
+        boxes.push_back(getRoomBox(room));
+    }
+    for (const Corridor& corridor : model_.corridors()) {
+        boxes.push_back(getCorridorBox(model_, corridor));
+    }
+
+    std::vector<TileId> result;
+    std::vector<uint64_t> tileKeys;  // (x, y) packed into one number, so that sorting orders tiles by x
+    for (size_t zoom = 0; zoom <= getMaxZoom(); ++zoom) {
+        const size_t tilesPerSide = size_t(1) << zoom;
+        const double tileSide = (worldBox_.maxX - worldBox_.minX) / tilesPerSide;
+        auto toTile = [tileSide, tilesPerSide](double distance) {
+            const double tile = std::floor(distance / tileSide);
+            return static_cast<uint64_t>(std::clamp(tile, 0.0, static_cast<double>(tilesPerSide - 1)));
+        };
+        tileKeys.clear();
+        for (const Spatial::Box& box : boxes) {
+            const uint64_t tileX1 = toTile(box.minX - worldBox_.minX);
+            const uint64_t tileX2 = toTile(box.maxX - worldBox_.minX);
+            const uint64_t tileY1 = toTile(worldBox_.maxY - box.maxY);
+            const uint64_t tileY2 = toTile(worldBox_.maxY - box.minY);
+            for (uint64_t tileX = tileX1; tileX <= tileX2; ++tileX) {
+                for (uint64_t tileY = tileY1; tileY <= tileY2; ++tileY) {
+                    tileKeys.push_back((tileX << 32) | tileY);
+                }
+            }
+        }
+        std::sort(tileKeys.begin(), tileKeys.end());
+        tileKeys.erase(std::unique(tileKeys.begin(), tileKeys.end()), tileKeys.end());
+        for (const uint64_t tileKey : tileKeys) {
+            result.push_back(TileId{.zoom = static_cast<uint32_t>(zoom),
+                                    .x = static_cast<uint32_t>(tileKey >> 32),
+                                    .y = static_cast<uint32_t>(tileKey & UINT32_MAX)});
+        }
+    }
+    return result;
+}
+
+void TiledRenderer::writeMetadata(const std::filesystem::path& outputDirectory) const
+{
+    std::ofstream ofstream(outputDirectory / "tiles.json");
+    ofstream << "{\"tileSize\": " << options_.tileSize << ", \"minZoom\": 0, \"maxZoom\": " << getMaxZoom()
+             << ", \"bounds\": [" << worldBox_.minX << ", " << worldBox_.minY << ", " << worldBox_.maxX << ", "
+             << worldBox_.maxY << "], \"roomCount\": " << model_.rooms().size() << "}\n";
+    if (!ofstream) {
+        std::cerr << "(!) TiledRenderer::writeMetadata: can't write tiles.json\n";
+    }
+}
+
+}  // namespace Model
+}  // namespace DungeonGeneration
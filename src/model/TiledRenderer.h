@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include <utils/GridIndex.h>
+
+#include "Model.h"
+
+namespace DungeonGeneration {
+namespace Model {
+
+struct TilingOptions {
+    size_t tileSize = 256;  // Tile side in pixels
+    /// Deepest zoom level. By default it is chosen so that an average room is `kDefaultRoomPixels` wide.
+    std::optional<size_t> maxZoom;
+    double minRoomPixels = 4.0;  // Smaller rooms are aggregated into density cells
+    double minDoorPixels = 2.0;  // Smaller doors are hidden
+    size_t aggregationCellPixels = 8;  // Side of a density cell
+    size_t threadCount = 0;  // 0 is the number of hardware threads
+};
+
+/// Renders a solved model into a quadtree of SVG tiles, `z/x/y.svg`, like web map tiles: zoom 0 is a single tile with
+/// the whole layout, each next level splits every tile into four, `y` grows downwards. Rooms, doors and corridors are
+/// indexed once, so a tile costs as much as the objects it shows. Rooms that would be smaller than a few pixels are
+/// drawn as density cells instead, doors and corridors of such rooms are hidden. Only non-empty tiles are written.
+class TiledRenderer {
+public:
+    static constexpr size_t kMaxZoom = 20;
+    static constexpr double kDefaultRoomPixels = 32.0;
+
+    /// Model must be solved and outlive the renderer
+    TiledRenderer(const Model& model, const TilingOptions& options = {});
+
+    size_t getMaxZoom() const;
+    /// Writes all tiles and `tiles.json` with the tiling parameters. Returns the number of written tiles.
+    size_t render(const std::filesystem::path& outputDirectory) const;
+    /// Single tile, tiles outside of the layout are empty
+    void renderTile(size_t zoom, size_t tileX, size_t tileY, std::ostream& ostream) const;
+
+private:
+    struct TileId {
+        uint32_t zoom;
+        uint32_t x;
+        uint32_t y;
+    };
+
+    Spatial::Box getTileBox(size_t zoom, size_t tileX, size_t tileY) const;
+    double getPixelsPerUnit(size_t zoom) const;
+    bool isRoomDetailed(size_t roomId, double pixelsPerUnit) const;
+    /// Tiles intersecting any room or corridor, in zoom order
+    std::vector<TileId> collectTiles() const;
+    void writeMetadata(const std::filesystem::path& outputDirectory) const;
+
+    const Model& model_;
+    TilingOptions options_;
+    Spatial::Box worldBox_;  // Square around the layout, it is the zoom 0 tile
+    Spatial::GridIndex roomIndex_;
+    Spatial::GridIndex corridorIndex_;
+    // Doors grouped by parent room: doors of room i are roomDoors_[roomDoorOffsets_[i]..roomDoorOffsets_[i + 1])
+    std::vector<size_t> roomDoorOffsets_;
+    std::vector<size_t> roomDoors_;
+};
+
+}  // namespace Model
+}  // namespace DungeonGeneration
@@ -0,0 +1,107 @@
+#include "Validation.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace DungeonGeneration {
+namespace Model {
+namespace Validation {
+
+namespace {
+
+// Rooms that are touching or intersect by less than this value are considered to be fine
+constexpr double kOverlapTolerance = 1e-3;
+
+bool areOverlapping(const Room& room1, const Room& room2)
+{
+    const Position center1 = room1.getCenterPosition();
+    const Position center2 = room2.getCenterPosition();
+    const double sumHalfWidth = (room1.width() + room2.width()) / 2;
+    const double sumHalfHeight = (room1.height() + room2.height()) / 2;
+    return std::abs(center1.x - center2.x) < sumHalfWidth - kOverlapTolerance &&
+           std::abs(center1.y - center2.y) < sumHalfHeight - kOverlapTolerance;
+}
+
+/// Sign of the cross product (b - a) x (c - a)
+int orientation(Position a, Position b, Position c)
+{
+    const double cross = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::abs(cross) < 1e-9) {
+        return 0;
+    }
+    return cross > 0 ? 1 : -1;
+}
+
+/// Checks whether segments properly cross each other. Touching and collinear segments are not considered crossing.
+bool areCrossing(Position a1, Position a2, Position b1, Position b2)
+{
+    return orientation(a1, a2, b1) * orientation(a1, a2, b2) < 0 &&
+           orientation(b1, b2, a1) * orientation(b1, b2, a2) < 0;
+}
+
+}  // namespace
+
+bool Defects::empty() const
+{
+    return overlappingRooms.empty() && crossingCorridors.empty();
+}
+
+size_t Defects::count() const
+{
+    return overlappingRooms.size() + crossingCorridors.size();
+}
+
+Defects findDefects(const Model& model)
+{
+    Defects defects;
+
+    const Rooms& rooms = model.rooms();
+    for (size_t i = 0; i < rooms.size(); ++i) {
+        assert(rooms[i].isPositionSet() && "Validation::findDefects: room position must be set");
+        for (size_t j = i + 1; j < rooms.size(); ++j) {
+            if (areOverlapping(rooms[i], rooms[j])) {
+                defects.overlappingRooms.push_back({i, j});
+            }
+        }
+    }
+
+    const Doors& doors = model.doors();
+    const Corridors& corridors = model.corridors();
+    std::vector<std::pair<Position, Position>> segments;
+    segments.reserve(corridors.size());
+    for (const Corridor& corridor : corridors) {
+        const Door& door1 = doors[corridor.door1Id];
+        const Door& door2 = doors[corridor.door2Id];
+        segments.emplace_back(
+            door1.getCenterPosition(rooms[door1.parentRoomId()]), door2.getCenterPosition(rooms[door2.parentRoomId()]));
+    }
+    for (size_t i = 0; i < corridors.size(); ++i) {
+        for (size_t j = i + 1; j < corridors.size(); ++j) {
+            const auto& [a1, a2] = segments[i];
+            const auto& [b1, b2] = segments[j];
+            if (areCrossing(a1, a2, b1, b2)) {
+                defects.crossingCorridors.push_back({i, j});
+            }
+        }
+    }
+    return defects;
+}
+
+double totalCorridorLength(const Model& model)
+{
+    const Rooms& rooms = model.rooms();
+    const Doors& doors = model.doors();
+    double totalLength = 0.0;
+    for (const Corridor& corridor : model.corridors()) {
+        const Door& door1 = doors[corridor.door1Id];
+        const Door& door2 = doors[corridor.door2Id];
+        const Position pos1 = door1.getCenterPosition(rooms[door1.parentRoomId()]);
+        const Position pos2 = door2.getCenterPosition(rooms[door2.parentRoomId()]);
+        totalLength += std::hypot(pos1.x - pos2.x, pos1.y - pos2.y);
+    }
+    return totalLength;
+}
+
+}  // namespace Validation
+}  // namespace Model
+}  // namespace DungeonGeneration
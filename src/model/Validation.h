@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Model.h"
+
+namespace DungeonGeneration {
+namespace Model {
+namespace Validation {
+
+struct RoomsOverlap {
+    size_t roomId1;
+    size_t roomId2;
+};
+
+struct CorridorsCrossing {
+    size_t corridorId1;
+    size_t corridorId2;
+};
+
+/// Imperfections of the final layout that the solver failed to get rid of.
+struct Defects {
+    std::vector<RoomsOverlap> overlappingRooms;
+    std::vector<CorridorsCrossing> crossingCorridors;
+
+    bool empty() const;
+    size_t count() const;
+};
+
+/// Find overlapping rooms and crossing corridors. Positions of all rooms and doors must be set.
+Defects findDefects(const Model& model);
+
+/// Sum of Euclidean corridor lengths. Used to compare layouts with the same defects count.
+double totalCorridorLength(const Model& model);
+
+}  // namespace Validation
+}  // namespace Model
+}  // namespace DungeonGeneration
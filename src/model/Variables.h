@@ -17,6 +17,7 @@ struct Variables {
     double varY;
 };
 
+/// Ends may be infinite
 struct Interval {
     double lowerBound;
     double upperBound;
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <model/CorridorRouter.h>
+#include <test-utils/TestUtils.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+/// Square rooms of side 10 centered at `centers`, corridors connect the right door of one room to the left door of
+/// another one: door 2i is on the left side of room i, door 2i + 1 is on its right side
+Model::Model createModel(
+    const std::vector<Model::Position>& centers, const std::vector<std::pair<size_t, size_t>>& connectedRooms)
+{
+    Model::Rooms rooms;
+    Model::Doors doors;
+    for (size_t roomId = 0; roomId < centers.size(); ++roomId) {
+        rooms.emplace_back(roomId, 10.0, 10.0, centers[roomId]);
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = -5.0, .y = 0.0}));
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = 5.0, .y = 0.0}));
+    }
+    Model::Corridors corridors;
+    for (const auto& [roomId1, roomId2] : connectedRooms) {
+        corridors.push_back(Model::Corridor{.door1Id = 2 * roomId1 + 1, .door2Id = 2 * roomId2});
+    }
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+void expectRoutedAndValid(const Model::Model& model, const Model::RoutingOptions& options = {})
+{
+    const Model::CorridorRoutes routes = Model::CorridorRouter(model, options).routeAll();
+    ASSERT_EQ(routes.size(), model.corridors().size());
+    for (size_t corridorId = 0; corridorId < routes.size(); ++corridorId) {
+        const Model::CorridorRoute& route = routes[corridorId];
+        ASSERT_GE(route.size(), 2u) << "Corridor " << corridorId;
+        const Model::Corridor& corridor = model.corridors()[corridorId];
+        const Model::Door& door1 = model.doors()[corridor.door1Id];
+        const Model::Door& door2 = model.doors()[corridor.door2Id];
+        const Model::Position start = door1.getCenterPosition(model.rooms()[door1.parentRoomId()]);
+        const Model::Position end = door2.getCenterPosition(model.rooms()[door2.parentRoomId()]);
+        EXPECT_EQ(route.front().x, start.x);
+        EXPECT_EQ(route.front().y, start.y);
+        EXPECT_EQ(route.back().x, end.x);
+        EXPECT_EQ(route.back().y, end.y);
+    }
+    EXPECT_EQ(TestUtils::countInvalidRoutes(model, routes), 0u);
+}
+
+}  // namespace
+
+TEST(CorridorRouterTests, StraightRouteTest)
+{
+    const Model::Model model = createModel({{0.0, 0.0}, {40.0, 0.0}}, {{0, 1}});
+    const Model::CorridorRoute route = Model::CorridorRouter(model).route(0);
+    ASSERT_EQ(route.size(), 2u);
+    EXPECT_EQ(route[0].x, 5.0);
+    EXPECT_EQ(route[1].x, 35.0);
+    expectRoutedAndValid(model);
+}
+
+TEST(CorridorRouterTests, CloseRoomsTest)
+{
+    // Room 1 is closer to room 0 than two clearances, room 2 is behind it: the exit of room 0 is inside the inflated
+    // box of room 1, and the route must still go around room 1
+    for (const double gap : {2.0, 1.5, 1.0, 0.5, 0.0}) {
+        SCOPED_TRACE(gap);
+        const Model::Model model = createModel({{0.0, 0.0}, {10.0 + gap, 0.0}, {40.0, 0.0}}, {{0, 2}, {2, 1}});
+        expectRoutedAndValid(model);
+    }
+    const Model::Model model = createModel({{0.0, 0.0}, {13.0, 2.0}, {40.0, 0.0}}, {{0, 2}, {1, 2}});
+    Model::RoutingOptions options;
+    options.clearance = 3.0;
+    expectRoutedAndValid(model, options);
+}
+
+TEST(CorridorRouterTests, OverlappingRoomsTest)
+{
+    // Rooms 1 and 2 overlap and block the straight line between rooms 0 and 3
+    const Model::Model model = createModel({{-30.0, 0.0}, {0.0, 1.0}, {6.0, -3.0}, {36.0, 0.0}}, {{0, 3}});
+    expectRoutedAndValid(model);
+}
+
+TEST(CorridorRouterTests, UnroutableCorridorTest)
+{
+    // Room 0 is walled in by four overlapping rooms, room 1 is outside
+    Model::Rooms rooms;
+    rooms.emplace_back(0, 4.0, 4.0, Model::Position{.x = 0.0, .y = 0.0});
+    rooms.emplace_back(1, 10.0, 10.0, Model::Position{.x = 60.0, .y = 0.0});
+    rooms.emplace_back(2, 10.0, 40.0, Model::Position{.x = -15.0, .y = 0.0});
+    rooms.emplace_back(3, 10.0, 40.0, Model::Position{.x = 15.0, .y = 0.0});
+    rooms.emplace_back(4, 40.0, 10.0, Model::Position{.x = 0.0, .y = -15.0});
+    rooms.emplace_back(5, 40.0, 10.0, Model::Position{.x = 0.0, .y = 15.0});
+    Model::Doors doors;
+    doors.push_back(Model::Door::createFixedDoor(0, Model::Position{.x = 2.0, .y = 0.0}));
+    doors.push_back(Model::Door::createFixedDoor(1, Model::Position{.x = -5.0, .y = 0.0}));
+    Model::Corridors corridors{Model::Corridor{.door1Id = 0, .door2Id = 1}};
+    const Model::Model model(std::move(rooms), std::move(doors), std::move(corridors));
+
+    EXPECT_TRUE(Model::CorridorRouter(model).route(0).empty());
+}
+
+TEST(CorridorRouterTests, AllRoutesValidTest)
+{
+    // Gaps between rooms of the layout are at least 4, so the larger clearances make some of them too narrow
+    const Model::Model model = TestUtils::createGridLayout(2000, true);
+    for (const double clearance : {1.0, 3.0, 5.0}) {
+        SCOPED_TRACE(clearance);
+        Model::RoutingOptions options;
+        options.clearance = clearance;
+        expectRoutedAndValid(model, options);
+    }
+}
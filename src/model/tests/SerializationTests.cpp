@@ -0,0 +1,118 @@
+#include <cstring>
+#include <limits>
+
+#include <gtest/gtest.h>
+
+#include <model/Serialization.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+// Layout of the format, see Serialization.cpp
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kRoomRecordSize = 32;
+constexpr size_t kDoorRecordSize = 32;
+constexpr size_t kRoomCntOffset = 8;
+
+/// Two rooms, a fixed door and two movable doors, two corridors
+Model::Model createModel()
+{
+    Model::Rooms rooms;
+    rooms.emplace_back(0, 10.0, 20.0, Model::Position{.x = 1.5, .y = -2.0});
+    rooms.emplace_back(1, 30.0, 15.0, Model::Position{.x = 40.0, .y = 7.25});
+    Model::Doors doors;
+    doors.push_back(Model::Door::createFixedDoor(0, Model::Position{.x = 5.0, .y = 0.0}));
+    doors.push_back(Model::Door::createMovableDoor(1, 2));
+    doors.back().setShift(Model::Position{.x = -3.0, .y = 1.0});
+    doors.push_back(Model::Door::createMovableDoor(0, 3));
+    doors.back().setShift(Model::Position{.x = 0.5, .y = -4.0});
+    Model::Corridors corridors{
+        Model::Corridor{.door1Id = 0, .door2Id = 1}, Model::Corridor{.door1Id = 2, .door2Id = 1}};
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+void writeUInt64(std::vector<uint8_t>& data, size_t offset, uint64_t value)
+{
+    ASSERT_LE(offset + sizeof(value), data.size());
+    std::memcpy(data.data() + offset, &value, sizeof(value));
+}
+
+}  // namespace
+
+TEST(SerializationTests, TestRoundTrip)
+{
+    const Model::Model model = createModel();
+    const std::vector<uint8_t> data = Model::Serialization::serialize(model);
+    const std::optional<Model::Model> restored = Model::Serialization::deserialize(data.data(), data.size());
+    ASSERT_TRUE(restored.has_value());
+
+    ASSERT_EQ(restored->rooms().size(), model.rooms().size());
+    for (size_t roomId = 0; roomId < model.rooms().size(); ++roomId) {
+        const Model::Room& room = model.rooms()[roomId];
+        const Model::Room& restoredRoom = restored->rooms()[roomId];
+        EXPECT_EQ(restoredRoom.id(), roomId);
+        EXPECT_EQ(restoredRoom.width(), room.width());
+        EXPECT_EQ(restoredRoom.height(), room.height());
+        EXPECT_EQ(restoredRoom.getCenterPosition().x, room.getCenterPosition().x);
+        EXPECT_EQ(restoredRoom.getCenterPosition().y, room.getCenterPosition().y);
+    }
+    ASSERT_EQ(restored->doors().size(), model.doors().size());
+    for (size_t doorId = 0; doorId < model.doors().size(); ++doorId) {
+        const Model::Door& door = model.doors()[doorId];
+        const Model::Door& restoredDoor = restored->doors()[doorId];
+        EXPECT_EQ(restoredDoor.parentRoomId(), door.parentRoomId());
+        EXPECT_EQ(restoredDoor.isMovable(), door.isMovable());
+        if (door.isMovable()) {
+            EXPECT_EQ(restoredDoor.varObjectId(), door.varObjectId());
+        }
+        EXPECT_EQ(restoredDoor.shift().x, door.shift().x);
+        EXPECT_EQ(restoredDoor.shift().y, door.shift().y);
+    }
+    ASSERT_EQ(restored->corridors().size(), model.corridors().size());
+    for (size_t corridorId = 0; corridorId < model.corridors().size(); ++corridorId) {
+        EXPECT_EQ(restored->corridors()[corridorId].door1Id, model.corridors()[corridorId].door1Id);
+        EXPECT_EQ(restored->corridors()[corridorId].door2Id, model.corridors()[corridorId].door2Id);
+    }
+    EXPECT_EQ(restored->getVariablesCount(), model.getVariablesCount());
+
+    // Serialization of the restored model is the same buffer
+    EXPECT_EQ(Model::Serialization::serialize(restored.value()), data);
+}
+
+TEST(SerializationTests, TestTruncatedData)
+{
+    std::vector<uint8_t> data = Model::Serialization::serialize(createModel());
+    for (size_t size = 0; size < data.size(); ++size) {
+        EXPECT_FALSE(Model::Serialization::deserialize(data.data(), size).has_value()) << "size " << size;
+    }
+    // Trailing bytes aren't accepted either
+    data.push_back(0);
+    EXPECT_FALSE(Model::Serialization::deserialize(data.data(), data.size()).has_value());
+}
+
+TEST(SerializationTests, TestCorruptedData)
+{
+    const std::vector<uint8_t> data = Model::Serialization::serialize(createModel());
+    auto deserializeCorrupted = [&data](size_t offset, uint64_t value) {
+        std::vector<uint8_t> corrupted = data;
+        writeUInt64(corrupted, offset, value);
+        return Model::Serialization::deserialize(corrupted.data(), corrupted.size()).has_value();
+    };
+    constexpr size_t kDoorsOffset = kHeaderSize + 2 * kRoomRecordSize;
+    constexpr size_t kCorridorsOffset = kDoorsOffset + 3 * kDoorRecordSize;
+
+    // Magic
+    EXPECT_FALSE(deserializeCorrupted(0, 0));
+    // Huge counts must be rejected before anything is allocated
+    EXPECT_FALSE(deserializeCorrupted(kRoomCntOffset, std::numeric_limits<uint64_t>::max()));
+    EXPECT_FALSE(deserializeCorrupted(kRoomCntOffset, 3));
+    // Door with a parent room that doesn't exist
+    EXPECT_FALSE(deserializeCorrupted(kDoorsOffset + kDoorRecordSize, 2));
+    // Movable doors with the same object id, with an id of a room, with ids that leave a gap
+    EXPECT_FALSE(deserializeCorrupted(kDoorsOffset + 2 * kDoorRecordSize + 8, 2));
+    EXPECT_FALSE(deserializeCorrupted(kDoorsOffset + 2 * kDoorRecordSize + 8, 1));
+    EXPECT_FALSE(deserializeCorrupted(kDoorsOffset + 2 * kDoorRecordSize + 8, 4));
+    // Corridor with a door that doesn't exist
+    EXPECT_FALSE(deserializeCorrupted(kCorridorsOffset + 8, 3));
+}
@@ -0,0 +1,99 @@
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+
+#include <gtest/gtest.h>
+
+#include <model/TiledRenderer.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+/// Rooms 0 and 1 are connected and lie next to each other near the origin, room 2 lies alone in the opposite corner.
+/// The world box is the square [-7.2, 107.2] around them.
+Model::Model createModel()
+{
+    Model::Rooms rooms;
+    rooms.emplace_back(0, 10.0, 10.0, Model::Position{.x = 0.0, .y = 0.0});
+    rooms.emplace_back(1, 10.0, 10.0, Model::Position{.x = 20.0, .y = 0.0});
+    rooms.emplace_back(2, 10.0, 10.0, Model::Position{.x = 100.0, .y = 100.0});
+    Model::Doors doors;
+    doors.push_back(Model::Door::createFixedDoor(0, Model::Position{.x = 5.0, .y = 0.0}));
+    doors.push_back(Model::Door::createFixedDoor(1, Model::Position{.x = -5.0, .y = 0.0}));
+    Model::Corridors corridors{Model::Corridor{.door1Id = 0, .door2Id = 1}};
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+std::string renderTile(const Model::TiledRenderer& renderer, size_t zoom, size_t tileX, size_t tileY)
+{
+    std::ostringstream ostream;
+    renderer.renderTile(zoom, tileX, tileY, ostream);
+    return ostream.str();
+}
+
+}  // namespace
+
+TEST(TiledRendererTests, TestWrittenTiles)
+{
+    const Model::Model model = createModel();
+    const Model::TiledRenderer renderer(model, Model::TilingOptions{.maxZoom = 2, .threadCount = 2});
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "tiled_renderer_tests";
+    std::filesystem::remove_all(directory);
+
+    // Tiles are 57.2 units wide at zoom 1 and 28.6 at zoom 2, `y` counts from the top. Room 1 with the corridor spans
+    // two tiles at zoom 2, empty tiles aren't written.
+    EXPECT_EQ(renderer.render(directory), 6u);
+    std::set<std::string> tiles;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory)) {
+        if (entry.path().extension() == ".svg") {
+            tiles.insert(entry.path().lexically_relative(directory).generic_string());
+        }
+    }
+    EXPECT_EQ(
+        tiles, (std::set<std::string>{"0/0/0.svg", "1/0/1.svg", "1/1/0.svg", "2/0/3.svg", "2/1/3.svg", "2/3/0.svg"}));
+
+    std::ifstream metadata(directory / "tiles.json");
+    ASSERT_TRUE(metadata.is_open());
+    const std::string json((std::istreambuf_iterator<char>(metadata)), std::istreambuf_iterator<char>());
+    EXPECT_NE(json.find("\"tileSize\": 256"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"minZoom\": 0, \"maxZoom\": 2"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"bounds\": [-7.2, -7.2, 107.2, 107.2]"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"roomCount\": 3"), std::string::npos) << json;
+    std::filesystem::remove_all(directory);
+}
+
+TEST(TiledRendererTests, TestAggregationByZoom)
+{
+    const Model::Model model = createModel();
+    // 10 units wide rooms are about 22 pixels at zoom 0, 45 at zoom 1 and 90 at zoom 2
+    const Model::TiledRenderer renderer(model, Model::TilingOptions{.maxZoom = 2, .minRoomPixels = 60.0});
+
+    for (const auto& [zoom, tileX, tileY] : {std::tuple(0, 0, 0), std::tuple(1, 0, 1)}) {
+        const std::string tile = renderTile(renderer, zoom, tileX, tileY);
+        EXPECT_NE(tile.find("olive"), std::string::npos) << "zoom " << zoom;
+        EXPECT_EQ(tile.find("<title>room 0</title>"), std::string::npos) << "zoom " << zoom;
+        // Doors of aggregated rooms are hidden
+        EXPECT_EQ(tile.find("red"), std::string::npos) << "zoom " << zoom;
+    }
+    const std::string detailedTile = renderTile(renderer, 2, 0, 3);
+    EXPECT_EQ(detailedTile.find("olive"), std::string::npos);
+    EXPECT_NE(detailedTile.find("<title>room 0</title>"), std::string::npos);
+    EXPECT_NE(detailedTile.find("<title>room 1</title>"), std::string::npos);
+    EXPECT_NE(detailedTile.find("red"), std::string::npos);
+    // Room 2 is in another tile
+    EXPECT_EQ(detailedTile.find("<title>room 2</title>"), std::string::npos);
+}
+
+TEST(TiledRendererTests, TestDefaultMaxZoom)
+{
+    const Model::Model model = createModel();
+    // The average room must be about kDefaultRoomPixels wide at the deepest zoom
+    const Model::TiledRenderer renderer(model);
+    const double roomPixels = 10.0 * (256 << renderer.getMaxZoom()) / 114.4;
+    EXPECT_GE(roomPixels, Model::TiledRenderer::kDefaultRoomPixels);
+    EXPECT_LT(roomPixels / 2, Model::TiledRenderer::kDefaultRoomPixels);
+}
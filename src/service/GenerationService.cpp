@@ -0,0 +1,168 @@
+#include "GenerationService.h"
+
+#include <charconv>
+#include <chrono>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+#include <model/Serialization.h>
+
+#include "ServiceSettings.h"
+
+namespace DungeonGeneration {
+namespace Service {
+
+namespace {
+
+const std::unordered_map<std::string, DungeonType> kDungeonTypes{
+    {"grid", DungeonType::Grid},
+    {"center_doors", DungeonType::CenterDoors},
+    {"tree_fixed_doors", DungeonType::TreeFixedDoors},
+    {"movable_doors", DungeonType::MovableDoors},
+};
+
+HttpResponse makeError(int status, const std::string& message)
+{
+    return HttpResponse{.status = status, .body = message + "\n"};
+}
+
+/// Returns `defaultValue` if the parameter is absent, nullopt if it isn't a number
+template <typename T>
+std::optional<T> getNumber(const HttpRequest& request, const std::string& name, T defaultValue)
+{
+    const auto parameterIt = request.query.find(name);
+    if (parameterIt == request.query.end()) {
+        return defaultValue;
+    }
+    const std::string& value = parameterIt->second;
+    T number;
+    const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (error != std::errc() || end != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+std::string getString(const HttpRequest& request, const std::string& name, const std::string& defaultValue)
+{
+    const auto parameterIt = request.query.find(name);
+    return (parameterIt == request.query.end() ? defaultValue : parameterIt->second);
+}
+
+void writeSummary(std::ostream& ostream, const std::string& stage, const LatencySummary& summary)
+{
+    ostream << stage << "_count " << summary.count << "\n"
+            << stage << "_seconds_p50 " << summary.p50Seconds << "\n"
+            << stage << "_seconds_p99 " << summary.p99Seconds << "\n"
+            << stage << "_throughput_per_second " << summary.throughput << "\n";
+}
+
+}  // namespace
+
+GenerationService::GenerationService(const DungeonGenerator& generator, size_t workerCount, size_t maxQueueSize)
+      : workerPool_(generator, workerCount, kWorkspaceRoomCount),
+        maxQueueSize_(maxQueueSize)
+{}
+
+HttpResponse GenerationService::handle(const HttpRequest& request)
+{
+    if (request.method != "GET") {
+        return makeError(405, "Only GET is supported");
+    }
+    if (request.path == "/generate") {
+        return handleGenerate(request);
+    }
+    if (request.path == "/metrics") {
+        return handleMetrics();
+    }
+    return makeError(404, "Unknown path " + request.path);
+}
+
+HttpResponse GenerationService::handleMonitoring(const HttpRequest& request) const
+{
+    if (request.method != "GET") {
+        return makeError(405, "Only GET is supported");
+    }
+    if (request.path == "/metrics") {
+        return handleMetrics();
+    }
+    return makeError(404, "Unknown path " + request.path);
+}
+
+HttpResponse GenerationService::handleGenerate(const HttpRequest& request)
+{
+    const auto beginTimestamp = std::chrono::steady_clock::now();
+
+    GenerationConfig config = DungeonGenerator::getDefaultConfig();
+    config.usePortfolio = false;  // Workers already run in parallel
+    const std::optional<uint64_t> seed = getNumber<uint64_t>(request, "seed", config.seed);
+    const std::optional<size_t> roomCount = getNumber<size_t>(request, "rooms", config.roomCount);
+    const auto typeIt = kDungeonTypes.find(getString(request, "type", "movable_doors"));
+    const std::string format = getString(request, "format", "binary");
+    if (!seed.has_value()) {
+        return makeError(400, "seed must be a non-negative integer");
+    }
+    if (!roomCount.has_value() || roomCount.value() < 2 || roomCount.value() > kMaxRoomCount) {
+        return makeError(400, "rooms must be an integer in [2, " + std::to_string(kMaxRoomCount) + "]");
+    }
+    if (typeIt == kDungeonTypes.end()) {
+        return makeError(400, "type must be one of grid, center_doors, tree_fixed_doors, movable_doors");
+    }
+    if (format != "binary" && format != "svg") {
+        return makeError(400, "format must be binary or svg");
+    }
+    config.seed = seed.value();
+    config.solverParameters.seed = seed.value();
+    config.roomCount = roomCount.value();
+    config.dungeonType = typeIt->second;
+
+    std::optional<std::future<GenerationResult>> future = workerPool_.trySubmit(config, maxQueueSize_);
+    if (!future.has_value()) {
+        rejectedCount_++;
+        HttpResponse response = makeError(503, "Generation queue is full, retry later");
+        response.headers.emplace_back("Retry-After", "1");
+        return response;
+    }
+
+    GenerationResult result;
+    try {
+        result = future->get();
+    } catch (std::exception& error) {
+        failedCount_++;
+        return makeError(500, std::string("Generation failed: ") + error.what());
+    }
+    queueMetrics_.record(result.queueSeconds);
+    solverMetrics_.record(result.generationSeconds);
+
+    HttpResponse response;
+    if (format == "svg") {
+        std::ostringstream svg;
+        result.model.dumpToSVG(svg);
+        response.contentType = "image/svg+xml";
+        response.body = svg.str();
+    } else {
+        const std::vector<uint8_t> buffer = Model::Serialization::serialize(result.model);
+        response.contentType = "application/octet-stream";
+        response.body.assign(buffer.begin(), buffer.end());
+    }
+    totalMetrics_.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - beginTimestamp).count());
+    return response;
+}
+
+HttpResponse GenerationService::handleMetrics() const
+{
+    std::ostringstream metrics;
+    metrics << "queue_depth " << workerPool_.getQueueSize() << "\n"
+            << "workers " << workerPool_.getWorkerCount() << "\n"
+            << "rejected_count " << rejectedCount_.load() << "\n"
+            << "failed_count " << failedCount_.load() << "\n";
+    writeSummary(metrics, "queue", queueMetrics_.summarize());
+    writeSummary(metrics, "solver", solverMetrics_.summarize());
+    writeSummary(metrics, "request", totalMetrics_.summarize());
+    return HttpResponse{.body = metrics.str()};
+}
+
+}  // namespace Service
+}  // namespace DungeonGeneration
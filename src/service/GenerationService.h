@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include <DungeonGenerator.h>
+#include <WorkerPool.h>
+
+#include "HttpServer.h"
+#include "LatencyMetrics.h"
+
+namespace DungeonGeneration {
+namespace Service {
+
+/// HTTP front end of the worker pool.
+///   GET /generate?seed=<n>&rooms=<n>&type=<grid|center_doors|tree_fixed_doors|movable_doors>&format=<binary|svg>
+///       Blocks until the dungeon is generated. Binary format is the one of model/Serialization.h. Responds with 503 if
+///       the queue is full.
+///   GET /metrics
+///       Counters, queue depth, p50/p99 latencies and throughput of the queue and solver stages, one value per line.
+///       Also served by handleMonitoring, which is meant for a server of its own that generation requests can't block.
+class GenerationService {
+public:
+    /// `generator` must outlive the service
+    GenerationService(const DungeonGenerator& generator, size_t workerCount, size_t maxQueueSize);
+
+    HttpResponse handle(const HttpRequest& request);
+    /// Serves /metrics only
+    HttpResponse handleMonitoring(const HttpRequest& request) const;
+
+private:
+    HttpResponse handleGenerate(const HttpRequest& request);
+    HttpResponse handleMetrics() const;
+
+    WorkerPool workerPool_;
+    const size_t maxQueueSize_;
+
+    LatencyMetrics queueMetrics_;   // Waiting for a worker
+    LatencyMetrics solverMetrics_;  // Model generation and solving
+    LatencyMetrics totalMetrics_;   // Whole request
+    std::atomic<size_t> rejectedCount_ = 0;
+    std::atomic<size_t> failedCount_ = 0;
+};
+
+}  // namespace Service
+}  // namespace DungeonGeneration
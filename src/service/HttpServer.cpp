@@ -0,0 +1,331 @@
+#include "HttpServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace DungeonGeneration {
+namespace Service {
+
+namespace {
+
+constexpr int kListenBacklog = 64;
+
+const char* getReasonPhrase(int status)
+{
+    switch (status) {
+        case 200:
+            return "OK";
+        case 400:
+            return "Bad Request";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 408:
+            return "Request Timeout";
+        case 500:
+            return "Internal Server Error";
+        case 503:
+            return "Service Unavailable";
+        default:
+            return "Unknown";
+    }
+}
+
+int hexValue(char symbol)
+{
+    if (symbol >= '0' && symbol <= '9') {
+        return symbol - '0';
+    }
+    if (symbol >= 'a' && symbol <= 'f') {
+        return symbol - 'a' + 10;
+    }
+    if (symbol >= 'A' && symbol <= 'F') {
+        return symbol - 'A' + 10;
+    }
+    return -1;
+}
+
+/// Decodes %XX and '+'. Returns false on malformed escapes.
+bool decodeURLComponent(const std::string& encoded, std::string& decoded)
+{
+    decoded.clear();
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        if (encoded[i] == '+') {
+            decoded.push_back(' ');
+        } else if (encoded[i] == '%') {
+            if (i + 2 >= encoded.size() || hexValue(encoded[i + 1]) < 0 || hexValue(encoded[i + 2]) < 0) {
+                return false;
+            }
+            decoded.push_back(static_cast<char>(hexValue(encoded[i + 1]) * 16 + hexValue(encoded[i + 2])));
+            i += 2;
+        } else {
+            decoded.push_back(encoded[i]);
+        }
+    }
+    return true;
+}
+
+bool sendAll(int connection, const char* data, size_t size)
+{
+    while (size > 0) {
+        const ssize_t sent = send(connection, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+void sendResponse(int connection, const HttpResponse& response)
+{
+    std::ostringstream responseHead;
+    responseHead << "HTTP/1.1 " << response.status << " " << getReasonPhrase(response.status) << "\r\n"
+                 << "Content-Type: " << response.contentType << "\r\n"
+                 << "Content-Length: " << response.body.size() << "\r\n"
+                 << "Connection: close\r\n";
+    for (const auto& [name, value] : response.headers) {
+        responseHead << name << ": " << value << "\r\n";
+    }
+    responseHead << "\r\n";
+    const std::string headString = responseHead.str();
+    if (sendAll(connection, headString.data(), headString.size())) {
+        sendAll(connection, response.body.data(), response.body.size());
+    }
+}
+
+enum class ReceiveResult {
+    Received,
+    Closed,  // by the client, or the connection failed
+    TimedOut,
+};
+
+/// Waits for data until `deadline`, then receives what's available
+ReceiveResult receiveUntil(
+    int connection, std::chrono::steady_clock::time_point deadline, char* buffer, size_t size, size_t& received)
+{
+    while (true) {
+        const auto timeLeft =
+            std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (timeLeft.count() <= 0) {
+            return ReceiveResult::TimedOut;
+        }
+        pollfd pollFd{.fd = connection, .events = POLLIN, .revents = 0};
+        const int ready = poll(&pollFd, 1, static_cast<int>(timeLeft.count()));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0) {
+            return ReceiveResult::Closed;
+        }
+        if (ready == 0) {
+            return ReceiveResult::TimedOut;
+        }
+        const ssize_t count = recv(connection, buffer, size, 0);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return ReceiveResult::Closed;
+        }
+        received = static_cast<size_t>(count);
+        return ReceiveResult::Received;
+    }
+}
+
+}  // namespace
+
+HttpServer::HttpServer(uint16_t port, size_t threadCount, HttpHandler handler, std::chrono::milliseconds ioTimeout)
+      : threadCount_(threadCount),
+        handler_(std::move(handler)),
+        ioTimeout_(ioTimeout)
+{
+    socket_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_ < 0) {
+        throw std::runtime_error("HttpServer: failed to create a socket");
+    }
+    const int reuseAddress = 1;
+    setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);  // Local clients only
+    if (bind(socket_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(socket_, kListenBacklog) != 0) {
+        close(socket_);
+        throw std::runtime_error("HttpServer: failed to listen on port " + std::to_string(port));
+    }
+}
+
+HttpServer::~HttpServer()
+{
+    close(socket_);
+}
+
+uint16_t HttpServer::getPort() const
+{
+    sockaddr_in address{};
+    socklen_t addressSize = sizeof(address);
+    if (getsockname(socket_, reinterpret_cast<sockaddr*>(&address), &addressSize) != 0) {
+        return 0;
+    }
+    return ntohs(address.sin_port);
+}
+
+void HttpServer::stop()
+{
+    isStopped_ = true;
+    // Wakes up the threads blocked in accept
+    shutdown(socket_, SHUT_RDWR);
+}
+
+void HttpServer::run()
+{
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount_);
+    for (size_t threadId = 0; threadId < threadCount_; ++threadId) {
+        threads.emplace_back(&HttpServer::serveConnections, this);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+bool HttpServer::parseRequestHead(const std::string& head, HttpRequest& request)
+{
+    if (head.size() > kMaxRequestHeadSize) {
+        return false;
+    }
+    // Request line: METHOD target HTTP/x.y
+    std::istringstream requestLine(head.substr(0, head.find("\r\n")));
+    std::string target;
+    std::string version;
+    if (!(requestLine >> request.method >> target >> version) || version.rfind("HTTP/", 0) != 0 || target.empty() ||
+        target[0] != '/') {
+        return false;
+    }
+
+    const size_t queryBegin = target.find('?');
+    if (!decodeURLComponent(target.substr(0, queryBegin), request.path)) {
+        return false;
+    }
+    request.query.clear();
+    if (queryBegin == std::string::npos) {
+        return true;
+    }
+    std::istringstream query(target.substr(queryBegin + 1));
+    std::string parameter;
+    while (std::getline(query, parameter, '&')) {
+        if (parameter.empty()) {
+            continue;
+        }
+        const size_t separator = parameter.find('=');
+        std::string name;
+        std::string value;
+        if (!decodeURLComponent(parameter.substr(0, separator), name) ||
+            (separator != std::string::npos && !decodeURLComponent(parameter.substr(separator + 1), value))) {
+            return false;
+        }
+        request.query[name] = value;
+    }
+    return true;
+}
+
+std::optional<uint16_t> HttpServer::parsePort(const std::string& argument)
+{
+    if (argument.empty() || argument.size() > 5 ||
+        !std::all_of(argument.begin(), argument.end(), [](char c) { return std::isdigit(c) != 0; })) {
+        return std::nullopt;
+    }
+    const unsigned long port = std::stoul(argument);
+    if (port == 0 || port > std::numeric_limits<uint16_t>::max()) {
+        return std::nullopt;
+    }
+    return static_cast<uint16_t>(port);
+}
+
+void HttpServer::serveConnections()
+{
+    while (true) {
+        const int connection = accept(socket_, nullptr, nullptr);
+        if (isStopped_) {
+            if (connection >= 0) {
+                close(connection);
+            }
+            return;
+        }
+        if (connection < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            std::cerr << "(!) HttpServer::serveConnections: accept failed: " << std::strerror(errno) << "\n";
+            return;
+        }
+        serveConnection(connection);
+        close(connection);
+    }
+}
+
+void HttpServer::serveConnection(int connection)
+{
+    // Sending blocks at most for the timeout, then sendAll fails
+    timeval sendTimeout{};
+    sendTimeout.tv_sec = ioTimeout_.count() / 1000;
+    sendTimeout.tv_usec = (ioTimeout_.count() % 1000) * 1000;
+    setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout));
+
+    // Only the head is needed: requests are expected to have no body. Oversized heads are rejected by the parser.
+    // The whole head must arrive before the deadline, so a client can't hold the thread by sending it byte by byte.
+    const auto deadline = std::chrono::steady_clock::now() + ioTimeout_;
+    std::string head;
+    char buffer[1024];
+    while (head.find("\r\n\r\n") == std::string::npos && head.size() <= kMaxRequestHeadSize) {
+        size_t received = 0;
+        const ReceiveResult result = receiveUntil(connection, deadline, buffer, sizeof(buffer), received);
+        if (result == ReceiveResult::TimedOut) {
+            sendResponse(connection, HttpResponse{.status = 408, .body = "Request timeout\n"});
+            return;
+        }
+        if (result == ReceiveResult::Closed) {
+            return;
+        }
+        head.append(buffer, received);
+    }
+
+    HttpRequest request;
+    HttpResponse response;
+    if (!parseRequestHead(head, request)) {
+        response = HttpResponse{.status = 400, .body = "Malformed request\n"};
+    } else {
+        try {
+            response = handler_(request);
+        } catch (std::exception& error) {
+            std::cerr << "(!) HttpServer::serveConnection: handler failed: " << error.what() << "\n";
+            response = HttpResponse{.status = 500, .body = "Internal error\n"};
+        }
+    }
+    sendResponse(connection, response);
+}
+
+}  // namespace Service
+}  // namespace DungeonGeneration
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DungeonGeneration {
+namespace Service {
+
+struct HttpRequest {
+    std::string method;
+    std::string path;
+    std::unordered_map<std::string, std::string> query;  // Decoded parameters of the query string
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "text/plain";
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> headers;  // Extra headers
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+/// Minimal blocking HTTP/1.1 server for local use: listens on 127.0.0.1 only, serves one request per connection and
+/// ignores request bodies. Connections are handled by a fixed number of threads, the rest wait in the listen backlog.
+/// A client gets `ioTimeout` to send the request head (it's answered with 408 otherwise), and each send of the
+/// response gives up after the same time, so stalled clients don't hold the threads.
+class HttpServer {
+public:
+    static constexpr size_t kMaxRequestHeadSize = 8192;
+    static constexpr std::chrono::milliseconds kDefaultIOTimeout{10000};
+
+    /// Throws if the port can't be bound. Port 0 picks a free one, see getPort.
+    HttpServer(
+        uint16_t port, size_t threadCount, HttpHandler handler,
+        std::chrono::milliseconds ioTimeout = kDefaultIOTimeout);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /// Serve requests until stop() is called. `handler` is called concurrently from all threads.
+    void run();
+    /// Stop accepting connections: run() returns once the connections being served are finished
+    void stop();
+
+    uint16_t getPort() const;
+
+    /// Parses the request line of `head`, decoding the path and the query parameters. Returns false for malformed
+    /// requests and for heads longer than kMaxRequestHeadSize.
+    static bool parseRequestHead(const std::string& head, HttpRequest& request);
+    /// Port number from a command line argument, nothing unless it's a number in [1, 65535]
+    static std::optional<uint16_t> parsePort(const std::string& argument);
+
+private:
+    void serveConnections();
+    void serveConnection(int connection);
+
+    int socket_ = -1;
+    size_t threadCount_;
+    HttpHandler handler_;
+    std::chrono::milliseconds ioTimeout_;
+    std::atomic<bool> isStopped_ = false;
+};
+
+}  // namespace Service
+}  // namespace DungeonGeneration
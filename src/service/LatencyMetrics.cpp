@@ -0,0 +1,62 @@
+#include "LatencyMetrics.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace DungeonGeneration {
+namespace Service {
+
+namespace {
+
+/// Nearest-rank percentile, `samples` are reordered
+double getPercentile(std::vector<double>& samples, double percentile)
+{
+    assert(!samples.empty() && "No samples");
+    const size_t rank = static_cast<size_t>(std::ceil(percentile * samples.size()));
+    const size_t index = std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+}  // namespace
+
+LatencyMetrics::LatencyMetrics(size_t windowSize)
+      : windowSize_(windowSize),
+        creationTimestamp_(Clock::now())
+{
+    assert(windowSize > 0 && "Empty window");
+    window_.reserve(windowSize);
+}
+
+void LatencyMetrics::record(double seconds)
+{
+    std::lock_guard lock(mutex_);
+    if (window_.size() < windowSize_) {
+        window_.push_back(seconds);
+    } else {
+        window_[count_ % windowSize_] = seconds;
+    }
+    count_++;
+}
+
+LatencySummary LatencyMetrics::summarize() const
+{
+    std::vector<double> samples;
+    LatencySummary summary;
+    {
+        std::lock_guard lock(mutex_);
+        samples = window_;
+        summary.count = count_;
+    }
+    const double elapsedSeconds = std::chrono::duration<double>(Clock::now() - creationTimestamp_).count();
+    summary.throughput = (elapsedSeconds > 0 ? summary.count / elapsedSeconds : 0.0);
+    if (!samples.empty()) {
+        summary.p50Seconds = getPercentile(samples, 0.5);
+        summary.p99Seconds = getPercentile(samples, 0.99);
+    }
+    return summary;
+}
+
+}  // namespace Service
+}  // namespace DungeonGeneration
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace DungeonGeneration {
+namespace Service {
+
+struct LatencySummary {
+    size_t count = 0;          // All recorded samples
+    double p50Seconds = 0.0;   // Percentiles of the recent samples
+    double p99Seconds = 0.0;
+    double throughput = 0.0;   // Samples per second since creation
+};
+
+/// Latencies of a single stage. Percentiles are computed over the last `windowSize` samples. Thread-safe.
+class LatencyMetrics {
+public:
+    explicit LatencyMetrics(size_t windowSize = kDefaultWindowSize);
+
+    void record(double seconds);
+    LatencySummary summarize() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kDefaultWindowSize = 4096;
+
+    const size_t windowSize_;
+    const Clock::time_point creationTimestamp_;
+    mutable std::mutex mutex_;
+    std::vector<double> window_;  // Ring buffer
+    size_t count_ = 0;
+};
+
+}  // namespace Service
+}  // namespace DungeonGeneration
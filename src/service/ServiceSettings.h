@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace DungeonGeneration {
+namespace Service {
+
+constexpr uint16_t kDefaultPort = 8080;
+// /metrics is also served on its own port by a separate thread, so it answers however busy the main port is
+constexpr uint16_t kDefaultMetricsPort = 8081;
+
+// Only used if PETSc is thread-safe (see AnalyticalSolver::isPETScThreadSafe), otherwise there is a single worker:
+// solvers wouldn't run concurrently anyway
+constexpr size_t kSolverWorkerCount = 4;
+// Generation requests beyond this many waiting ones are rejected with 503
+constexpr size_t kMaxQueueSize = 8;
+// Connections served at once, the rest wait in the listen backlog. Each generation request holds its thread until
+// it's done, so there must be threads left over the running and queued requests to answer 503 and other requests.
+constexpr size_t kConnectionThreadCount = 16;
+static_assert(
+    kConnectionThreadCount > kSolverWorkerCount + kMaxQueueSize,
+    "Connection threads must outnumber running and queued requests, otherwise the queue is never full");
+// Clients that don't send the request head in time get 408, sending a response to a client that doesn't read it
+// fails after the same time
+constexpr std::chrono::milliseconds kConnectionTimeout{10000};
+
+constexpr size_t kMaxRoomCount = 300;       // Solving time grows quadratically with room count
+constexpr size_t kWorkspaceRoomCount = 100;  // Solver buffers of workers are allocated up front for this many rooms
+
+}  // namespace Service
+}  // namespace DungeonGeneration
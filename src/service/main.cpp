@@ -0,0 +1,55 @@
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <DungeonGenerator.h>
+
+#include "GenerationService.h"
+#include "HttpServer.h"
+#include "ServiceSettings.h"
+
+using namespace DungeonGeneration;
+
+/// Local generation daemon: `dungeon_generation_service [port [metrics port]]`. See GenerationService for the
+/// endpoints, /metrics is served on both ports.
+int main(int argc, char** argv)
+{
+    const std::optional<uint16_t> port =
+        (argc > 1 ? Service::HttpServer::parsePort(argv[1]) : Service::kDefaultPort);
+    const std::optional<uint16_t> metricsPort =
+        (argc > 2 ? Service::HttpServer::parsePort(argv[2]) : Service::kDefaultMetricsPort);
+    if (!port.has_value() || !metricsPort.has_value()) {
+        std::cerr << "Usage: " << argv[0] << " [port [metrics port]]\n"
+                  << "Ports must be numbers in [1, 65535], defaults are " << Service::kDefaultPort << " and "
+                  << Service::kDefaultMetricsPort << "\n";
+        return 1;
+    }
+
+    // Initializes PETSc with command line options, the generator reuses this initialization
+    AnalyticalSolver::PETScScope petscScope(argc, argv);
+    size_t workerCount = Service::kSolverWorkerCount;
+    if (!AnalyticalSolver::isPETScThreadSafe()) {
+        std::cerr << "(!) GenerationService: PETSc is built without --with-threadsafety, solvers run on a single "
+                     "worker\n";
+        workerCount = 1;
+    }
+
+    // Nothing is written to disk: results are only returned to clients
+    const DungeonGenerator dungeonGenerator;
+    Service::GenerationService service(dungeonGenerator, workerCount, Service::kMaxQueueSize);
+    Service::HttpServer server(
+        port.value(), Service::kConnectionThreadCount,
+        [&service](const Service::HttpRequest& request) { return service.handle(request); },
+        Service::kConnectionTimeout);
+    Service::HttpServer metricsServer(
+        metricsPort.value(), 1,
+        [&service](const Service::HttpRequest& request) { return service.handleMonitoring(request); },
+        Service::kConnectionTimeout);
+    std::cerr << "GenerationService: listening on 127.0.0.1:" << port.value() << ", metrics on 127.0.0.1:"
+              << metricsPort.value() << "\n";
+    std::thread metricsThread(&Service::HttpServer::run, &metricsServer);
+    server.run();
+    metricsThread.join();
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <DungeonGenerator.h>
+#include <service/GenerationService.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+Service::HttpRequest makeGenerateRequest(size_t seed)
+{
+    return Service::HttpRequest{
+        .method = "GET", .path = "/generate", .query = {{"seed", std::to_string(seed)}, {"rooms", "100"}}};
+}
+
+}  // namespace
+
+TEST(GenerationServiceTests, TestFullQueueIsRejected)
+{
+    const DungeonGenerator generator;
+    // One request is being solved, one waits, the next one doesn't fit
+    Service::GenerationService service(generator, 1, 1);
+    std::vector<int> statuses(2, 0);
+    std::vector<std::thread> clients;
+    for (size_t clientId = 0; clientId < statuses.size(); ++clientId) {
+        clients.emplace_back([&service, &statuses, clientId]() {
+            statuses[clientId] = service.handle(makeGenerateRequest(clientId)).status;
+        });
+    }
+
+    // A 100 rooms dungeon takes much longer to solve than both requests take to be queued
+    const Service::HttpRequest metricsRequest{.method = "GET", .path = "/metrics"};
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (service.handleMonitoring(metricsRequest).body.find("queue_depth 1\n") == std::string::npos) {
+        ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "The queue wasn't filled";
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const Service::HttpResponse rejected = service.handle(makeGenerateRequest(statuses.size()));
+    EXPECT_EQ(rejected.status, 503);
+    ASSERT_EQ(rejected.headers.size(), 1u);
+    EXPECT_EQ(rejected.headers[0].first, "Retry-After");
+    EXPECT_NE(service.handleMonitoring(metricsRequest).body.find("rejected_count 1\n"), std::string::npos);
+
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    EXPECT_EQ(statuses, std::vector<int>(2, 200));
+}
+
+TEST(GenerationServiceTests, TestMonitoringServesOnlyMetrics)
+{
+    const DungeonGenerator generator;
+    Service::GenerationService service(generator, 1, 1);
+    EXPECT_EQ(service.handleMonitoring(Service::HttpRequest{.method = "GET", .path = "/metrics"}).status, 200);
+    EXPECT_EQ(service.handleMonitoring(makeGenerateRequest(0)).status, 404);
+}
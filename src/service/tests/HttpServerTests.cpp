@@ -0,0 +1,127 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include <service/HttpServer.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+/// Sends `request` (possibly an incomplete one) to a local server and returns everything it answers
+std::string exchange(uint16_t port, const std::string& request)
+{
+    const int connection = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(connection);
+        return "";
+    }
+    send(connection, request.data(), request.size(), MSG_NOSIGNAL);
+    std::string response;
+    char buffer[1024];
+    ssize_t received;
+    while ((received = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(received));
+    }
+    close(connection);
+    return response;
+}
+
+}  // namespace
+
+TEST(HttpServerTests, TestParseRequest)
+{
+    Service::HttpRequest request;
+    ASSERT_TRUE(Service::HttpServer::parseRequestHead(
+        "GET /generate?seed=42&type=movable%5fdoors&name=a+b%21&flag&&rooms= HTTP/1.1\r\nHost: localhost\r\n\r\n",
+        request));
+    EXPECT_EQ(request.method, "GET");
+    EXPECT_EQ(request.path, "/generate");
+    EXPECT_EQ(request.query.size(), 5u);
+    EXPECT_EQ(request.query["seed"], "42");
+    EXPECT_EQ(request.query["type"], "movable_doors");
+    EXPECT_EQ(request.query["name"], "a b!");
+    EXPECT_EQ(request.query["flag"], "");
+    EXPECT_EQ(request.query["rooms"], "");
+
+    // Path is decoded too, parameters of a previous request don't survive
+    ASSERT_TRUE(Service::HttpServer::parseRequestHead("POST /some%20path HTTP/1.0\r\n\r\n", request));
+    EXPECT_EQ(request.method, "POST");
+    EXPECT_EQ(request.path, "/some path");
+    EXPECT_TRUE(request.query.empty());
+}
+
+TEST(HttpServerTests, TestMalformedRequestLine)
+{
+    Service::HttpRequest request;
+    for (const std::string head : {
+             "",
+             "\r\n\r\n",
+             "GET\r\n\r\n",
+             "GET /metrics\r\n\r\n",
+             "GET metrics HTTP/1.1\r\n\r\n",
+             "GET /metrics FTP/1.1\r\n\r\n",
+             "GET /met%2 HTTP/1.1\r\n\r\n",
+             "GET /generate?seed=%zz HTTP/1.1\r\n\r\n",
+             "GET /generate?se%4=1 HTTP/1.1\r\n\r\n",
+             "GET /generate?seed=1% HTTP/1.1\r\n\r\n",
+         }) {
+        EXPECT_FALSE(Service::HttpServer::parseRequestHead(head, request)) << head;
+    }
+}
+
+TEST(HttpServerTests, TestOversizedHead)
+{
+    const std::string requestLine = "GET /metrics HTTP/1.1\r\n";
+    const std::string headerName = "X-Padding: ";
+    const std::string end = "\r\n\r\n";
+    const size_t paddingSize =
+        Service::HttpServer::kMaxRequestHeadSize - requestLine.size() - headerName.size() - end.size();
+
+    Service::HttpRequest request;
+    const std::string head = requestLine + headerName + std::string(paddingSize, 'a') + end;
+    EXPECT_TRUE(Service::HttpServer::parseRequestHead(head, request));
+    const std::string oversizedHead = requestLine + headerName + std::string(paddingSize + 1, 'a') + end;
+    EXPECT_FALSE(Service::HttpServer::parseRequestHead(oversizedHead, request));
+}
+
+TEST(HttpServerTests, TestParsePort)
+{
+    EXPECT_EQ(Service::HttpServer::parsePort("8080"), 8080);
+    EXPECT_EQ(Service::HttpServer::parsePort("1"), 1);
+    EXPECT_EQ(Service::HttpServer::parsePort("65535"), 65535);
+    for (const std::string argument : {"", "0", "65536", "99999999999999999999", "-1", "+80", " 80", "80x", "port"}) {
+        EXPECT_FALSE(Service::HttpServer::parsePort(argument).has_value()) << argument;
+    }
+}
+
+TEST(HttpServerTests, TestRequestTimeout)
+{
+    using namespace std::chrono_literals;
+    Service::HttpServer server(
+        0, 2, [](const Service::HttpRequest&) { return Service::HttpResponse{.body = "ok"}; }, 200ms);
+    const uint16_t port = server.getPort();
+    ASSERT_NE(port, 0);
+    std::thread serverThread(&Service::HttpServer::run, &server);
+
+    EXPECT_EQ(exchange(port, "GET / HTTP/1.1\r\n\r\n").rfind("HTTP/1.1 200 OK\r\n", 0), 0u);
+    // Head is never finished, or never started
+    const auto begin = std::chrono::steady_clock::now();
+    EXPECT_EQ(exchange(port, "GET / HTTP/1.1\r\n").rfind("HTTP/1.1 408 Request Timeout\r\n", 0), 0u);
+    EXPECT_EQ(exchange(port, "").rfind("HTTP/1.1 408 Request Timeout\r\n", 0), 0u);
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, 5s);
+
+    server.stop();
+    serverThread.join();
+}
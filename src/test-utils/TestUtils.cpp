@@ -0,0 +1,182 @@
+#include "TestUtils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <utils/GridIndex.h>
+
+namespace DungeonGeneration {
+namespace TestUtils {
+
+namespace {
+
+constexpr double kMinRoomSide = 5.0;
+constexpr double kMaxRoomSide = 30.0;
+constexpr double kMaxFixedDoorShift = 10.0;
+constexpr double kGridStep = 40.0;
+constexpr double kGridJitter = 3.0;
+
+}  // namespace
+
+double secondsSince(Clock::time_point begin)
+{
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+Model::Model createRandomModel(size_t roomCount, Connectivity connectivity, DoorKinds doorKinds, Random::RNG& rng)
+{
+    assert(roomCount >= 2 && "TestUtils::createRandomModel: corridors need two rooms");
+    Model::Rooms rooms;
+    rooms.reserve(roomCount);
+    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
+        rooms.emplace_back(
+            roomId, Random::uniformRangeContinuous(kMinRoomSide, kMaxRoomSide, rng),
+            Random::uniformRangeContinuous(kMinRoomSide, kMaxRoomSide, rng));
+    }
+
+    Model::Doors doors;
+    Model::Corridors corridors;
+    size_t nextObjectId = roomCount;
+    auto addDoor = [&](size_t roomId, bool isMovable) {
+        if (isMovable) {
+            doors.push_back(Model::Door::createMovableDoor(roomId, nextObjectId++));
+        } else {
+            doors.push_back(Model::Door::createFixedDoor(
+                roomId, Model::Position{
+                            .x = Random::uniformRangeContinuous(-kMaxFixedDoorShift, kMaxFixedDoorShift, rng),
+                            .y = Random::uniformRangeContinuous(-kMaxFixedDoorShift, kMaxFixedDoorShift, rng)}));
+        }
+        return doors.size() - 1;
+    };
+    auto addCorridor = [&](size_t roomId1, size_t roomId2) {
+        const size_t corridorId = corridors.size();
+        const bool isMovable1 = (doorKinds == DoorKinds::Movable || corridorId % 2 == 0);
+        const bool isMovable2 = (doorKinds == DoorKinds::Movable || corridorId % 4 < 2);
+        const size_t doorId1 = addDoor(roomId1, isMovable1);
+        const size_t doorId2 = addDoor(roomId2, isMovable2);
+        corridors.push_back(Model::Corridor{.door1Id = doorId1, .door2Id = doorId2});
+    };
+    switch (connectivity) {
+        case Connectivity::Chain:
+            for (size_t roomId = 1; roomId < roomCount; ++roomId) {
+                addCorridor(roomId - 1, roomId);
+            }
+            break;
+        case Connectivity::RandomTree:
+            for (size_t roomId = 1; roomId < roomCount; ++roomId) {
+                addCorridor(Random::uniformDiscrete(roomId - 1, rng), roomId);
+            }
+            break;
+        case Connectivity::RandomPairs:
+            for (size_t corridorId = 0; corridorId < roomCount; ++corridorId) {
+                const size_t roomId1 = Random::uniformDiscrete(roomCount - 1, rng);
+                const size_t roomId2 = (roomId1 + 1 + Random::uniformDiscrete(roomCount - 2, rng)) % roomCount;
+                addCorridor(roomId1, roomId2);
+            }
+            break;
+    }
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+std::vector<double> createRandomVariables(
+    const Model::Model& model, double roomRange, double doorRange, Random::RNG& rng)
+{
+    // Room variables go first
+    const size_t roomVariablesCount = 2 * model.rooms().size();
+    std::vector<double> x(model.getVariablesCount());
+    for (size_t varId = 0; varId < x.size(); ++varId) {
+        const double range = (varId < roomVariablesCount ? roomRange : doorRange);
+        x[varId] = Random::uniformRangeContinuous(-range, range, rng);
+    }
+    return x;
+}
+
+Model::Model createGridLayout(size_t roomCount, bool longCorridors)
+{
+    Random::RNG rng(Random::kGlobalSeed);
+    const size_t gridSide = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(roomCount))));
+    Model::Rooms rooms;
+    Model::Doors doors;
+    Model::Corridors corridors;
+    rooms.reserve(roomCount);
+    doors.reserve(3 * roomCount);
+    for (size_t roomId = 0; roomId < roomCount; ++roomId) {
+        const double width = Random::uniformRangeContinuous(kMinRoomSide, kMaxRoomSide, rng);
+        const double height = Random::uniformRangeContinuous(kMinRoomSide, kMaxRoomSide, rng);
+        const Model::Position center{
+            .x = (roomId % gridSide) * kGridStep + Random::uniformRangeContinuous(-kGridJitter, kGridJitter, rng),
+            .y = (roomId / gridSide) * kGridStep + Random::uniformRangeContinuous(-kGridJitter, kGridJitter, rng)};
+        rooms.emplace_back(roomId, width, height, center);
+        // Doors of room i are 3i (left), 3i + 1 (right) and 3i + 2 (bottom)
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = -width / 2, .y = 0.0}));
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = width / 2, .y = 0.0}));
+        doors.push_back(Model::Door::createFixedDoor(roomId, Model::Position{.x = 0.0, .y = -height / 2}));
+        if (roomId % gridSide != 0) {
+            corridors.push_back(Model::Corridor{.door1Id = 3 * roomId - 2, .door2Id = 3 * roomId});
+        }
+        if (longCorridors && roomId >= 3 * gridSide) {
+            const size_t otherRoomId = roomId - Random::uniformRangeDiscrete<size_t>(2, 3, rng) * gridSide +
+                                       Random::uniformRangeDiscrete<size_t>(0, 2, rng);
+            corridors.push_back(Model::Corridor{.door1Id = 3 * roomId + 2, .door2Id = 3 * otherRoomId + 1});
+        }
+    }
+    return Model::Model(std::move(rooms), std::move(doors), std::move(corridors));
+}
+
+size_t countInvalidRoutes(const Model::Model& model, const Model::CorridorRoutes& routes)
+{
+    assert(routes.size() == model.corridors().size() && "countInvalidRoutes: routes don't match corridors");
+    std::vector<Spatial::Box> roomBoxes;
+    roomBoxes.reserve(model.rooms().size());
+    double sideSum = 0.0;
+    for (const Model::Room& room : model.rooms()) {
+        const Model::Position lbPos = room.getLBPosition();
+        roomBoxes.push_back(Spatial::Box{lbPos.x, lbPos.y, lbPos.x + room.width(), lbPos.y + room.height()});
+        sideSum += (room.width() + room.height()) / 2;
+    }
+    Spatial::Box bounds{0.0, 0.0, 0.0, 0.0};
+    if (!roomBoxes.empty()) {
+        bounds = roomBoxes.front();
+        for (const Spatial::Box& box : roomBoxes) {
+            bounds = Spatial::Box{
+                std::min(bounds.minX, box.minX), std::min(bounds.minY, box.minY), std::max(bounds.maxX, box.maxX),
+                std::max(bounds.maxY, box.maxY)};
+        }
+    }
+    Spatial::GridIndex roomIndex(bounds, roomBoxes.empty() ? 1.0 : sideSum / roomBoxes.size());
+    for (size_t roomId = 0; roomId < roomBoxes.size(); ++roomId) {
+        roomIndex.insert(roomId, roomBoxes[roomId]);
+    }
+
+    size_t invalidCount = 0;
+    std::vector<size_t> found;
+    for (size_t corridorId = 0; corridorId < routes.size(); ++corridorId) {
+        const Model::Corridor& corridor = model.corridors()[corridorId];
+        const Model::CorridorRoute& route = routes[corridorId];
+        const size_t roomId1 = model.doors()[corridor.door1Id].parentRoomId();
+        const size_t roomId2 = model.doors()[corridor.door2Id].parentRoomId();
+        bool isValid = true;
+        for (size_t pointId = 1; pointId < route.size() && isValid; ++pointId) {
+            const Model::Position& a = route[pointId - 1];
+            const Model::Position& b = route[pointId];
+            if (a.x != b.x && a.y != b.y) {
+                isValid = false;
+                break;
+            }
+            const Spatial::Box segmentBox{
+                std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)};
+            roomIndex.query(segmentBox, found);
+            isValid = std::none_of(found.begin(), found.end(), [&](size_t roomId) {
+                const Spatial::Box& box = roomBoxes[roomId];
+                return roomId != roomId1 && roomId != roomId2 && segmentBox.maxX > box.minX &&
+                       segmentBox.minX < box.maxX && segmentBox.maxY > box.minY && segmentBox.minY < box.maxY;
+            });
+        }
+        invalidCount += !isValid;
+    }
+    return invalidCount;
+}
+
+}  // namespace TestUtils
+}  // namespace DungeonGeneration
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <model/Corridor.h>
+#include <model/Model.h>
+#include <utils/Random.h>
+
+namespace DungeonGeneration {
+/// Models and helpers shared by tests and benchmarks
+namespace TestUtils {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point begin);
+
+enum class Connectivity {
+    Chain,        // Room i is connected to room i - 1
+    RandomTree,   // Room i is connected to a random room before it
+    RandomPairs,  // As many corridors as rooms, between random rooms
+};
+
+enum class DoorKinds {
+    Movable,
+    Mixed,  // Every combination of movable and fixed doors at the two ends of a corridor, fixed doors are shifted
+            // randomly by up to 10 units
+};
+
+/// Rooms of random sizes in [5, 30] without positions, each corridor has its own pair of doors
+Model::Model createRandomModel(size_t roomCount, Connectivity connectivity, DoorKinds doorKinds, Random::RNG& rng);
+/// Random variables of `model`: room centers in [-roomRange, roomRange], door shifts in [-doorRange, doorRange]
+std::vector<double> createRandomVariables(
+    const Model::Model& model, double roomRange, double doorRange, Random::RNG& rng);
+
+/// Layout shaped like a solved one: rooms on a jittered grid with a step of 40, so that they don't overlap. Each room
+/// has fixed doors on its left, right and bottom sides and is connected to its left neighbour. With `longCorridors`,
+/// the bottom door is also connected to a random room a few rows below, so that routes have to go around rooms.
+Model::Model createGridLayout(size_t roomCount, bool longCorridors);
+
+/// Number of non-empty routes that have a segment which isn't axis-aligned or enters a room other than the rooms of
+/// its corridor. Touching room borders is allowed. Routes are indexed like the model's corridors.
+size_t countInvalidRoutes(const Model::Model& model, const Model::CorridorRoutes& routes);
+
+}  // namespace TestUtils
+}  // namespace DungeonGeneration
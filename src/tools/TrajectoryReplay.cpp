@@ -0,0 +1,75 @@
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <callbacks/Trajectory.h>
+
+using namespace DungeonGeneration;
+
+namespace {
+
+void printUsage()
+{
+    std::cerr << "Usage: trajectory_replay <trajectory file> [<output directory> all | <frame id>...]\n"
+                 "Without an output directory, lists the recorded frames.\n";
+}
+
+}  // namespace
+
+/// Regenerates SVG frames from a solver trajectory file written by TrajectoryRecorder
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    const std::filesystem::path trajectoryPath = argv[1];
+    const std::optional<Callbacks::TrajectoryReader> reader = Callbacks::TrajectoryReader::open(trajectoryPath);
+    if (!reader.has_value()) {
+        return 1;
+    }
+    const std::vector<Callbacks::Trajectory::FrameInfo>& frames = reader->getFrames();
+
+    if (argc < 4) {
+        std::cout << frames.size() << " frames, " << reader->getModel().rooms().size() << " rooms\n";
+        for (size_t frameId = 0; frameId < frames.size(); ++frameId) {
+            std::cout << frameId << ": run " << frames[frameId].runNum << ", iteration " << frames[frameId].iterNum
+                      << "\n";
+        }
+        return 0;
+    }
+
+    const std::filesystem::path outputDirectory = argv[2];
+    std::vector<size_t> frameIds;
+    if (std::string(argv[3]) == "all") {
+        for (size_t frameId = 0; frameId < frames.size(); ++frameId) {
+            frameIds.push_back(frameId);
+        }
+    } else {
+        for (int argId = 3; argId < argc; ++argId) {
+            const size_t frameId = std::stoul(argv[argId]);
+            if (frameId >= frames.size()) {
+                std::cerr << "(!) trajectory_replay: there is no frame " << frameId << "\n";
+                return 1;
+            }
+            frameIds.push_back(frameId);
+        }
+    }
+
+    std::filesystem::create_directories(outputDirectory);
+    Model::Model model = reader->getModel();
+    const std::string prefix = trajectoryPath.stem().string();
+    for (const size_t frameId : frameIds) {
+        const std::optional<std::vector<double>> x = reader->getFrameVariables(frameId);
+        if (!x.has_value()) {
+            return 1;
+        }
+        model.setPositionsFromVars(x->data());
+        const std::string filename = prefix + "_" + std::to_string(frames[frameId].runNum) + "_" +
+                                     std::to_string(frames[frameId].iterNum) + ".svg";
+        model.dumpToSVG(outputDirectory / filename);
+    }
+    std::cout << frameIds.size() << " frames written to " << outputDirectory << "\n";
+    return 0;
+}
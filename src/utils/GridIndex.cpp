@@ -0,0 +1,111 @@
+#include "GridIndex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace DungeonGeneration {
+namespace Spatial {
+
+GridIndex::GridIndex(const Box& bounds, double cellSize, size_t maxCellCount)
+      : bounds_(bounds),
+        cellSize_(cellSize)
+{
+    assert(bounds.minX <= bounds.maxX && bounds.minY <= bounds.maxY && "Invalid bounds");
+    assert(cellSize > 0 && maxCellCount > 0 && "Invalid grid parameters");
+    const double width = bounds.maxX - bounds.minX;
+    const double height = bounds.maxY - bounds.minY;
+    if (width * height / (cellSize_ * cellSize_) > static_cast<double>(maxCellCount)) {
+        cellSize_ = std::sqrt(width * height / static_cast<double>(maxCellCount));
+    }
+    cellsX_ = std::max<size_t>(1, static_cast<size_t>(std::ceil(width / cellSize_)));
+    cellsY_ = std::max<size_t>(1, static_cast<size_t>(std::ceil(height / cellSize_)));
+    cells_.resize(cellsX_ * cellsY_);
+}
+
+void GridIndex::insert(size_t itemId, const Box& box)
+{
+    const uint32_t itemIndex = static_cast<uint32_t>(items_.size());
+    items_.push_back(Item{.id = itemId, .box = box});
+    size_t cellX1, cellY1, cellX2, cellY2;
+    getCellRange(box, cellX1, cellY1, cellX2, cellY2);
+    for (size_t cellY = cellY1; cellY <= cellY2; ++cellY) {
+        for (size_t cellX = cellX1; cellX <= cellX2; ++cellX) {
+            cells_[cellY * cellsX_ + cellX].push_back(itemIndex);
+        }
+    }
+}
+
+void GridIndex::query(const Box& box, std::vector<size_t>& result) const
+{
+    result.clear();
+    size_t cellX1, cellY1, cellX2, cellY2;
+    getCellRange(box, cellX1, cellY1, cellX2, cellY2);
+    for (size_t cellY = cellY1; cellY <= cellY2; ++cellY) {
+        for (size_t cellX = cellX1; cellX <= cellX2; ++cellX) {
+            for (const uint32_t itemIndex : cells_[cellY * cellsX_ + cellX]) {
+                if (items_[itemIndex].box.intersects(box)) {
+                    result.push_back(itemIndex);
+                }
+            }
+        }
+    }
+    // Items spanning several cells are found several times
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    for (size_t& itemIndex : result) {
+        itemIndex = items_[itemIndex].id;
+    }
+    std::sort(result.begin(), result.end());
+}
+
+void GridIndex::queryPairs(std::vector<std::pair<size_t, size_t>>& result) const
+{
+    result.clear();
+    for (size_t cellY = 0; cellY < cellsY_; ++cellY) {
+        for (size_t cellX = 0; cellX < cellsX_; ++cellX) {
+            const std::vector<uint32_t>& cell = cells_[cellY * cellsX_ + cellX];
+            for (size_t i = 0; i < cell.size(); ++i) {
+                const Item& item1 = items_[cell[i]];
+                for (size_t j = i + 1; j < cell.size(); ++j) {
+                    const Item& item2 = items_[cell[j]];
+                    if (!item1.box.intersects(item2.box)) {
+                        continue;
+                    }
+                    // Boxes spanning several cells share all of them. The pair is reported only by the cell with the
+                    // lower left corner of the intersection, so that no deduplication is needed.
+                    const Box corner{
+                        .minX = std::max(item1.box.minX, item2.box.minX),
+                        .minY = std::max(item1.box.minY, item2.box.minY),
+                        .maxX = std::max(item1.box.minX, item2.box.minX),
+                        .maxY = std::max(item1.box.minY, item2.box.minY)};
+                    size_t cornerX1, cornerY1, cornerX2, cornerY2;
+                    getCellRange(corner, cornerX1, cornerY1, cornerX2, cornerY2);
+                    if (cornerX1 == cellX && cornerY1 == cellY) {
+                        result.emplace_back(std::min(item1.id, item2.id), std::max(item1.id, item2.id));
+                    }
+                }
+            }
+        }
+    }
+}
+
+size_t GridIndex::getItemCount() const
+{
+    return items_.size();
+}
+
+void GridIndex::getCellRange(const Box& box, size_t& cellX1, size_t& cellY1, size_t& cellX2, size_t& cellY2) const
+{
+    auto toCell = [this](double coordinate, double origin, size_t cellCount) {
+        const double cell = std::floor((coordinate - origin) / cellSize_);
+        return static_cast<size_t>(std::clamp(cell, 0.0, static_cast<double>(cellCount - 1)));
+    };
+    cellX1 = toCell(box.minX, bounds_.minX, cellsX_);
+    cellX2 = toCell(box.maxX, bounds_.minX, cellsX_);
+    cellY1 = toCell(box.minY, bounds_.minY, cellsY_);
+    cellY2 = toCell(box.maxY, bounds_.minY, cellsY_);
+}
+
+}  // namespace Spatial
+}  // namespace DungeonGeneration
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace DungeonGeneration {
+namespace Spatial {
+
+/// Axis-aligned box, bounds are inclusive
+struct Box {
+    double minX;
+    double minY;
+    double maxX;
+    double maxY;
+
+    bool intersects(const Box& other) const
+    {
+        return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+    }
+};
+
+/// Uniform grid over a fixed area for box queries. Each item is stored in every cell its box touches, boxes outside of
+/// the area are clamped to the border cells. Built once, then queried concurrently.
+class GridIndex {
+public:
+    /// The number of cells is capped at `maxCellCount` by growing `cellSize`
+    GridIndex(const Box& bounds, double cellSize, size_t maxCellCount = kDefaultMaxCellCount);
+
+    /// Ids don't have to be contiguous
+    void insert(size_t itemId, const Box& box);
+    /// Ids of items whose boxes intersect `box`, each once, in ascending order. `result` is overwritten.
+    void query(const Box& box, std::vector<size_t>& result) const;
+    /// All pairs of items with intersecting boxes, each once with the smaller id first, in no particular order.
+    /// `result` is overwritten.
+    void queryPairs(std::vector<std::pair<size_t, size_t>>& result) const;
+
+    size_t getItemCount() const;
+
+private:
+    static constexpr size_t kDefaultMaxCellCount = size_t(1) << 22;
+
+    struct Item {
+        size_t id;
+        Box box;
+    };
+
+    /// Cell range touched by `box`, clamped to the grid
+    void getCellRange(const Box& box, size_t& cellX1, size_t& cellY1, size_t& cellX2, size_t& cellY2) const;
+
+    Box bounds_;
+    double cellSize_;
+    size_t cellsX_;
+    size_t cellsY_;
+    std::vector<std::vector<uint32_t>> cells_;  // Indexes into items_
+    std::vector<Item> items_;
+};
+
+}  // namespace Spatial
+}  // namespace DungeonGeneration
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace DungeonGeneration {
+namespace Hash {
+
+/// FNV-1a over a canonical byte sequence: values are widened to 64 bits and fed in little-endian order, so digests are
+/// the same on every platform.
+class Hasher {
+public:
+    /// Numbers and enums
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>>
+    Hasher& add(T value)
+    {
+        if constexpr (std::is_enum_v<T>) {
+            return add(static_cast<std::underlying_type_t<T>>(value));
+        } else if constexpr (std::is_floating_point_v<T>) {
+            const double valueDouble = value;
+            uint64_t bits;
+            std::memcpy(&bits, &valueDouble, sizeof(bits));
+            return addWord(bits);
+        } else {
+            return addWord(static_cast<uint64_t>(value));
+        }
+    }
+
+    Hasher& add(std::string_view string)
+    {
+        addWord(string.size());
+        for (char c : string) {
+            addByte(static_cast<uint8_t>(c));
+        }
+        return *this;
+    }
+
+    uint64_t digest() const
+    {
+        return state_;
+    }
+
+private:
+    static constexpr uint64_t kOffsetBasis = 0xCBF29CE484222325;
+    static constexpr uint64_t kPrime = 0x100000001B3;
+
+    Hasher& addWord(uint64_t word)
+    {
+        for (size_t byteId = 0; byteId < sizeof(word); ++byteId) {
+            addByte(static_cast<uint8_t>(word >> (8 * byteId)));
+        }
+        return *this;
+    }
+
+    void addByte(uint8_t byte)
+    {
+        state_ = (state_ ^ byte) * kPrime;
+    }
+
+    uint64_t state_ = kOffsetBasis;
+};
+
+}  // namespace Hash
+}  // namespace DungeonGeneration
@@ -0,0 +1,139 @@
+#include "Memory.h"
+
+namespace DungeonGeneration {
+namespace Memory {
+
+// ---------------------------------------------------------------------------------------------------------------------
+// ----- CountingResource -----
+
+CountingResource::CountingResource(std::pmr::memory_resource* upstream)
+      : upstream_(upstream)
+{}
+
+AllocationStats CountingResource::stats() const
+{
+    return stats_;
+}
+
+void* CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+    void* ptr = upstream_->allocate(bytes, alignment);
+    stats_.allocationCount++;
+    stats_.allocatedBytes += bytes;
+    return ptr;
+}
+
+void CountingResource::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    upstream_->deallocate(ptr, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// ----- BlockCache -----
+
+BlockCache::BlockCache(std::pmr::memory_resource* upstream, size_t capacity)
+      : upstream_(upstream),
+        capacity_(capacity)
+{}
+
+BlockCache::~BlockCache()
+{
+    release();
+}
+
+void BlockCache::release()
+{
+    trim(0);
+}
+
+void BlockCache::trim(size_t bytes)
+{
+    std::lock_guard lock(mutex_);
+    trimLocked(bytes);
+}
+
+size_t BlockCache::cachedBytes() const
+{
+    std::lock_guard lock(mutex_);
+    return cachedBytes_;
+}
+
+void BlockCache::trimLocked(size_t bytes)
+{
+    size_t releasedCount = 0;
+    while (releasedCount < freeBlocks_.size() && cachedBytes_ > bytes) {
+        const Block& block = freeBlocks_[releasedCount++];
+        upstream_->deallocate(block.ptr, block.bytes, block.alignment);
+        cachedBytes_ -= block.bytes;
+    }
+    freeBlocks_.erase(freeBlocks_.begin(), freeBlocks_.begin() + releasedCount);
+}
+
+void* BlockCache::do_allocate(size_t bytes, size_t alignment)
+{
+    {
+        std::lock_guard lock(mutex_);
+        for (size_t i = 0; i < freeBlocks_.size(); ++i) {
+            if (freeBlocks_[i].bytes == bytes && freeBlocks_[i].alignment == alignment) {
+                void* ptr = freeBlocks_[i].ptr;
+                freeBlocks_.erase(freeBlocks_.begin() + i);
+                cachedBytes_ -= bytes;
+                return ptr;
+            }
+        }
+    }
+    return upstream_->allocate(bytes, alignment);
+}
+
+void BlockCache::do_deallocate(void* ptr, size_t bytes, size_t alignment)
+{
+    std::lock_guard lock(mutex_);
+    if (bytes > capacity_) {
+        upstream_->deallocate(ptr, bytes, alignment);
+        return;
+    }
+    trimLocked(capacity_ - bytes);
+    freeBlocks_.push_back(Block{.ptr = ptr, .bytes = bytes, .alignment = alignment});
+    cachedBytes_ += bytes;
+}
+
+bool BlockCache::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// ----- Arena -----
+
+Arena::Arena(size_t initialSize)
+      : Arena(std::pmr::new_delete_resource(), initialSize)
+{}
+
+Arena::Arena(std::pmr::memory_resource* upstream, size_t initialSize)
+      : upstreamResource_(upstream),
+        arenaResource_(initialSize, &upstreamResource_),
+        requestsResource_(&arenaResource_)
+{}
+
+std::pmr::memory_resource* Arena::resource()
+{
+    return &requestsResource_;
+}
+
+AllocationStats Arena::requestedStats() const
+{
+    return requestsResource_.stats();
+}
+
+AllocationStats Arena::upstreamStats() const
+{
+    return upstreamResource_.stats();
+}
+
+}  // namespace Memory
+}  // namespace DungeonGeneration
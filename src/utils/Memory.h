@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace DungeonGeneration {
+namespace Memory {
+
+constexpr size_t kCacheLineSize = 64;
+
+struct AllocationStats {
+    size_t allocationCount = 0;
+    size_t allocatedBytes = 0;
+};
+
+/// Memory resource that forwards everything upstream and counts allocations. Not thread-safe.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+    AllocationStats stats() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    std::pmr::memory_resource* upstream_;
+    AllocationStats stats_;
+};
+
+/// Keeps deallocated blocks and hands them out again for requests of the same size and alignment, so that arenas of
+/// consecutive jobs reuse memory instead of going to the heap. Meant for a few large blocks: lookup is linear.
+/// At most `capacity` bytes are kept: the oldest blocks are returned upstream first, so a single large job doesn't pin
+/// its memory forever. The rest is released on destruction. Thread-safe.
+class BlockCache : public std::pmr::memory_resource {
+public:
+    static constexpr size_t kUnlimitedCapacity = static_cast<size_t>(-1);
+
+    explicit BlockCache(
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource(), size_t capacity = kUnlimitedCapacity);
+    ~BlockCache() override;
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    /// Return all cached blocks upstream. Blocks that are in use aren't affected.
+    void release();
+    /// Return the oldest cached blocks upstream until at most `bytes` are cached
+    void trim(size_t bytes);
+    /// Size of the blocks that are cached, not in use
+    size_t cachedBytes() const;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    struct Block {
+        void* ptr;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    /// Implementation of trim, `mutex_` must be held
+    void trimLocked(size_t bytes);
+
+    std::pmr::memory_resource* upstream_;
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::vector<Block> freeBlocks_;  // From the oldest to the newest
+    size_t cachedBytes_ = 0;
+};
+
+/// Monotonic arena for a single generation job. Memory is requested from `upstream` (the heap by default) in a few
+/// large blocks and is released all at once when arena is destroyed, so nothing allocated in it may outlive the arena.
+/// Not thread-safe.
+class Arena {
+public:
+    explicit Arena(size_t initialSize = kDefaultInitialSize);
+    explicit Arena(std::pmr::memory_resource* upstream, size_t initialSize = kDefaultInitialSize);
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    std::pmr::memory_resource* resource();
+
+    /// Allocations made by arena users
+    AllocationStats requestedStats() const;
+    /// Allocations the arena itself made from the upstream resource
+    AllocationStats upstreamStats() const;
+
+private:
+    static constexpr size_t kDefaultInitialSize = 1 << 20;
+
+    CountingResource upstreamResource_;
+    std::pmr::monotonic_buffer_resource arenaResource_;
+    CountingResource requestsResource_;
+};
+
+/// Allocator for buffers that are shared with numeric libraries or vectorized loops. `Alignment` must be a power of 2.
+template <typename T, size_t Alignment = kCacheLineSize>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+    {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* ptr, size_t) noexcept
+    {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+    {
+        return true;
+    }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept
+    {
+        return false;
+    }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+}  // namespace Memory
+}  // namespace DungeonGeneration
@@ -0,0 +1,65 @@
+#include "Random.h"
+
+#include <algorithm>
+
+namespace DungeonGeneration {
+namespace Random {
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+      : columns_(weights.size())
+{
+    const size_t n = weights.size();
+    double weightsSum = 0.0;
+    for (double weight : weights) {
+        assert(weight >= 0 && "Negative weight");
+        weightsSum += weight;
+    }
+    assert(n > 0 && weightsSum > 0 && "AliasTable: empty distribution");
+
+    // Scaled so that the average column is exactly full
+    std::vector<double> scaledWeights(n);
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < n; ++i) {
+        scaledWeights[i] = weights[i] * n / weightsSum;
+        (scaledWeights[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    // Each small column is filled up by a large one
+    while (!small.empty() && !large.empty()) {
+        const size_t smallId = small.back();
+        const size_t largeId = large.back();
+        small.pop_back();
+        columns_[smallId] = Column{.probability = scaledWeights[smallId], .alias = largeId};
+        scaledWeights[largeId] -= 1.0 - scaledWeights[smallId];
+        if (scaledWeights[largeId] < 1.0) {
+            large.pop_back();
+            small.push_back(largeId);
+        }
+    }
+    // Leftovers are full up to rounding errors. Zero weights are never sampled even then.
+    const size_t heaviestId = std::max_element(weights.begin(), weights.end()) - weights.begin();
+    for (size_t i : small) {
+        columns_[i] = (weights[i] > 0 ? Column{.probability = 1.0, .alias = i}
+                                      : Column{.probability = 0.0, .alias = heaviestId});
+    }
+    for (size_t i : large) {
+        columns_[i] = Column{.probability = 1.0, .alias = i};
+    }
+}
+
+size_t AliasTable::sample(RNG& rng) const
+{
+    assert(!columns_.empty() && "AliasTable::sample: empty table");
+    const size_t columnId = uniformDiscrete<size_t>(columns_.size() - 1, rng);
+    const Column& column = columns_[columnId];
+    return (uniformUnit(rng) < column.probability ? columnId : column.alias);
+}
+
+size_t AliasTable::size() const
+{
+    return columns_.size();
+}
+
+}  // namespace Random
+}  // namespace DungeonGeneration
@@ -1,20 +1,101 @@
 #pragma once
 
 #include <cassert>
-#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
 
 namespace DungeonGeneration {
 namespace Random {
 
-using RNG = std::mt19937;
-constexpr size_t kGlobalSeed = 42;
+constexpr uint64_t kGlobalSeed = 42;
+
+/// Stream ids of subsystems. Each subsystem derives its generator from the user seed with its own id, so that
+/// consuming numbers in one of them doesn't change the others.
+namespace Streams {
+constexpr uint64_t kModelGeneration = 1;
+constexpr uint64_t kGraphGeneration = 2;
+constexpr uint64_t kRoomSizes = 3;  // Split further by room id
+constexpr uint64_t kRoomShaking = 4;
+constexpr uint64_t kWorldChunks = 5;  // Split further by chunk id
+}  // namespace Streams
+
+/// Counter-based generator: n-th number is a hash of (key, n), i.e. SplitMix64 with an explicit counter. With key = s
+/// the sequence is the same as of the reference SplitMix64 seeded with s, on every platform.
+/// Satisfies UniformRandomBitGenerator.
+class RNG {
+public:
+    using result_type = uint64_t;
+
+    explicit constexpr RNG(uint64_t seed = kGlobalSeed)
+          : key_(seed)
+    {}
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+    static constexpr result_type max()
+    {
+        return std::numeric_limits<result_type>::max();
+    }
+
+    constexpr result_type operator()()
+    {
+        return mix(key_ + (++counter_) * kGamma);
+    }
+
+    /// Skip `count` numbers in O(1)
+    constexpr void discard(uint64_t count)
+    {
+        counter_ += count;
+    }
+
+    /// Independent generator for the given stream. It depends only on this generator's key and `streamId`, not on
+    /// how many numbers were consumed, so streams can be created in any order (e.g. on different threads).
+    constexpr RNG split(uint64_t streamId) const
+    {
+        return RNG(mix(key_ ^ mix(streamId + kGamma)));
+    }
+
+private:
+    static constexpr uint64_t kGamma = 0x9E3779B97F4A7C15;  // Golden ratio, odd
+
+    /// SplitMix64 finalizer
+    static constexpr uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EB;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t key_;
+    uint64_t counter_ = 0;
+};
+
+/// Distributions below are implemented here instead of using std:: ones: results of the latter differ between
+/// standard libraries.
 
 template <typename T>
 T uniformRangeDiscrete(T lb, T rb, RNG& rng)
 {
+    static_assert(std::is_integral_v<T> && sizeof(T) <= sizeof(uint64_t), "Unsupported type");
     assert(lb <= rb && "Invalid range");
-    std::uniform_int_distribution<T> distribution(lb, rb);
-    return distribution(rng);
+    // Computed modulo 2^64, so negative bounds are fine
+    const uint64_t span = static_cast<uint64_t>(rb) - static_cast<uint64_t>(lb);
+    if (span == RNG::max()) {
+        return static_cast<T>(rng());
+    }
+    // Unbiased: numbers below 2^64 mod bucketCount are rejected
+    const uint64_t bucketCount = span + 1;
+    const uint64_t threshold = (0 - bucketCount) % bucketCount;
+    uint64_t number = rng();
+    while (number < threshold) {
+        number = rng();
+    }
+    return static_cast<T>(static_cast<uint64_t>(lb) + number % bucketCount);
 }
 
 template <typename T>
@@ -23,21 +104,67 @@ T uniformDiscrete(T upperLimit, RNG& rng)
     return uniformRangeDiscrete<T>(0, upperLimit, rng);
 }
 
+/// Uniform number in [0, 1) with 53 random bits
+inline double uniformUnit(RNG& rng)
+{
+    constexpr double kInvTwoPow53 = 1.0 / (uint64_t(1) << 53);
+    return static_cast<double>(rng() >> 11) * kInvTwoPow53;
+}
+
 template <typename T>
 T uniformRangeContinuous(T lb, T rb, RNG& rng)
 {
+    static_assert(std::is_floating_point_v<T>, "Unsupported type");
     assert(lb <= rb && "Invalid range");
-    std::uniform_real_distribution<T> distribution(lb, rb);
-    return distribution(rng);
+    const double lbDouble = static_cast<double>(lb);
+    return static_cast<T>(lbDouble + (static_cast<double>(rb) - lbDouble) * uniformUnit(rng));
 }
 
+/// Linear in the number of weights. Use AliasTable to sample from the same distribution many times.
 inline size_t fromDistribution(const std::vector<double>& weights, RNG& rng)
 {
-    std::discrete_distribution<size_t> generator(weights.begin(), weights.end());
-    size_t result = generator(rng);
-    assert(result < weights.size() && "Invalid generation");
-    return result;
+    assert(!weights.empty() && "Empty distribution");
+    double weightsSum = 0.0;
+    for (double weight : weights) {
+        assert(weight >= 0 && "Negative weight");
+        weightsSum += weight;
+    }
+    const double point = weightsSum * uniformUnit(rng);
+    double cumulativeWeight = 0.0;
+    size_t lastPositive = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        if (weights[i] <= 0) {
+            continue;
+        }
+        cumulativeWeight += weights[i];
+        lastPositive = i;
+        if (point < cumulativeWeight) {
+            return i;
+        }
+    }
+    // Rounding may leave the point right at the end
+    return lastPositive;
 }
 
+/// Discrete distribution compiled with Vose's alias method: O(n) construction, O(1) sampling without allocations.
+class AliasTable {
+public:
+    AliasTable() = default;
+    /// Weights must be non-negative with a positive sum
+    explicit AliasTable(const std::vector<double>& weights);
+
+    size_t sample(RNG& rng) const;
+    size_t size() const;
+
+private:
+    // Column i is kept with `probability`, otherwise `alias` is chosen. Both are stored together: one cache line access
+    // per sample.
+    struct Column {
+        double probability;
+        size_t alias;
+    };
+    std::vector<Column> columns_;
+};
+
 }  // namespace Random
 }  // namespace DungeonGeneration
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include <utils/GridIndex.h>
+
+using namespace DungeonGeneration;
+
+TEST(GridIndexTests, TestQueryFindsIntersectingBoxesOnce)
+{
+    Spatial::GridIndex index(Spatial::Box{.minX = 0.0, .minY = 0.0, .maxX = 100.0, .maxY = 100.0}, 10.0);
+    index.insert(7, Spatial::Box{.minX = 1.0, .minY = 1.0, .maxX = 5.0, .maxY = 5.0});
+    // Spans many cells
+    index.insert(3, Spatial::Box{.minX = 5.0, .minY = 5.0, .maxX = 95.0, .maxY = 95.0});
+    index.insert(5, Spatial::Box{.minX = 90.0, .minY = 1.0, .maxX = 99.0, .maxY = 4.0});
+    // Outside of the indexed area
+    index.insert(1, Spatial::Box{.minX = -50.0, .minY = -50.0, .maxX = -40.0, .maxY = -40.0});
+
+    std::vector<size_t> result;
+    index.query(Spatial::Box{.minX = 0.0, .minY = 0.0, .maxX = 20.0, .maxY = 20.0}, result);
+    EXPECT_EQ(result, (std::vector<size_t>{3, 7}));
+    index.query(Spatial::Box{.minX = 80.0, .minY = 0.0, .maxX = 100.0, .maxY = 4.5}, result);
+    EXPECT_EQ(result, (std::vector<size_t>{5}));
+    index.query(Spatial::Box{.minX = -45.0, .minY = -45.0, .maxX = -44.0, .maxY = -44.0}, result);
+    EXPECT_EQ(result, (std::vector<size_t>{1}));
+    index.query(Spatial::Box{.minX = 96.0, .minY = 96.0, .maxX = 99.0, .maxY = 99.0}, result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(GridIndexTests, TestQueryPairsMatchesBruteForce)
+{
+    std::vector<Spatial::Box> boxes;
+    for (size_t i = 0; i < 200; ++i) {
+        // Deterministic mix of small boxes and long thin ones, partly outside of the indexed area
+        const double x = static_cast<double>((i * 37) % 110) - 5.0;
+        const double y = static_cast<double>((i * 53) % 110) - 5.0;
+        const double width = (i % 7 == 0 ? 40.0 : 3.0);
+        const double height = (i % 11 == 0 ? 40.0 : 3.0);
+        boxes.push_back(Spatial::Box{.minX = x, .minY = y, .maxX = x + width, .maxY = y + height});
+    }
+    Spatial::GridIndex index(Spatial::Box{.minX = 0.0, .minY = 0.0, .maxX = 100.0, .maxY = 100.0}, 10.0);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        index.insert(i, boxes[i]);
+    }
+
+    std::vector<std::pair<size_t, size_t>> expected;
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        for (size_t j = i + 1; j < boxes.size(); ++j) {
+            if (boxes[i].intersects(boxes[j])) {
+                expected.emplace_back(i, j);
+            }
+        }
+    }
+    std::vector<std::pair<size_t, size_t>> result;
+    index.queryPairs(result);
+    std::sort(result.begin(), result.end());
+    EXPECT_FALSE(expected.empty());
+    EXPECT_EQ(result, expected);
+}
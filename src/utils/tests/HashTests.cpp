@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <utils/Hash.h>
+
+using namespace DungeonGeneration;
+
+TEST(HashTests, TestReferenceDigest)
+{
+    // FNV-1a offset basis
+    EXPECT_EQ(Hash::Hasher().digest(), 0xCBF29CE484222325ull);
+    // Integers of any width are widened to 64 bits
+    EXPECT_EQ(Hash::Hasher().add(uint8_t(1)).digest(), Hash::Hasher().add(uint64_t(1)).digest());
+}
+
+TEST(HashTests, TestDistinguishesInputs)
+{
+    EXPECT_NE(Hash::Hasher().add(1.0).digest(), Hash::Hasher().add(2.0).digest());
+    EXPECT_NE(Hash::Hasher().add(1).add(2).digest(), Hash::Hasher().add(2).add(1).digest());
+    // Strings are length-prefixed, so concatenations don't collide
+    EXPECT_NE(
+        Hash::Hasher().add(std::string("ab")).add(std::string("c")).digest(),
+        Hash::Hasher().add(std::string("a")).add(std::string("bc")).digest());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <utils/Memory.h>
+
+using namespace DungeonGeneration;
+
+TEST(MemoryTests, TestBlockCacheReusesBlocks)
+{
+    Memory::CountingResource heap(std::pmr::new_delete_resource());
+    Memory::BlockCache blockCache(&heap);
+
+    void* block = blockCache.allocate(1024, 16);
+    blockCache.deallocate(block, 1024, 16);
+    // Same size and alignment are served from the cache
+    EXPECT_EQ(blockCache.allocate(1024, 16), block);
+    EXPECT_EQ(heap.stats().allocationCount, 1u);
+    // Other sizes go upstream
+    void* otherBlock = blockCache.allocate(2048, 16);
+    EXPECT_EQ(heap.stats().allocationCount, 2u);
+
+    blockCache.deallocate(block, 1024, 16);
+    blockCache.deallocate(otherBlock, 2048, 16);
+}
+
+TEST(MemoryTests, TestArenasShareBlockCache)
+{
+    Memory::CountingResource heap(std::pmr::new_delete_resource());
+    Memory::BlockCache blockCache(&heap);
+
+    auto runJob = [&blockCache]() {
+        Memory::Arena arena(&blockCache, 4096);
+        std::pmr::vector<double> values(10000, 1.0, arena.resource());
+        return arena.upstreamStats().allocationCount;
+    };
+    const size_t blocksPerJob = runJob();
+    EXPECT_GT(blocksPerJob, 0u);
+    const size_t heapAllocations = heap.stats().allocationCount;
+    // The second job requests the same blocks, they are all cached
+    EXPECT_EQ(runJob(), blocksPerJob);
+    EXPECT_EQ(heap.stats().allocationCount, heapAllocations);
+}
+
+TEST(MemoryTests, TestBlockCacheCapacity)
+{
+    Memory::CountingResource heap(std::pmr::new_delete_resource());
+    Memory::BlockCache blockCache(&heap, 3500);
+
+    void* oldBlock = blockCache.allocate(1024, 16);
+    void* newBlock = blockCache.allocate(1024, 16);
+    void* largeBlock = blockCache.allocate(4096, 16);
+    blockCache.deallocate(oldBlock, 1024, 16);
+    blockCache.deallocate(newBlock, 1024, 16);
+    EXPECT_EQ(blockCache.cachedBytes(), 2048u);
+    // Blocks larger than the capacity aren't cached
+    blockCache.deallocate(largeBlock, 4096, 16);
+    EXPECT_EQ(blockCache.cachedBytes(), 2048u);
+
+    // The oldest block makes room for a new one
+    void* otherBlock = blockCache.allocate(2048, 16);
+    blockCache.deallocate(otherBlock, 2048, 16);
+    EXPECT_EQ(blockCache.cachedBytes(), 1024u + 2048u);
+    const size_t heapAllocations = heap.stats().allocationCount;
+    EXPECT_EQ(blockCache.allocate(1024, 16), newBlock);
+    EXPECT_EQ(heap.stats().allocationCount, heapAllocations);
+
+    blockCache.trim(0);
+    EXPECT_EQ(blockCache.cachedBytes(), 0u);
+    blockCache.deallocate(newBlock, 1024, 16);
+}
@@ -46,7 +46,8 @@ TEST(RandomTests, TestGenerateFromDistribution)
 {
     std::vector<double> weights{1.0, 1.5, 0.5};
 
-    constexpr size_t iterCount = 1e5;
+    // Ratio to the rarest outcome is noisy, so more samples are needed than in the tests above
+    constexpr size_t iterCount = 1e6;
     std::vector<size_t> counts(weights.size());
     Random::RNG rng(42);
     for (size_t it = 0; it < iterCount; ++it) {
@@ -60,3 +61,97 @@ TEST(RandomTests, TestGenerateFromDistribution)
     EXPECT_NEAR(ratio1, 2.0, tolerance);
     EXPECT_NEAR(ratio2, 3.0, tolerance);
 }
+
+TEST(RandomTests, TestReferenceSequence)
+{
+    // Reference SplitMix64 outputs: the sequence must not depend on the platform or the standard library
+    Random::RNG rng(0);
+    EXPECT_EQ(rng(), 0xE220A8397B1DCDAFull);
+    EXPECT_EQ(rng(), 0x6E789E6AA1B965F4ull);
+    EXPECT_EQ(rng(), 0x06C45D188009454Full);
+
+    Random::RNG skipped(0);
+    skipped.discard(2);
+    EXPECT_EQ(skipped(), 0x06C45D188009454Full);
+}
+
+TEST(RandomTests, TestSplitStreams)
+{
+    Random::RNG rng(42);
+    const Random::RNG stream1 = rng.split(1);
+    rng();
+    rng();
+
+    // Split doesn't depend on consumed numbers
+    Random::RNG stream1Copy = rng.split(1);
+    Random::RNG stream1Again = stream1;
+    for (size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(stream1Copy(), stream1Again());
+    }
+
+    // Different streams and different seeds give different sequences
+    Random::RNG stream2 = rng.split(2);
+    Random::RNG otherSeedStream1 = Random::RNG(43).split(1);
+    Random::RNG stream1Fresh = rng.split(1);
+    const uint64_t value = stream1Fresh();
+    EXPECT_NE(value, stream2());
+    EXPECT_NE(value, otherSeedStream1());
+}
+
+TEST(RandomTests, TestDiscreteBounds)
+{
+    Random::RNG rng(42);
+    std::vector<size_t> counts(7);
+    for (size_t it = 0; it < 1e4; ++it) {
+        const int number = Random::uniformRangeDiscrete(-3, 3, rng);
+        ASSERT_GE(number, -3);
+        ASSERT_LE(number, 3);
+        counts[number + 3]++;
+    }
+    for (size_t count : counts) {
+        EXPECT_GT(count, 0);
+    }
+    EXPECT_EQ(Random::uniformRangeDiscrete(5, 5, rng), 5);
+}
+
+TEST(RandomTests, TestAliasTable)
+{
+    const std::vector<double> weights{1.0, 1.5, 0.0, 0.5};
+    const Random::AliasTable aliasTable(weights);
+    ASSERT_EQ(aliasTable.size(), weights.size());
+
+    constexpr size_t iterCount = 1e6;
+    std::vector<size_t> counts(weights.size());
+    Random::RNG rng(42);
+    for (size_t it = 0; it < iterCount; ++it) {
+        counts[aliasTable.sample(rng)]++;
+    }
+
+    constexpr double tolerance = 0.05;
+    EXPECT_EQ(counts[2], 0) << "Zero weight must never be sampled";
+    EXPECT_NEAR(static_cast<double>(counts[0]) / counts[3], 2.0, tolerance);
+    EXPECT_NEAR(static_cast<double>(counts[1]) / counts[3], 3.0, tolerance);
+}
+
+TEST(RandomTests, TestAliasTableManyTypes)
+{
+    // Large catalogs: weight of type i is i + 1
+    constexpr size_t n = 500;
+    std::vector<double> weights(n);
+    for (size_t i = 0; i < n; ++i) {
+        weights[i] = i + 1;
+    }
+    const Random::AliasTable aliasTable(weights);
+
+    constexpr size_t iterCount = 2e6;
+    Random::RNG rng(42);
+    double meanId = 0.0;
+    for (size_t it = 0; it < iterCount; ++it) {
+        meanId += aliasTable.sample(rng);
+    }
+    meanId /= iterCount;
+
+    // E[i] = sum(i * (i + 1)) / sum(i + 1) = 2 * (n - 1) / 3
+    const double expectedMeanId = 2.0 * (n - 1) / 3;
+    EXPECT_NEAR(meanId, expectedMeanId, 0.01 * expectedMeanId);
+}